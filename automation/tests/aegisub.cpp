@@ -60,7 +60,8 @@ int main(int argc, char **argv) {
 	}
 
 	preload_modules(L);
-	Install(L, {"include"});
+	// No bytecode cache so that the tests always run the current source
+	Install(L, {"include"}, "");
 
 	// Patch os.exit to close the lua state first since busted calls it when
 	// it's done
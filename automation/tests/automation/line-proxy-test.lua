@@ -0,0 +1,129 @@
+-- Automation 4 test file
+-- Check that the read-only lines passed to validation functions have the
+-- same fields as the line tables passed to macros
+
+script_name = "Automation 4 line proxy test"
+script_description = "Compare the lines seen by a validation function with the lines seen by a macro"
+script_author = "Aegisub contributors"
+script_version = "1"
+
+
+local fields = {
+	info = { "section", "raw", "key", "value", "class" },
+	style = { "section", "raw", "name", "fontname", "fontsize", "color1",
+		"color2", "color3", "color4", "bold", "italic", "underline",
+		"strikeout", "scale_x", "scale_y", "spacing", "angle", "borderstyle",
+		"outline", "shadow", "align", "margin_l", "margin_r", "margin_t",
+		"margin_b", "encoding", "relative_to", "class" },
+	dialogue = { "section", "raw", "comment", "layer", "start_time",
+		"end_time", "style", "actor", "effect", "margin_l", "margin_r",
+		"margin_t", "margin_b", "text", "extra", "class" },
+}
+
+-- Copy of every field of every line, as seen by the validation function
+local seen = nil
+local problems = {}
+
+local function copy_line(line)
+	local copy = {}
+	for _, name in ipairs(fields[line.class]) do
+		local value = line[name]
+		if type(value) == "table" then
+			local t = {}
+			for k, v in pairs(value) do t[k] = v end
+			value = t
+		end
+		copy[name] = value
+	end
+	return copy
+end
+
+function validate_proxy_test(subtitles, selected_lines, active_line)
+	seen = {}
+	problems = {}
+	-- subtitles[i] builds a full line table, so go through lines() to get
+	-- the proxies
+	for i, line in subtitles.lines() do
+		seen[i] = copy_line(line)
+
+		-- A second read must give the same values
+		for name, value in pairs(seen[i]) do
+			if type(value) ~= "table" and line[name] ~= value then
+				table.insert(problems, string.format("line %d: second read of %s differs", i, name))
+			end
+		end
+
+		-- Line tables only have string keys, so anything else is nil
+		local ok, value = pcall(function() return line[1] end)
+		if not ok or value ~= nil then
+			table.insert(problems, string.format("line %d: line[1] gave %s", i, tostring(value)))
+		end
+		ok, value = pcall(function() return line[true] end)
+		if not ok or value ~= nil then
+			table.insert(problems, string.format("line %d: line[true] gave %s", i, tostring(value)))
+		end
+		if line.no_such_field ~= nil then
+			table.insert(problems, string.format("line %d: unknown field is not nil", i))
+		end
+	end
+
+	-- A sub-range must give the same lines at the same indices
+	local first, last = math.floor(#subtitles / 3) + 1, math.floor(#subtitles * 2 / 3)
+	local count = 0
+	for i, line in subtitles.lines(first, last) do
+		count = count + 1
+		if i ~= first + count - 1 then
+			table.insert(problems, string.format("lines(%d, %d): got index %d at step %d", first, last, i, count))
+		elseif line.raw ~= seen[i].raw then
+			table.insert(problems, string.format("lines(%d, %d): line %d differs", first, last, i))
+		end
+	end
+	if count ~= math.max(last - first + 1, 0) then
+		table.insert(problems, string.format("lines(%d, %d) gave %d lines", first, last, count))
+	end
+	-- Don't let the result be cached, so that this runs before every run of
+	-- the macro
+	return true, nil, false
+end
+
+function proxy_test(subtitles, selected_lines, active_line)
+	if not seen then
+		aegisub.debug.out("The validation function hasn't run yet. Run the macro from the Automation menu.\n")
+		return
+	end
+	if #seen ~= #subtitles then
+		table.insert(problems, string.format("validation saw %d lines but there are %d", #seen, #subtitles))
+	end
+
+	for i = 1, math.min(#seen, #subtitles) do
+		local line = subtitles[i]
+		local proxy = seen[i]
+		for _, name in ipairs(fields[line.class] or {}) do
+			local expected, actual = line[name], proxy[name]
+			if type(expected) == "table" then
+				for k, v in pairs(expected) do
+					if actual[k] ~= v then
+						table.insert(problems, string.format("line %d: %s.%s is %s, expected %s", i, name, k, tostring(actual[k]), tostring(v)))
+					end
+				end
+				for k, v in pairs(actual) do
+					if expected[k] == nil then
+						table.insert(problems, string.format("line %d: %s has extra key %s", i, name, k))
+					end
+				end
+			elseif actual ~= expected then
+				table.insert(problems, string.format("line %d (%s): %s is %s, expected %s", i, line.class, name, tostring(actual), tostring(expected)))
+			end
+		end
+	end
+
+	if #problems == 0 then
+		aegisub.debug.out(string.format("All %d lines match\n", #subtitles))
+	else
+		aegisub.debug.out(table.concat(problems, "\n") .. "\n")
+	end
+	seen = nil
+end
+
+
+aegisub.register_macro("Line proxy test", "Compares the lines seen by the validation function with the full lines", proxy_test, validate_proxy_test)
@@ -17,6 +17,8 @@
 #include <libaegisub/ass/uuencode.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 // Despite being called uuencoding by ass_specs.doc, the format is actually
 // somewhat different from real uuencoding.  Each 3-byte chunk is split into 4
@@ -28,28 +30,45 @@ namespace agi { namespace ass {
 
 std::string UUEncode(const char *begin, const char *end, bool insert_linebreaks) {
 	size_t size = std::distance(begin, end);
-	std::string ret;
-	ret.reserve((size * 4 + 2) / 3 + size / 80 * 2);
-
-	size_t written = 0;
-	for (size_t pos = 0; pos < size; pos += 3) {
-		unsigned char src[3] = { '\0', '\0', '\0' };
-		memcpy(src, begin + pos, std::min<size_t>(3u, size - pos));
-
-		unsigned char dst[4] = {
-			static_cast<unsigned char>(src[0] >> 2),
-			static_cast<unsigned char>(((src[0] & 0x3) << 4) | ((src[1] & 0xF0) >> 4)),
-			static_cast<unsigned char>(((src[1] & 0xF) << 2) | ((src[2] & 0xC0) >> 6)),
-			static_cast<unsigned char>(src[2] & 0x3F)
-		};
-
-		for (size_t i = 0; i < std::min<size_t>(size - pos + 1, 4u); ++i) {
-			ret += dst[i] + 33;
-
-			if (insert_linebreaks && ++written == 80 && pos + 3 < size) {
-				written = 0;
-				ret += "\r\n";
-			}
+
+	// Each full 3-byte chunk becomes 4 characters, and a partial chunk at the
+	// end becomes one more character than it has bytes. Line breaks go after
+	// every 80 characters except at the very end.
+	size_t chars = size / 3 * 4 + (size % 3 ? size % 3 + 1 : 0);
+	size_t breaks = insert_linebreaks && chars ? (chars - 1) / 80 : 0;
+	std::string ret(chars + breaks * 2, '\0');
+	if (ret.empty()) return ret;
+
+	auto src = reinterpret_cast<const unsigned char *>(begin);
+	char *dst = &ret[0];
+
+	// 60 bytes of input fill exactly one 80 character line
+	size_t line_size = insert_linebreaks ? 60 : size;
+	for (size_t pos = 0; pos < size; ) {
+		size_t line_end = std::min(size - pos, line_size) + pos;
+
+		for (; pos + 3 <= line_end; pos += 3, dst += 4) {
+			uint32_t chunk = (src[pos] << 16) | (src[pos + 1] << 8) | src[pos + 2];
+			dst[0] = static_cast<char>((chunk >> 18) + 33);
+			dst[1] = static_cast<char>(((chunk >> 12) & 0x3F) + 33);
+			dst[2] = static_cast<char>(((chunk >> 6) & 0x3F) + 33);
+			dst[3] = static_cast<char>((chunk & 0x3F) + 33);
+		}
+
+		// Partial chunk, which can only be at the end of the data
+		if (pos < line_end) {
+			size_t remaining = line_end - pos;
+			unsigned char tail[3] = { '\0', '\0', '\0' };
+			memcpy(tail, src + pos, remaining);
+			uint32_t chunk = (tail[0] << 16) | (tail[1] << 8) | tail[2];
+			for (size_t i = 0; i <= remaining; ++i)
+				*dst++ = static_cast<char>(((chunk >> (18 - 6 * i)) & 0x3F) + 33);
+			pos = line_end;
+		}
+
+		if (pos < size) {
+			*dst++ = '\r';
+			*dst++ = '\n';
 		}
 	}
 
@@ -57,29 +76,70 @@ std::string UUEncode(const char *begin, const char *end, bool insert_linebreaks)
 }
 
 std::vector<char> UUDecode(const char *begin, const char *end) {
-	std::vector<char> ret;
-	size_t len = end - begin;
-	ret.reserve(len * 3 / 4);
-
-	for (size_t pos = 0; pos + 1 < len; ) {
-		size_t bytes = 0;
-		unsigned char src[4] = { '\0', '\0', '\0', '\0' };
-		for (size_t i = 0; i < 4 && pos < len; ++pos) {
-			char c = begin[pos];
-			if (c && c != '\n' && c != '\r') {
-				src[i++] = c - 33;
-				++bytes;
+	size_t len = std::distance(begin, end);
+	if (len == 0) return {};
+
+	// Every 4 characters become 3 bytes, and a partial chunk at the end
+	// becomes one less byte than it has characters, so this is enough even
+	// if there are no line breaks to skip
+	std::vector<char> ret(len / 4 * 3 + 2);
+
+	auto src = reinterpret_cast<const unsigned char *>(begin);
+	char *dst = ret.data();
+	auto significant = [](unsigned char c) { return c && c != '\n' && c != '\r'; };
+	auto decode_chunk = [](const unsigned char *src, char *dst) {
+		uint32_t value =
+			((src[0] - 33u) & 0x3F) << 18 |
+			((src[1] - 33u) & 0x3F) << 12 |
+			((src[2] - 33u) & 0x3F) << 6 |
+			((src[3] - 33u) & 0x3F);
+		dst[0] = static_cast<char>(value >> 16);
+		dst[1] = static_cast<char>(value >> 8);
+		dst[2] = static_cast<char>(value);
+	};
+
+	uint32_t chunk = 0;
+	size_t count = 0;
+	for (size_t pos = 0; pos < len; ) {
+		// Decode whole chunks directly while there's nothing to skip. The
+		// characters to skip are all less than 14, so eight characters at a
+		// time can be checked for them with a single test.
+		if (count == 0) {
+			for (; pos + 8 <= len; pos += 8, dst += 6) {
+				uint64_t word;
+				memcpy(&word, src + pos, 8);
+				if ((word - 0x0E0E0E0E0E0E0E0EULL) & ~word & 0x8080808080808080ULL)
+					break;
+				decode_chunk(src + pos, dst);
+				decode_chunk(src + pos + 4, dst + 3);
 			}
+			for (; pos + 4 <= len && src[pos] > '\r' && src[pos + 1] > '\r' && src[pos + 2] > '\r' && src[pos + 3] > '\r'; pos += 4, dst += 3)
+				decode_chunk(src + pos, dst);
+			if (pos == len) break;
 		}
 
-		if (bytes > 1)
-			ret.push_back((src[0] << 2) | (src[1] >> 4));
-		if (bytes > 2)
-			ret.push_back(((src[1] & 0xF) << 4) | (src[2] >> 2));
-		if (bytes > 3)
-			ret.push_back(((src[2] & 0x3) << 6) | (src[3]));
+		unsigned char c = src[pos++];
+		if (!significant(c)) continue;
+
+		chunk = (chunk << 6) | ((c - 33u) & 0x3F);
+		if (++count == 4) {
+			*dst++ = static_cast<char>(chunk >> 16);
+			*dst++ = static_cast<char>(chunk >> 8);
+			*dst++ = static_cast<char>(chunk);
+			chunk = 0;
+			count = 0;
+		}
+	}
+
+	// Partial chunk at the end, which is treated as if padded with zeros
+	if (count > 1) {
+		chunk <<= 6 * (4 - count);
+		*dst++ = static_cast<char>(chunk >> 16);
+		if (count > 2)
+			*dst++ = static_cast<char>(chunk >> 8);
 	}
 
+	ret.resize(dst - ret.data());
 	return ret;
 }
 } }
@@ -29,6 +29,7 @@ namespace {
 	boost::asio::io_service *service;
 	std::function<void (agi::dispatch::Thunk)> invoke_main;
 	std::atomic<uint_fast32_t> threads_running;
+	size_t worker_count = 0;
 
 	class MainQueue final : public agi::dispatch::Queue {
 		void DoInvoke(agi::dispatch::Thunk thunk) override {
@@ -80,6 +81,7 @@ void Init(std::function<void (Thunk)> invoke_main) {
 	::invoke_main = invoke_main;
 
 	thread_pool.threads.reserve(std::max<unsigned>(4, std::thread::hardware_concurrency()));
+	worker_count = thread_pool.threads.capacity();
 	for (size_t i = 0; i < thread_pool.threads.capacity(); ++i) {
 		thread_pool.threads.emplace_back([]{
 			++threads_running;
@@ -137,4 +139,50 @@ std::unique_ptr<Queue> Create() {
 	return std::unique_ptr<Queue>(new SerialQueue);
 }
 
+void ParallelFor(size_t count, size_t min_chunk, std::function<void (size_t, size_t)> const& func) {
+	size_t chunks = std::min(worker_count, count / std::max<size_t>(min_chunk, 1));
+	if (chunks <= 1) {
+		if (count) func(0, count);
+		return;
+	}
+
+	// Chunks are claimed from a shared counter by both the workers and the
+	// calling thread, so if the workers are busy with other long-running
+	// tasks the caller just ends up doing all of the work itself. Workers
+	// which only get to run after every chunk has been claimed still need
+	// the counter, so the state has to outlive this call.
+	struct State {
+		std::atomic<size_t> next{0};
+		std::mutex m;
+		std::condition_variable cv;
+		size_t finished = 0;
+		std::exception_ptr e;
+	};
+	auto state = std::make_shared<State>();
+
+	auto work = [=, &func] {
+		for (size_t chunk; (chunk = state->next++) < chunks; ) {
+			try {
+				func(count * chunk / chunks, count * (chunk + 1) / chunks);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> l(state->m);
+				if (!state->e) state->e = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> l(state->m);
+			if (++state->finished == chunks)
+				state->cv.notify_all();
+		}
+	};
+
+	for (size_t i = 1; i < chunks; ++i)
+		service->post(work);
+	work();
+
+	std::unique_lock<std::mutex> l(state->m);
+	state->cv.wait(l, [&]{ return state->finished == chunks; });
+	if (state->e) std::rethrow_exception(state->e);
+}
+
 } }
@@ -19,29 +19,101 @@
 
 #include "libaegisub/keyframe.h"
 
-#include <sstream>
-
+#include "libaegisub/file_mapping.h"
 #include "libaegisub/io.h"
-#include "libaegisub/line_iterator.h"
 
+#include <algorithm>
 #include <boost/algorithm/string/predicate.hpp>
-#include <boost/range/algorithm/copy.hpp>
+#include <cctype>
+#include <cstring>
+#include <limits>
 
 namespace {
-std::vector<int> agi_keyframes(std::istream &file) {
-	double fps;
-	std::string fps_str;
-	file >> fps_str;
-	file >> fps;
+/// Amount of the file searched for a line break at a time. This just needs
+/// to be comfortably longer than a line; read_file_mapping maps much bigger
+/// regions than this so that reading line by line rarely needs a new mapping.
+const uint64_t window_size = 64 * 1024;
 
-	return std::vector<int>(agi::line_iterator<int>(file), agi::line_iterator<int>());
+/// Splits a memory-mapped file into lines without copying them
+///
+/// Line ends are found with memchr, which the C library vectorizes, and only
+/// the part of the file being read has to be mapped on 32-bit builds.
+class line_splitter {
+	agi::read_file_mapping file;
+	uint64_t pos = 0;
+
+public:
+	line_splitter(agi::fs::path const& filename) : file(filename) { }
+
+	/// Get the next line, excluding the line terminator
+	/// @return false at the end of the file
+	bool next(const char *&begin, const char *&end) {
+		if (pos >= file.size()) return false;
+
+		uint64_t len = std::min(window_size, file.size() - pos);
+		const char *line = file.read(pos, len);
+		auto nl = static_cast<const char *>(memchr(line, '\n', len));
+		// Lines longer than a window are rare enough that just retrying
+		// with a bigger window is fine
+		while (!nl && pos + len < file.size()) {
+			len = std::min(len * 2, file.size() - pos);
+			line = file.read(pos, len);
+			nl = static_cast<const char *>(memchr(line, '\n', len));
+		}
+
+		begin = line;
+		end = nl ? nl : line + len;
+		pos += end - begin + (nl ? 1 : 0);
+		if (end != begin && end[-1] == '\r')
+			--end;
+		return true;
+	}
+};
+
+bool is_space(char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
 }
 
-std::vector<int> enumerated_keyframes(std::istream &file, char (*func)(std::string const&)) {
+/// Parse an integer at the start of a line the same way as istream's
+/// operator>> does, minus the locale support
+bool parse_int(const char *&p, const char *end, int &value) {
+	while (p != end && is_space(*p)) ++p;
+
+	bool negative = false;
+	if (p != end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+	if (p == end || !isdigit(static_cast<unsigned char>(*p)))
+		return false;
+
+	int64_t v = 0;
+	for (; p != end && isdigit(static_cast<unsigned char>(*p)); ++p) {
+		v = v * 10 + (*p - '0');
+		if (v > std::numeric_limits<int>::max() + int64_t(negative))
+			return false;
+	}
+	value = static_cast<int>(negative ? -v : v);
+	return true;
+}
+
+std::vector<int> agi_keyframes(line_splitter &file) {
+	// The "fps" line which follows the header isn't a number so it's
+	// skipped along with any other junk
+	std::vector<int> ret;
+	const char *begin, *end;
+	while (file.next(begin, end)) {
+		int frame;
+		if (parse_int(begin, end, frame))
+			ret.push_back(frame);
+	}
+	return ret;
+}
+
+std::vector<int> enumerated_keyframes(line_splitter &file, char (*func)(const char *, const char *)) {
 	int count = 0;
 	std::vector<int> ret;
-	for (auto line : agi::line_iterator<std::string>(file)) {
-		char c = tolower(func(line));
+	const char *begin, *end;
+	while (file.next(begin, end)) {
+		char c = tolower(func(begin, end));
 		if (c == 'i')
 			ret.push_back(count++);
 		else if (c == 'p' || c == 'b')
@@ -50,46 +122,49 @@ std::vector<int> enumerated_keyframes(std::istream &file, char (*func)(std::stri
 	return ret;
 }
 
-std::vector<int> indexed_keyframes(std::istream &file, int (*func)(std::string const&)) {
+std::vector<int> indexed_keyframes(line_splitter &file, int (*func)(const char *, const char *)) {
 	std::vector<int> ret;
-	for (auto line : agi::line_iterator<std::string>(file)) {
-		int frame_no = func(line);
+	const char *begin, *end;
+	while (file.next(begin, end)) {
+		int frame_no = func(begin, end);
 		if (frame_no >= 0)
 			ret.push_back(frame_no);
 	}
 	return ret;
 }
 
-char xvid(std::string const& line) {
-	return line.empty() ? 0 : line[0];
+char xvid(const char *begin, const char *end) {
+	return begin == end ? 0 : *begin;
 }
 
-char divx(std::string const& line) {
-	char chrs[] = "IPB";
-	for (int i = 0; i < 3; ++i) {
-		std::string::size_type pos = line.find(chrs[i]);
-		if (pos != line.npos)
-			return line[pos];
+char divx(const char *begin, const char *end) {
+	size_t len = end - begin;
+	for (char c : {'I', 'P', 'B'}) {
+		if (memchr(begin, c, len))
+			return c;
 	}
 	return 0;
 }
 
-char x264(std::string const& line) {
-	std::string::size_type pos = line.find("type:");
-	if (pos == line.npos || pos + 5 >= line.size()) return 0;
-	return line[pos + 5];
+char x264(const char *begin, const char *end) {
+	// Every field is "name:value", so only the colons need to be checked
+	for (auto p = begin; (p = static_cast<const char *>(memchr(p, ':', end - p))); ++p) {
+		if (p - begin >= 4 && memcmp(p - 4, "type", 4) == 0)
+			return p + 1 < end ? p[1] : 0;
+	}
+	return 0;
 }
 
-int wwxd(std::string const& line) {
-	if (line.empty() || line[0] == '#')
+int wwxd(const char *begin, const char *end) {
+	if (begin == end || *begin == '#')
 		return -1;
-	std::istringstream ss(line);
 	int frame_no;
-	char frame_type;
-	ss >> frame_no >> frame_type;
-	if (ss.fail())
+	if (!parse_int(begin, end, frame_no))
+		throw agi::keyframe::KeyframeFormatParseError("WWXD keyframe file not in qpfile format");
+	while (begin != end && is_space(*begin)) ++begin;
+	if (begin == end)
 		throw agi::keyframe::KeyframeFormatParseError("WWXD keyframe file not in qpfile format");
-	if (frame_type == 'I')
+	if (*begin == 'I')
 		return frame_no;
 	return -1;
 }
@@ -97,27 +172,32 @@ int wwxd(std::string const& line) {
 
 namespace agi { namespace keyframe {
 void Save(agi::fs::path const& filename, std::vector<int> const& keyframes) {
+	std::string out = "# keyframe format v1\nfps 0\n";
+	out.reserve(out.size() + keyframes.size() * 8);
+	for (int frame : keyframes) {
+		out += std::to_string(frame);
+		out += '\n';
+	}
+
 	io::Save file(filename);
-	std::ostream& of = file.Get();
-	of << "# keyframe format v1" << std::endl;
-	of << "fps " << 0 << std::endl;
-	boost::copy(keyframes, std::ostream_iterator<int>(of, "\n"));
+	file.Get().write(out.data(), out.size());
 }
 
 std::vector<int> Load(agi::fs::path const& filename) {
-	auto file = io::Open(filename);
-	std::istream &is(*file);
-
-	std::string header;
-	getline(is, header);
-
-	if (header == "# keyframe format v1") return agi_keyframes(is);
-	if (boost::starts_with(header, "# XviD 2pass stat file")) return enumerated_keyframes(is, xvid);
-	if (boost::starts_with(header, "# ffmpeg 2-pass log file, using xvid codec")) return enumerated_keyframes(is, xvid);
-	if (boost::starts_with(header, "# avconv 2-pass log file, using xvid codec")) return enumerated_keyframes(is, xvid);
-	if (boost::starts_with(header, "##map version")) return enumerated_keyframes(is, divx);
-	if (boost::starts_with(header, "#options:")) return enumerated_keyframes(is, x264);
-	if (boost::starts_with(header, "# WWXD log file, using qpfile format")) return indexed_keyframes(is, wwxd);
+	line_splitter file(filename);
+
+	const char *begin, *end;
+	if (!file.next(begin, end))
+		throw UnknownKeyframeFormatError("File header does not match any known formats");
+	std::string header(begin, end);
+
+	if (header == "# keyframe format v1") return agi_keyframes(file);
+	if (boost::starts_with(header, "# XviD 2pass stat file")) return enumerated_keyframes(file, xvid);
+	if (boost::starts_with(header, "# ffmpeg 2-pass log file, using xvid codec")) return enumerated_keyframes(file, xvid);
+	if (boost::starts_with(header, "# avconv 2-pass log file, using xvid codec")) return enumerated_keyframes(file, xvid);
+	if (boost::starts_with(header, "##map version")) return enumerated_keyframes(file, divx);
+	if (boost::starts_with(header, "#options:")) return enumerated_keyframes(file, x264);
+	if (boost::starts_with(header, "# WWXD log file, using qpfile format")) return indexed_keyframes(file, wwxd);
 
 	throw UnknownKeyframeFormatError("File header does not match any known formats");
 }
@@ -20,18 +20,51 @@
 
 #include "libaegisub/charset_conv.h"
 #include "libaegisub/file_mapping.h"
+#include "libaegisub/fs.h"
+#include "libaegisub/io.h"
 #include "libaegisub/line_iterator.h"
+#include "libaegisub/log.h"
 #include "libaegisub/make_unique.h"
 #include "libaegisub/split.h"
 
+#include <algorithm>
 #include <boost/interprocess/streams/bufferstream.hpp>
+#include <cstring>
 
-namespace agi {
+// Cached index format, with all integers little-endian:
+//   "AGTI", uint32 version, uint64 index file size, int64 index file mtime,
+//   uint32 encoding name length, encoding name, uint32 word count,
+//   per word, sorted by word: uint32 word offset, uint32 word length,
+//                             uint32 data file offset
+//   words, in UTF-8
 
-Thesaurus::Thesaurus(agi::fs::path const& dat_path, agi::fs::path const& idx_path)
-: dat(make_unique<read_file_mapping>(dat_path))
-{
-	read_file_mapping idx_file(idx_path);
+namespace {
+const char magic[4] = {'A', 'G', 'T', 'I'};
+const uint32_t version = 1;
+const size_t table_entry_size = 12;
+
+void put_u32(std::string &out, uint32_t value) {
+	for (int i = 0; i < 4; ++i)
+		out += static_cast<char>((value >> (i * 8)) & 0xFF);
+}
+
+void put_u64(std::string &out, uint64_t value) {
+	put_u32(out, static_cast<uint32_t>(value));
+	put_u32(out, static_cast<uint32_t>(value >> 32));
+}
+
+uint32_t get_u32(const char *data) {
+	auto p = reinterpret_cast<const unsigned char *>(data);
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+}
+
+uint64_t get_u64(const char *data) {
+	return get_u32(data) | (uint64_t(get_u32(data + 4)) << 32);
+}
+
+/// Read the index file and build the binary index from it
+std::string build_index(agi::fs::path const& idx_path, uint64_t idx_size, int64_t idx_time) {
+	agi::read_file_mapping idx_file(idx_path);
 	boost::interprocess::ibufferstream idx(idx_file.read(), static_cast<size_t>(idx_file.size()));
 
 	std::string encoding_name;
@@ -39,14 +72,138 @@ Thesaurus::Thesaurus(agi::fs::path const& dat_path, agi::fs::path const& idx_pat
 	std::string unused_entry_count;
 	getline(idx, unused_entry_count);
 
-	conv = make_unique<charset::IconvWrapper>(encoding_name.c_str(), "utf-8");
-
 	// Read the list of words and file offsets for those words
-	for (auto const& line : line_iterator<std::string>(idx, encoding_name)) {
+	std::vector<std::pair<std::string, uint32_t>> words;
+	for (auto const& line : agi::line_iterator<std::string>(idx, encoding_name)) {
 		auto pos = line.find('|');
 		if (pos != line.npos && line.find('|', pos + 1) == line.npos)
-			offsets[line.substr(0, pos)] = static_cast<size_t>(atoi(line.c_str() + pos + 1));
+			words.emplace_back(line.substr(0, pos), static_cast<uint32_t>(atoi(line.c_str() + pos + 1)));
 	}
+
+	// Later entries for a word replace earlier ones, so sort stably and keep
+	// the last of each run of equal words
+	std::stable_sort(words.begin(), words.end(), [](std::pair<std::string, uint32_t> const& a, std::pair<std::string, uint32_t> const& b) {
+		return a.first < b.first;
+	});
+	size_t count = 0;
+	for (size_t i = 0; i < words.size(); ++i) {
+		if (i + 1 < words.size() && words[i].first == words[i + 1].first)
+			continue;
+		if (count != i)
+			words[count] = std::move(words[i]);
+		++count;
+	}
+	words.resize(count);
+
+	std::string out(magic, sizeof magic);
+	put_u32(out, version);
+	put_u64(out, idx_size);
+	put_u64(out, static_cast<uint64_t>(idx_time));
+	put_u32(out, encoding_name.size());
+	out += encoding_name;
+	put_u32(out, words.size());
+
+	uint32_t word_offset = 0;
+	for (auto const& word : words) {
+		put_u32(out, word_offset);
+		put_u32(out, word.first.size());
+		put_u32(out, word.second);
+		word_offset += word.first.size();
+	}
+	for (auto const& word : words)
+		out += word.first;
+
+	return out;
+}
+}
+
+namespace agi {
+
+Thesaurus::Thesaurus(agi::fs::path const& dat_path, agi::fs::path const& idx_path)
+: dat(make_unique<read_file_mapping>(dat_path))
+{
+	auto idx_size = fs::Size(idx_path);
+	auto idx_time = fs::ModifiedTime(idx_path);
+	index_data = build_index(idx_path, idx_size, idx_time);
+	LoadIndex(idx_size, idx_time);
+}
+
+Thesaurus::Thesaurus(agi::fs::path const& dat_path, agi::fs::path const& idx_path, agi::fs::path const& cache_path)
+: dat(make_unique<read_file_mapping>(dat_path))
+{
+	auto idx_size = fs::Size(idx_path);
+	auto idx_time = fs::ModifiedTime(idx_path);
+
+	try {
+		if (fs::FileExists(cache_path)) {
+			index_file = make_unique<read_file_mapping>(cache_path);
+			if (LoadIndex(idx_size, idx_time))
+				return;
+			index_file.reset();
+		}
+	}
+	catch (fs::FileSystemError const& e) {
+		LOG_D("thesaurus/cache") << "Cannot read thesaurus index cache: " << e.GetMessage();
+		index_file.reset();
+	}
+
+	index_data = build_index(idx_path, idx_size, idx_time);
+
+	try {
+		{
+			io::Save cache(cache_path, true);
+			cache.Get().write(index_data.data(), index_data.size());
+		}
+		index_file = make_unique<read_file_mapping>(cache_path);
+		if (LoadIndex(idx_size, idx_time)) {
+			index_data.clear();
+			index_data.shrink_to_fit();
+			return;
+		}
+		index_file.reset();
+	}
+	catch (Exception const& e) {
+		LOG_D("thesaurus/cache") << "Cannot write thesaurus index cache: " << e.GetMessage();
+		index_file.reset();
+	}
+
+	LoadIndex(idx_size, idx_time);
+}
+
+const char *Thesaurus::ReadIndex(uint64_t offset, uint64_t length) {
+	if (index_file) {
+		if (offset > index_file->size() || length > index_file->size() - offset)
+			return nullptr;
+		return index_file->read(offset, length);
+	}
+	if (offset > index_data.size() || length > index_data.size() - offset)
+		return nullptr;
+	return index_data.data() + offset;
+}
+
+bool Thesaurus::LoadIndex(uint64_t idx_size, int64_t idx_time) {
+	const size_t header_size = 28;
+	auto header = ReadIndex(0, header_size);
+	if (!header || memcmp(header, magic, sizeof magic) != 0 || get_u32(header + 4) != version)
+		return false;
+	if (get_u64(header + 8) != idx_size || get_u64(header + 16) != static_cast<uint64_t>(idx_time))
+		return false;
+
+	uint32_t encoding_len = get_u32(header + 24);
+	auto encoding = ReadIndex(header_size, encoding_len + 4);
+	if (!encoding) return false;
+	std::string encoding_name(encoding, encoding_len);
+	word_count = get_u32(encoding + encoding_len);
+
+	table_start = header_size + encoding_len + 4;
+	words_start = table_start + uint64_t(word_count) * table_entry_size;
+	if (!ReadIndex(table_start, words_start - table_start)) {
+		word_count = 0;
+		return false;
+	}
+
+	conv = make_unique<charset::IconvWrapper>(encoding_name.c_str(), "utf-8");
+	return true;
 }
 
 Thesaurus::~Thesaurus() { }
@@ -55,12 +212,37 @@ std::vector<Thesaurus::Entry> Thesaurus::Lookup(std::string const& word) {
 	std::vector<Entry> out;
 	if (!dat) return out;
 
-	auto it = offsets.find(word);
-	if (it == offsets.end()) return out;
-	if (it->second >= dat->size()) return out;
+	// Binary search the word table for the word
+	uint32_t lo = 0, hi = word_count;
+	uint64_t offset = 0;
+	bool found = false;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		auto entry = ReadIndex(table_start + uint64_t(mid) * table_entry_size, table_entry_size);
+		if (!entry) return out;
+		uint32_t word_offset = get_u32(entry);
+		uint32_t word_len = get_u32(entry + 4);
+		offset = get_u32(entry + 8);
+
+		auto entry_word = ReadIndex(words_start + word_offset, word_len);
+		if (!entry_word) return out;
+		int cmp = memcmp(entry_word, word.data(), std::min<size_t>(word_len, word.size()));
+		if (cmp == 0)
+			cmp = word_len < word.size() ? -1 : word_len > word.size() ? 1 : 0;
+		if (cmp == 0) {
+			found = true;
+			break;
+		}
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (!found) return out;
+	if (offset >= dat->size()) return out;
 
-	auto len = dat->size() - it->second;
-	auto buff = dat->read(it->second, len);
+	auto len = dat->size() - offset;
+	auto buff = dat->read(offset, len);
 	auto buff_end = buff + len;
 
 	std::string temp;
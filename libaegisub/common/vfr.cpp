@@ -52,6 +52,12 @@ void normalize_timecodes(std::vector<int> &timecodes) {
 		boost::for_each(timecodes, [=](int &tc) { tc -= front; });
 }
 
+/// Timecodes for CFR frame rates, which all only have the first frame
+std::shared_ptr<const std::vector<int>> const& cfr_timecodes() {
+	static const auto timecodes = std::make_shared<const std::vector<int>>(1, 0);
+	return timecodes;
+}
+
 // A "start,end,fps" line in a v1 timecode file
 struct TimecodeRange {
 	int start;
@@ -134,41 +140,40 @@ namespace agi { namespace vfr {
 Framerate::Framerate(double fps)
 : denominator(default_denominator)
 , numerator(int64_t(fps * denominator))
+, timecodes(cfr_timecodes())
 {
 	if (fps < 0.) throw InvalidFramerate("FPS must be greater than zero");
 	if (fps > 1000.) throw InvalidFramerate("FPS must not be greater than 1000");
-	timecodes.push_back(0);
 }
 
 Framerate::Framerate(int64_t numerator, int64_t denominator, bool drop)
 : denominator(denominator)
 , numerator(numerator)
+, timecodes(cfr_timecodes())
 , drop(drop && denominator != 0 && numerator % denominator != 0)
 {
 	if (numerator <= 0 || denominator <= 0)
 		throw InvalidFramerate("Numerator and denominator must both be greater than zero");
 	if (numerator / denominator > 1000) throw InvalidFramerate("FPS must not be greater than 1000");
-	timecodes.push_back(0);
 }
 
-void Framerate::SetFromTimecodes() {
-	validate_timecodes(timecodes);
-	normalize_timecodes(timecodes);
+void Framerate::SetFromTimecodes(std::vector<int> new_timecodes) {
+	validate_timecodes(new_timecodes);
+	normalize_timecodes(new_timecodes);
 	denominator = default_denominator;
-	numerator = (timecodes.size() - 1) * denominator * 1000 / timecodes.back();
-	last = (timecodes.size() - 1) * denominator * 1000;
+	numerator = (new_timecodes.size() - 1) * denominator * 1000 / new_timecodes.back();
+	last = (new_timecodes.size() - 1) * denominator * 1000;
+	timecodes = std::make_shared<const std::vector<int>>(std::move(new_timecodes));
 }
 
 Framerate::Framerate(std::vector<int> timecodes)
-: timecodes(std::move(timecodes))
 {
-	SetFromTimecodes();
+	SetFromTimecodes(std::move(timecodes));
 }
 
 Framerate::Framerate(std::initializer_list<int> timecodes)
-: timecodes(timecodes)
 {
-	SetFromTimecodes();
+	SetFromTimecodes(timecodes);
 }
 
 Framerate::Framerate(fs::path const& filename)
@@ -178,14 +183,17 @@ Framerate::Framerate(fs::path const& filename)
 	auto encoding = agi::charset::Detect(filename);
 	auto line = *line_iterator<std::string>(*file, encoding);
 	if (line == "# timecode format v2") {
-		copy(line_iterator<int>(*file, encoding), line_iterator<int>(), back_inserter(timecodes));
-		SetFromTimecodes();
+		std::vector<int> new_timecodes;
+		copy(line_iterator<int>(*file, encoding), line_iterator<int>(), back_inserter(new_timecodes));
+		SetFromTimecodes(std::move(new_timecodes));
 		return;
 	}
 	if (line == "# timecode format v1" || line.substr(0, 7) == "Assume ") {
 		if (line[0] == '#')
 			line = *line_iterator<std::string>(*file, encoding);
-		numerator = v1_parse(line_iterator<std::string>(*file, encoding), line, timecodes, last);
+		std::vector<int> new_timecodes;
+		numerator = v1_parse(line_iterator<std::string>(*file, encoding), line, new_timecodes, last);
+		timecodes = std::make_shared<const std::vector<int>>(std::move(new_timecodes));
 		return;
 	}
 
@@ -197,8 +205,8 @@ void Framerate::Save(fs::path const& filename, int length) const {
 	auto &out = file.Get();
 
 	out << "# timecode format v2\n";
-	boost::copy(timecodes, std::ostream_iterator<int>(out, "\n"));
-	for (int written = (int)timecodes.size(); written < length; ++written)
+	boost::copy(*timecodes, std::ostream_iterator<int>(out, "\n"));
+	for (int written = (int)timecodes->size(); written < length; ++written)
 		out << TimeAtFrame(written) << std::endl;
 }
 
@@ -224,10 +232,53 @@ int Framerate::FrameAtTime(int ms, Time type) const {
 	if (ms < 0)
 		return int((ms * numerator / denominator - 999) / 1000);
 
-	if (ms > timecodes.back())
-		return int((ms * numerator - numerator / 2 - last + numerator - 1) / denominator / 1000) + (int)timecodes.size() - 1;
+	if (ms > timecodes->back())
+		return int((ms * numerator - numerator / 2 - last + numerator - 1) / denominator / 1000) + (int)timecodes->size() - 1;
+
+	// The last frame starting at or before the time
+	return (int)distance(timecodes->begin(), upper_bound(timecodes->begin(), timecodes->end(), ms)) - 1;
+}
+
+void Framerate::FramesAtTimes(const int *ms, int *frames, size_t count, Time type) const {
+	// START and END are EXACT shifted by a ms, as in FrameAtTime()
+	const int time_offset = type == EXACT ? 0 : -1;
+	const int frame_offset = type == START ? 1 : 0;
+
+	auto const& tc = *timecodes;
+	// Index of the last frame found, which starts at or before every time
+	// in the table which is after the previous one
+	size_t cursor = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		int time = ms[i] + time_offset;
+		if (time < 0 || time > tc.back()) {
+			frames[i] = FrameAtTime(time) + frame_offset;
+			continue;
+		}
+
+		// Times going backwards have to start over from the first frame,
+		// which always starts at 0
+		if (tc[cursor] > time)
+			cursor = 0;
+
+		// Gallop forward from the cursor to bound the search, so that nearby
+		// times cost a few comparisons and distant ones a logarithmic number
+		size_t lo = cursor, hi = cursor + 1, step = 1;
+		while (hi < tc.size() && tc[hi] <= time) {
+			lo = hi;
+			hi += step;
+			step *= 2;
+		}
+		hi = std::min(hi, tc.size());
+
+		cursor = distance(tc.begin(), upper_bound(tc.begin() + lo, tc.begin() + hi, time)) - 1;
+		frames[i] = (int)cursor + frame_offset;
+	}
+}
 
-	return (int)distance(lower_bound(timecodes.rbegin(), timecodes.rend(), ms, std::greater<int>()), timecodes.rend()) - 1;
+void Framerate::TimesAtFrames(const int *frames, int *ms, size_t count, Time type) const {
+	for (size_t i = 0; i < count; ++i)
+		ms[i] = TimeAtFrame(frames[i], type);
 }
 
 int Framerate::TimeAtFrame(int frame, Time type) const {
@@ -247,12 +298,12 @@ int Framerate::TimeAtFrame(int frame, Time type) const {
 	if (frame < 0)
 		return (int)(frame * denominator * 1000 / numerator);
 
-	if (frame >= (signed)timecodes.size()) {
-		int64_t frames_past_end = frame - (int)timecodes.size() + 1;
+	if (frame >= (signed)timecodes->size()) {
+		int64_t frames_past_end = frame - (int)timecodes->size() + 1;
 		return int((frames_past_end * 1000 * denominator + last + numerator / 2) / numerator);
 	}
 
-	return timecodes[frame];
+	return (*timecodes)[frame];
 }
 
 void Framerate::SmpteAtFrame(int frame, int *h, int *m, int *s, int *f) const {
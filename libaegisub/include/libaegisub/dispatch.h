@@ -46,5 +46,20 @@ namespace agi {
 
 		/// Create a new serial queue
 		std::unique_ptr<Queue> Create();
+
+		/// Split the range [0, count) into contiguous chunks of at least
+		/// min_chunk items and process them in parallel on the background
+		/// queue, returning once all of them are complete
+		///
+		/// The calling thread processes chunks itself until there are none
+		/// left, so it only ever waits for chunks which another thread has
+		/// already started. It's therefore safe to call from the background
+		/// queue, and doesn't stall if the queue is busy with other work. If
+		/// any of the chunks throws, the first exception is rethrown after
+		/// all of the chunks have finished.
+		/// @param count Number of items to process
+		/// @param min_chunk Smallest number of items worth handing off to another thread
+		/// @param func Function to call with the [begin, end) range of each chunk
+		void ParallelFor(size_t count, size_t min_chunk, std::function<void (size_t, size_t)> const& func);
 	}
 }
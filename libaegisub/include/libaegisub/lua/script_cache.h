@@ -0,0 +1,39 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include <libaegisub/fs_fwd.h>
+
+#include <string>
+
+namespace agi { namespace lua {
+	/// Get the file in cache_dir which the compiled form of a script is
+	/// stored in. Each script has a single cache file which is overwritten
+	/// whenever the script changes.
+	fs::path CachePath(fs::path const& cache_dir, fs::path const& filename);
+
+	/// Get the header which a cache file has to start with to be used for
+	/// the given script source
+	///
+	/// Bytecode is only valid for the exact LuaJIT version which wrote it, so
+	/// that's included along with the path, modification time, size and CRC
+	/// of the source.
+	std::string CacheKey(fs::path const& filename, const char *source, size_t size);
+
+	/// Delete the cache files in cache_dir which can never be used again
+	/// because their script no longer exists or they were written by a
+	/// different version of LuaJIT
+	void PruneCache(fs::path const& cache_dir);
+} }
@@ -22,8 +22,13 @@ struct lua_State;
 
 namespace agi { namespace lua {
 	/// Load a Lua or Moonscript file at the given path
+	///
+	/// If a bytecode cache directory was given to Install, the compiled form
+	/// of the file is read from and written to that directory.
 	bool LoadFile(lua_State *L, agi::fs::path const& filename);
 	/// Install our module loader and add include_path to the module search
 	/// path of the given lua state
-	bool Install(lua_State *L, std::vector<fs::path> const& include_path);
+	/// @param cache_dir Directory to cache compiled scripts in, or empty to
+	///                  always compile scripts from source
+	bool Install(lua_State *L, std::vector<fs::path> const& include_path, fs::path const& cache_dir);
 } }
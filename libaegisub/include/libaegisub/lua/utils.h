@@ -86,7 +86,7 @@ int exception_wrapper(lua_State *L) {
 }
 
 template<typename T>
-void set_field(lua_State *L, const char *name, T value) {
+void set_field(lua_State *L, const char *name, T const& value) {
 	push_value(L, value);
 	lua_setfield(L, -2, name);
 }
@@ -14,7 +14,7 @@
 
 #include "fs_fwd.h"
 
-#include <boost/container/flat_map.hpp>
+#include <cstdint>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -26,13 +26,31 @@ class read_file_mapping;
 namespace charset { class IconvWrapper; }
 
 class Thesaurus {
-	/// Map of word -> byte position in the data file
-	boost::container::flat_map<std::string, size_t> offsets;
 	/// Read handle to the data file
 	std::unique_ptr<read_file_mapping> dat;
 	/// Converter from the data file's charset to UTF-8
 	std::unique_ptr<charset::IconvWrapper> conv;
 
+	/// Read handle to the cached binary index of the words in the index file
+	std::unique_ptr<read_file_mapping> index_file;
+	/// The binary index, if it could not be cached
+	std::string index_data;
+	/// Number of words in the binary index
+	uint32_t word_count = 0;
+	/// Position of the word table in the binary index
+	uint64_t table_start = 0;
+	/// Position of the words in the binary index
+	uint64_t words_start = 0;
+
+	/// Read part of the binary index
+	/// @return Pointer to the data, or nullptr if the range is out of bounds
+	const char *ReadIndex(uint64_t offset, uint64_t length);
+
+	/// Check the binary index's header and read the encoding and word count from it
+	/// @param idx_size Size of the index file the binary index should be for
+	/// @param idx_time Modification time of the index file the binary index should be for
+	bool LoadIndex(uint64_t idx_size, int64_t idx_time);
+
 public:
 	/// A pair of a word and synonyms for that word
 	typedef std::pair<std::string, std::vector<std::string>> Entry;
@@ -41,6 +59,16 @@ public:
 	/// @param dat_path Path to data file
 	/// @param idx_path Path to index file
 	Thesaurus(agi::fs::path const& dat_path, agi::fs::path const& idx_path);
+
+	/// Constructor
+	///
+	/// A sorted binary index of the words in the index file is written to the
+	/// cache path the first time, and later loads map it rather than reading
+	/// the whole index file.
+	/// @param dat_path Path to data file
+	/// @param idx_path Path to index file
+	/// @param cache_path Path to the cached binary index
+	Thesaurus(agi::fs::path const& dat_path, agi::fs::path const& idx_path, agi::fs::path const& cache_path);
 	~Thesaurus();
 
 	/// Look up synonyms for a word
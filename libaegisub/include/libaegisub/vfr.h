@@ -15,6 +15,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include <libaegisub/exception.h>
@@ -68,22 +69,24 @@ class Framerate {
 	int64_t last = 0;
 
 	/// Start time in milliseconds of each frame
-	std::vector<int> timecodes;
+	///
+	/// The table is never modified after construction, so copies of a
+	/// Framerate share it rather than duplicating what may be hundreds of
+	/// thousands of entries
+	std::shared_ptr<const std::vector<int>> timecodes;
 
 	/// Does this frame rate need drop frames and have them enabled?
 	bool drop = false;
 
-	/// Set FPS properties from the timecodes vector
-	void SetFromTimecodes();
+	/// Validate and normalize the timecodes, then set the FPS properties
+	/// from them and take ownership of them
+	void SetFromTimecodes(std::vector<int> timecodes);
 public:
+	// Copying only shares the timecodes table, so there's no separate move
+	// which would leave a Framerate without one
 	Framerate(Framerate const&) = default;
 	Framerate& operator=(Framerate const&) = default;
 
-#ifndef _MSC_VER
-	Framerate(Framerate&&) = default;
-	Framerate& operator=(Framerate&&) = default;
-#endif
-
 	/// @brief VFR from timecodes file
 	/// @param filename File with v1 or v2 timecodes
 	///
@@ -134,6 +137,26 @@ public:
 	/// results for all frame numbers
 	int TimeAtFrame(int frame, Time type = EXACT) const;
 
+	/// @brief Get the frame for each of a list of times
+	/// @param ms Times in milliseconds
+	/// @param[out] frames Array of at least count frame numbers to fill, which may be ms
+	/// @param count Number of times to convert
+	/// @param type Time mode
+	///
+	/// Gives the same results as calling FrameAtTime() on each time, but
+	/// searches the timecodes from where the previous time was found, so
+	/// converting a sorted (or mostly sorted) list of times takes linear
+	/// rather than O(n log n) time.
+	void FramesAtTimes(const int *ms, int *frames, size_t count, Time type = EXACT) const;
+
+	/// @brief Get the time for each of a list of frames
+	/// @param frames Frame numbers
+	/// @param[out] ms Array of at least count times to fill, which may be frames
+	/// @param count Number of frames to convert
+	/// @param type Time mode
+	/// @see TimeAtFrame
+	void TimesAtFrames(const int *frames, int *ms, size_t count, Time type = EXACT) const;
+
 	/// @brief Get the components of the SMPTE timecode for the given time
 	/// @param[out] h Hours component
 	/// @param[out] m Minutes component
@@ -193,7 +216,7 @@ public:
 	void Save(fs::path const& file, int length = -1) const;
 
 	/// Is this frame rate possibly variable?
-	bool IsVFR() const {return timecodes.size() > 1; }
+	bool IsVFR() const {return timecodes->size() > 1; }
 
 	/// Does this represent a valid frame rate?
 	bool IsLoaded() const { return numerator > 0; }
@@ -0,0 +1,70 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "libaegisub/lua/script_cache.h"
+
+#include "libaegisub/fs.h"
+#include "libaegisub/io.h"
+#include "libaegisub/log.h"
+
+#include <boost/crc.hpp>
+#include <luajit.h>
+#include <vector>
+
+namespace agi { namespace lua {
+fs::path CachePath(fs::path const& cache_dir, fs::path const& filename) {
+	boost::crc_32_type hash;
+	hash.process_bytes(filename.string().c_str(), filename.string().size());
+	return cache_dir/(std::to_string(hash.checksum()) + ".luac");
+}
+
+std::string CacheKey(fs::path const& filename, const char *source, size_t size) {
+	boost::crc_32_type hash;
+	hash.process_bytes(source, size);
+	return std::string(LUAJIT_VERSION) + "\n" + filename.string() + "\n"
+		+ std::to_string(fs::ModifiedTime(filename)) + "\n"
+		+ std::to_string(size) + "\n" + std::to_string(hash.checksum()) + "\n";
+}
+
+void PruneCache(fs::path const& cache_dir) {
+	if (!fs::DirectoryExists(cache_dir)) return;
+
+	std::vector<std::string> names;
+	fs::DirectoryIterator(cache_dir, "*.luac").GetAll(names);
+	for (auto const& name : names) {
+		auto file = cache_dir/name;
+		try {
+			// Only the version and path at the start of the key are needed
+			std::string version, script;
+			{
+				auto stream = io::Open(file, true);
+				std::getline(*stream, version);
+				std::getline(*stream, script);
+			}
+
+			if (version == LUAJIT_VERSION && !script.empty() && fs::FileExists(script)
+				&& CachePath(cache_dir, script) == file)
+				continue;
+
+			LOG_D("auto4/lua/cache") << "Removing unused cache file " << file;
+			fs::Remove(file);
+		}
+		catch (agi::Exception const& e) {
+			LOG_W("auto4/lua/cache") << "Error pruning cache file " << file << ": " << e.GetMessage();
+		}
+	}
+}
+} }
@@ -17,12 +17,164 @@
 #include "libaegisub/lua/script_reader.h"
 
 #include "libaegisub/file_mapping.h"
+#include "libaegisub/fs.h"
+#include "libaegisub/io.h"
 #include "libaegisub/log.h"
+#include "libaegisub/lua/script_cache.h"
 #include "libaegisub/lua/utils.h"
 #include "libaegisub/split.h"
 
 #include <boost/algorithm/string/replace.hpp>
+#include <cstring>
 #include <lauxlib.h>
+#include <ostream>
+
+namespace {
+	using namespace agi::lua;
+
+	/// Get the path where the compiled form of the given file should be
+	/// cached, or an empty path if caching is disabled for this state
+	agi::fs::path cache_path(lua_State *L, agi::fs::path const& filename) {
+		lua_getfield(L, LUA_REGISTRYINDEX, "bytecode cache");
+		agi::fs::path dir;
+		if (lua_isstring(L, -1))
+			dir = lua_tostring(L, -1);
+		lua_pop(L, 1);
+		if (dir.empty()) return dir;
+		return CachePath(dir, filename);
+	}
+
+	/// Push MoonScript's table of Lua line -> MoonScript character offset
+	/// mappings, used to report errors at the correct line
+	void push_line_tables(lua_State *L) {
+		lua_getglobal(L, "package");
+		lua_getfield(L, -1, "loaded");
+		lua_getfield(L, -1, "moonscript.line_tables");
+		lua_remove(L, -2);
+		lua_remove(L, -2);
+	}
+
+	/// Parse a non-negative number followed by a single separator character
+	bool read_number(const char *&data, const char *end, int& out) {
+		out = 0;
+		const char *start = data;
+		for (; data < end && *data >= '0' && *data <= '9'; ++data)
+			out = out * 10 + (*data - '0');
+		if (data == start || data >= end) return false;
+		++data;
+		return true;
+	}
+
+	/// Try to load a file from the cache, leaving the function on the stack
+	/// and returning true on success and leaving the stack untouched otherwise
+	///
+	/// The cache file is the key followed by the number of line table
+	/// entries, the entries as lua line/moon offset pairs, and then the
+	/// bytecode, with everything but the bytecode stored as text.
+	bool load_cached(lua_State *L, agi::fs::path const& cache_file, std::string const& key, agi::fs::path const& filename, bool is_moon) {
+		if (!agi::fs::FileExists(cache_file)) return false;
+
+		try {
+			agi::read_file_mapping file(cache_file);
+			const char *data = file.read();
+			const char *end = data + file.size();
+			if (file.size() < key.size() || memcmp(data, key.data(), key.size()) != 0)
+				return false;
+			data += key.size();
+
+			int line_count;
+			if (!read_number(data, end, line_count)) return false;
+
+			if (is_moon) {
+				push_line_tables(L);
+				if (!lua_istable(L, -1)) {
+					lua_pop(L, 1);
+					return false;
+				}
+				push_value(L, filename);
+				lua_createtable(L, line_count, 0);
+			}
+			for (int i = 0; i < line_count; ++i) {
+				int lua_line, moon_pos;
+				if (!read_number(data, end, lua_line) || !read_number(data, end, moon_pos)) {
+					if (is_moon) lua_pop(L, 3);
+					return false;
+				}
+				if (is_moon) {
+					push_value(L, moon_pos);
+					lua_rawseti(L, -2, lua_line);
+				}
+			}
+			if (data >= end || *data != '\n') {
+				if (is_moon) lua_pop(L, 3);
+				return false;
+			}
+			++data;
+
+			if (luaL_loadbuffer(L, data, end - data, filename.string().c_str())) {
+				lua_pop(L, is_moon ? 4 : 1);
+				return false;
+			}
+
+			if (is_moon) {
+				// Store the line table under the function
+				lua_insert(L, -4);
+				lua_rawset(L, -3);
+				lua_pop(L, 1);
+			}
+			return true;
+		}
+		catch (agi::Exception const& e) {
+			LOG_D("auto4/lua/cache") << "Error reading cached bytecode: " << e.GetMessage();
+			return false;
+		}
+	}
+
+	int dump_writer(lua_State *, const void *p, size_t sz, void *ud) {
+		static_cast<std::string *>(ud)->append(static_cast<const char *>(p), sz);
+		return 0;
+	}
+
+	/// Write the function on the top of the stack to the cache
+	void save_cached(lua_State *L, agi::fs::path const& cache_file, std::string const& key, agi::fs::path const& filename, bool is_moon) {
+		std::string bytecode;
+		if (lua_dump(L, dump_writer, &bytecode) != 0)
+			return;
+
+		std::string line_table;
+		size_t line_count = 0;
+		if (is_moon) {
+			push_line_tables(L);
+			if (lua_istable(L, -1)) {
+				push_value(L, filename);
+				lua_rawget(L, -2);
+				if (lua_istable(L, -1)) {
+					lua_pushnil(L);
+					while (lua_next(L, -2)) {
+						if (lua_isnumber(L, -2) && lua_isnumber(L, -1)) {
+							line_table += std::to_string(lua_tointeger(L, -2)) + " " + std::to_string(lua_tointeger(L, -1)) + "\n";
+							++line_count;
+						}
+						lua_pop(L, 1);
+					}
+				}
+				lua_pop(L, 1);
+			}
+			lua_pop(L, 1);
+		}
+
+		try {
+			agi::fs::CreateDirectory(cache_file.parent_path());
+			agi::io::Save file(cache_file, true);
+			auto& out = file.Get();
+			out << key << line_count << "\n" << line_table << "\n";
+			out.write(bytecode.data(), bytecode.size());
+		}
+		catch (agi::Exception const& e) {
+			LOG_W("auto4/lua/cache") << "Error writing cached bytecode: " << e.GetMessage();
+		}
+	}
+}
 
 namespace agi { namespace lua {
 	bool LoadFile(lua_State *L, agi::fs::path const& raw_filename) {
@@ -44,20 +196,40 @@ namespace agi { namespace lua {
 			size -= 3;
 		}
 
-		if (!agi::fs::HasExtension(filename, "moon"))
-			return luaL_loadbuffer(L, buff, size, filename.string().c_str()) == 0;
+		bool is_moon = agi::fs::HasExtension(filename, "moon");
+
+		// Save the text we'll be loading for the line number rewriting in the
+		// error handling
+		if (is_moon) {
+			lua_pushlstring(L, buff, size);
+			lua_setfield(L, LUA_REGISTRYINDEX, ("raw moonscript: " + filename.string()).c_str());
+		}
+
+		// Compiling large scripts (and especially MoonScript, which has to be
+		// translated to Lua first) is slow enough to noticeably delay startup,
+		// so reuse the bytecode from the last time this file was loaded if
+		// it hasn't changed since then
+		auto cache_file = cache_path(L, filename);
+		std::string key;
+		if (!cache_file.empty()) {
+			key = CacheKey(filename, buff, size);
+			if (load_cached(L, cache_file, key, filename, is_moon))
+				return true;
+		}
+
+		if (!is_moon) {
+			if (luaL_loadbuffer(L, buff, size, filename.string().c_str()))
+				return false;
+			if (!cache_file.empty())
+				save_cached(L, cache_file, key, filename, false);
+			return true;
+		}
 
 		// We have a MoonScript file, so we need to load it with that
 		// It might be nice to have a dedicated lua state for compiling
 		// MoonScript to Lua
 		lua_getfield(L, LUA_REGISTRYINDEX, "moonscript");
-
-		// Save the text we'll be loading for the line number rewriting in the
-		// error handling
 		lua_pushlstring(L, buff, size);
-		lua_pushvalue(L, -1);
-		lua_setfield(L, LUA_REGISTRYINDEX, ("raw moonscript: " + filename.string()).c_str());
-
 		push_value(L, filename);
 		if (lua_pcall(L, 2, 2, 0))
 			return false; // Leaves error message on stack
@@ -69,6 +241,8 @@ namespace agi { namespace lua {
 		}
 
 		lua_pop(L, 1); // Remove the extra nil for the stackchecker
+		if (!cache_file.empty())
+			save_cached(L, cache_file, key, filename, true);
 		return true;
 	}
 
@@ -119,7 +293,13 @@ namespace agi { namespace lua {
 		return lua_gettop(L) - pretop;
 	}
 
-	bool Install(lua_State *L, std::vector<fs::path> const& include_path) {
+	bool Install(lua_State *L, std::vector<fs::path> const& include_path, fs::path const& cache_dir) {
+		// Set this first so that the modules loaded below are cached as well
+		if (!cache_dir.empty()) {
+			push_value(L, cache_dir);
+			lua_setfield(L, LUA_REGISTRYINDEX, "bytecode cache");
+		}
+
 		// set the module load path to include_path
 		lua_getglobal(L, "package");
 		push_value(L, "path");
@@ -19,11 +19,17 @@
 #include <libaegisub/fs_fwd.h>
 
 #include <boost/flyweight.hpp>
+#include <memory>
+#include <string>
 
 /// @class AssAttachment
 class AssAttachment final : public AssEntry {
 	/// ASS uuencoded entry data, including header.
-	boost::flyweight<std::string> entry_data;
+	///
+	/// This is shared between copies of the attachment rather than being a
+	/// flyweight, as attachments are rarely identical and hashing megabytes
+	/// of font data to find out isn't worth it.
+	std::shared_ptr<const std::string> entry_data;
 
 	/// Name of the attached file, with SSA font mangling if it is a ttf
 	boost::flyweight<std::string> filename;
@@ -34,8 +40,9 @@ public:
 	/// Get the size of the attached file in bytes
 	size_t GetSize() const;
 
-	/// Add a line of data (without newline) read from a subtitle file
-	void AddData(std::string const& data) { entry_data = entry_data.get() + data + "\r\n"; }
+	/// Add data read from a subtitle file. Multiple lines must be separated
+	/// by line breaks, and a line break is added after the last one.
+	void AddData(std::string const& data);
 
 	/// Extract the contents of this attachment to a file
 	/// @param filename Path to save the attachment to
@@ -45,7 +52,7 @@ public:
 	/// @param raw If false, remove the SSA filename mangling
 	std::string GetFileName(bool raw=false) const;
 
-	std::string const& GetEntryData() const { return entry_data; }
+	std::string const& GetEntryData() const { return *entry_data; }
 	AssEntryGroup Group() const override;
 
 	AssAttachment(AssAttachment const& rgt) = default;
@@ -46,6 +46,7 @@
 #include <boost/regex.hpp>
 #include <boost/spirit/include/karma_generate.hpp>
 #include <boost/spirit/include/karma_int.hpp>
+#include <unordered_map>
 
 using namespace boost::adaptors;
 
@@ -166,8 +167,62 @@ static void append_unsafe_str(std::string &out, std::string const& str) {
 	out += ',';
 }
 
+struct AssDialogue::EntryData {
+	bool Comment;
+	int Layer;
+	std::array<int, 3> Margin;
+	int Start;
+	int End;
+	boost::flyweight<std::string> Style;
+	boost::flyweight<std::string> Actor;
+	boost::flyweight<std::string> Effect;
+	boost::flyweight<std::vector<uint32_t>> ExtradataIds;
+	boost::flyweight<std::string> Text;
+
+	std::string data;
+
+	EntryData(AssDialogueBase const& line)
+	: Comment(line.Comment)
+	, Layer(line.Layer)
+	, Margin(line.Margin)
+	, Start(line.Start)
+	, End(line.End)
+	, Style(line.Style)
+	, Actor(line.Actor)
+	, Effect(line.Effect)
+	, ExtradataIds(line.ExtradataIds)
+	, Text(line.Text)
+	{
+	}
+
+	/// Is this still the serialized form of the given line?
+	/// All of the string fields are flyweights, so this is just a handful of
+	/// integer and pointer comparisons.
+	bool Matches(AssDialogueBase const& line) const {
+		return Comment == line.Comment
+			&& Layer == line.Layer
+			&& Margin == line.Margin
+			&& Start == (int)line.Start
+			&& End == (int)line.End
+			&& Style == line.Style
+			&& Actor == line.Actor
+			&& Effect == line.Effect
+			&& ExtradataIds == line.ExtradataIds
+			&& Text == line.Text;
+	}
+};
+
 std::string AssDialogue::GetEntryData() const {
-	std::string str = Comment ? "Comment: " : "Dialogue: ";
+	// Lines can be serialized from several threads at once (e.g. Lua's raw
+	// field and the ParallelFor users), so the cache is only ever swapped
+	// atomically and never modified once published
+	auto cached = std::atomic_load(&entry_data);
+	if (cached && cached->Matches(*this))
+		return cached->data;
+
+	auto cache = std::make_shared<EntryData>(*this);
+	std::string& str = cache->data;
+	str = Comment ? "Comment: " : "Dialogue: ";
 	str.reserve(51 + Style.get().size() + Actor.get().size() + Effect.get().size() + Text.get().size());
 
 	append_int(str, Layer);
@@ -193,6 +248,7 @@ std::string AssDialogue::GetEntryData() const {
 			str += c;
 	}
 
+	std::atomic_store(&entry_data, std::shared_ptr<const EntryData>(cache));
 	return str;
 }
 
@@ -266,6 +322,13 @@ plain:
 	return Blocks;
 }
 
+std::shared_ptr<const std::vector<std::unique_ptr<AssDialogueBlock>>> AssDialogue::GetParsedTags(ParsedTagsCache &cache) const {
+	auto& blocks = cache.blocks[Text];
+	if (!blocks)
+		blocks = std::make_shared<std::vector<std::unique_ptr<AssDialogueBlock>>>(ParseTags());
+	return blocks;
+}
+
 void AssDialogue::StripTags() {
 	Text = GetStrippedText();
 }
@@ -281,7 +344,7 @@ bool AssDialogue::CollidesWith(const AssDialogue *target) const {
 	return ((Start < target->Start) ? (target->Start < End) : (Start < target->End));
 }
 
-static std::string get_text_p(AssDialogueBlock *d) { return d->GetText(); }
+static std::string const& get_text_p(const AssDialogueBlockPlain *d) { return d->text; }
 std::string AssDialogue::GetStrippedText() const {
 	auto blocks = ParseTags();
 	return join(blocks | agi::of_type<AssDialogueBlockPlain>() | transformed(get_text_p), "");
@@ -30,12 +30,15 @@
 
 #include "ass_entry.h"
 #include "ass_override.h"
+#include "flyweight_hash.h"
 #include "fold_controller.h"
 
 #include <libaegisub/ass/time.h>
 
 #include <array>
 #include <boost/flyweight.hpp>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 enum class AssBlockType {
@@ -151,7 +154,16 @@ struct AssDialogueBase {
 	boost::flyweight<std::string> Text;
 };
 
+class ParsedTagsCache;
+
 class AssDialogue final : public AssEntry, public AssDialogueBase, public AssEntryListHook {
+	struct EntryData;
+	/// Serialized form of the line from the last call to GetEntryData, along
+	/// with the field values it was built from, so that it's rebuilt only once
+	/// any of those fields have changed. Only accessed with std::atomic_load
+	/// and std::atomic_store, and not copied along with the line.
+	mutable std::shared_ptr<const EntryData> entry_data;
+
 	/// @brief Parse raw ASS data into everything else
 	/// @param data ASS line
 	void Parse(std::string const& data);
@@ -161,6 +173,13 @@ public:
 	/// Parse text as ASS and return block information
 	std::vector<std::unique_ptr<AssDialogueBlock>> ParseTags() const;
 
+	/// @brief Get the parsed blocks of the line's text, which must not be modified
+	///
+	/// The blocks are shared with every other line with the same text which
+	/// was looked up in the cache. Use ParseTags() to get blocks which can be
+	/// edited and passed to UpdateText(), or when there's no cache to use.
+	std::shared_ptr<const std::vector<std::unique_ptr<AssDialogueBlock>>> GetParsedTags(ParsedTagsCache &cache) const;
+
 	/// Strip all ASS tags from the text
 	void StripTags();
 	/// Strip a specific ASS tag from the text
@@ -169,6 +188,7 @@ public:
 
 	/// Update the text of the line from parsed blocks
 	void UpdateText(std::vector<std::unique_ptr<AssDialogueBlock>>& blocks);
+	/// Get the line formatted as it would appear in an ASS file
 	std::string GetEntryData() const;
 
 	/// Does this line collide with the passed line?
@@ -181,3 +201,21 @@ public:
 	~AssDialogue();
 };
 
+/// Parsed blocks of line texts, for operations which look at the tags of
+/// many lines or of the same lines repeatedly. Keep one for as long as the
+/// operation runs and pass it to AssDialogue::GetParsedTags.
+///
+/// Entries are keyed on the text and hold a reference to it, so they can't be
+/// returned for any other text, but they do keep texts which are no longer
+/// used alive until the cache is cleared. Parsed parameters evaluate some
+/// values lazily on access, so a cache and the blocks from it must only be
+/// used on one thread at a time.
+class ParsedTagsCache {
+	friend class AssDialogue;
+	std::unordered_map<boost::flyweight<std::string>, std::shared_ptr<const std::vector<std::unique_ptr<AssDialogueBlock>>>> blocks;
+
+public:
+	/// Number of distinct texts with parsed blocks in the cache
+	size_t Size() const { return blocks.size(); }
+	void Clear() { blocks.clear(); }
+};
@@ -43,14 +43,17 @@ AssKaraoke::AssKaraoke(const AssDialogue *line, bool auto_split, bool normalize)
 	if (line) SetLine(line, auto_split, normalize);
 }
 
-void AssKaraoke::SetLine(const AssDialogue *line, bool auto_split, bool normalize) {
+void AssKaraoke::SetLine(const AssDialogue *line, bool auto_split, bool normalize, ParsedTagsCache *parsed_tags) {
 	syls.clear();
 	Syllable syl;
 	syl.start_time = line->Start;
 	syl.duration = 0;
 	syl.tag_type = "\\k";
 
-	ParseSyllables(line, syl);
+	if (parsed_tags)
+		ParseSyllables(*line->GetParsedTags(*parsed_tags), syl);
+	else
+		ParseSyllables(line->ParseTags(), syl);
 
 	if (normalize) {
 		// Normalize the syllables so that the total duration is equal to the line length
@@ -87,8 +90,8 @@ void AssKaraoke::SetLine(const AssDialogue *line, bool auto_split, bool normaliz
 	AnnounceSyllablesChanged();
 }
 
-void AssKaraoke::ParseSyllables(const AssDialogue *line, Syllable &syl) {
-	for (auto& block : line->ParseTags()) {
+void AssKaraoke::ParseSyllables(std::vector<std::unique_ptr<AssDialogueBlock>> const& blocks, Syllable &syl) {
+	for (auto& block : blocks) {
 		std::string text = block->GetText();
 
 		switch (block->GetType()) {
@@ -104,17 +107,13 @@ void AssKaraoke::ParseSyllables(const AssDialogue *line, Syllable &syl) {
 		case AssBlockType::OVERRIDE:
 			auto ovr = static_cast<AssDialogueBlockOverride*>(block.get());
 			bool in_tag = false;
-			for (auto& tag : ovr->Tags) {
+			for (auto const& tag : ovr->Tags) {
 				if (tag.IsValid() && boost::istarts_with(tag.Name, "\\k")) {
 					if (in_tag) {
 						syl.ovr_tags[syl.text.size()] += "}";
 						in_tag = false;
 					}
 
-					// Dealing with both \K and \kf is mildly annoying so just
-					// convert them both to \kf
-					if (tag.Name == "\\K") tag.Name = "\\kf";
-
 					// Don't bother including zero duration zero length syls
 					if (syl.duration > 0 || !syl.text.empty()) {
 						syls.push_back(syl);
@@ -122,7 +121,9 @@ void AssKaraoke::ParseSyllables(const AssDialogue *line, Syllable &syl) {
 						syl.ovr_tags.clear();
 					}
 
-					syl.tag_type = tag.Name;
+					// Dealing with both \K and \kf is mildly annoying so just
+					// convert them both to \kf
+					syl.tag_type = tag.Name == "\\K" ? "\\kf" : tag.Name;
 					syl.start_time += syl.duration;
 					syl.duration = tag.Params[0].Get(0) * 10;
 				}
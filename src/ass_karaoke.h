@@ -15,6 +15,7 @@
 // Aegisub Project http://www.aegisub.org/
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -22,6 +23,8 @@
 
 namespace agi { struct Context; }
 class AssDialogue;
+class AssDialogueBlock;
+class ParsedTagsCache;
 
 /// @class AssKaraoke
 /// @brief Karaoke parser and parsed karaoke data model
@@ -46,7 +49,7 @@ private:
 	bool no_announce = false;
 
 	agi::signal::Signal<> AnnounceSyllablesChanged;
-	void ParseSyllables(const AssDialogue *line, Syllable &syl);
+	void ParseSyllables(std::vector<std::unique_ptr<AssDialogueBlock>> const& blocks, Syllable &syl);
 
 public:
 	/// Constructor
@@ -56,7 +59,8 @@ public:
 	AssKaraoke(const AssDialogue *line = nullptr, bool auto_split = false, bool normalize = true);
 
 	/// Parse a dialogue line
-	void SetLine(const AssDialogue *line, bool auto_split = false, bool normalize = true);
+	/// @param parsed_tags Cache to look up the line's parsed blocks in, if any
+	void SetLine(const AssDialogue *line, bool auto_split = false, bool normalize = true, ParsedTagsCache *parsed_tags = nullptr);
 
 	/// Add a split before character pos in syllable syl_idx
 	void AddSplit(size_t syl_idx, size_t pos);
@@ -152,7 +152,7 @@ struct AssOverrideTagProto {
 	/// Parameters to this tag
 	std::vector<AssOverrideParamProto> params;
 
-	typedef std::vector<AssOverrideTagProto>::iterator iterator;
+	typedef std::vector<AssOverrideTagProto>::const_iterator iterator;
 
 	/// @brief Add a parameter to this tag prototype
 	/// @param type Data type of the parameter
@@ -173,11 +173,8 @@ struct AssOverrideTagProto {
 	}
 };
 
-static std::vector<AssOverrideTagProto> proto;
-static void load_protos() {
-	if (!proto.empty()) return;
-
-	proto.resize(56);
+static std::vector<AssOverrideTagProto> make_protos() {
+	std::vector<AssOverrideTagProto> proto(56);
 	int i = 0;
 
 	// Longer tag names must appear before shorter tag names
@@ -305,6 +302,16 @@ static void load_protos() {
 	proto[i].AddParam(VariableDataType::INT, AssParameterClass::RELATIVE_TIME_START,OPTIONAL_3 | OPTIONAL_4);
 	proto[i].AddParam(VariableDataType::FLOAT, AssParameterClass::NORMAL,OPTIONAL_2 | OPTIONAL_4);
 	proto[i].AddParam(VariableDataType::BLOCK);
+
+	return proto;
+}
+
+/// Tags are parsed from several threads at once (e.g. by the fonts
+/// collector), so the table is built by a thread-safe static initializer
+/// rather than on first use
+static std::vector<AssOverrideTagProto> const& protos() {
+	static const std::vector<AssOverrideTagProto> proto = make_protos();
+	return proto;
 }
 
 std::vector<std::string> tokenize(const std::string &text) {
@@ -441,7 +448,7 @@ void AssOverrideTag::Clear() {
 }
 
 void AssOverrideTag::SetText(const std::string &text) {
-	load_protos();
+	auto const& proto = protos();
 	for (auto cur = proto.begin(); cur != proto.end(); ++cur) {
 		if (boost::starts_with(text, cur->name)) {
 			Name = cur->name;
@@ -118,18 +118,30 @@ void AssParser::ParseAttachmentLine(std::string const& data) {
 
 	// Data is over, add attachment to the file
 	if (!valid_data || is_filename) {
-		target->Attachments.push_back(*attach.release());
+		FinishAttachment();
 		AddLine(data);
 	}
 	else {
-		attach->AddData(data);
+		// Collect the lines here rather than adding each one to the
+		// attachment, which would copy all of the data so far every time
+		if (!attach_data.empty())
+			attach_data += "\r\n";
+		attach_data += data;
 
 		// Done building
 		if (data.size() < 80)
-			target->Attachments.push_back(*attach.release());
+			FinishAttachment();
 	}
 }
 
+void AssParser::FinishAttachment() {
+	if (!attach_data.empty())
+		attach->AddData(attach_data);
+	attach_data.clear();
+	target->Attachments.push_back(std::move(*attach));
+	attach.reset();
+}
+
 void AssParser::ParseScriptInfoLine(std::string const& data) {
 	if (boost::starts_with(data, ";")) {
 		// Skip stupid comments added by other programs
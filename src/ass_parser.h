@@ -13,6 +13,7 @@
 // OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 #include <memory>
+#include <string>
 
 class AssAttachment;
 class AssFile;
@@ -24,9 +25,12 @@ class AssParser {
 	AssFile *target;
 	int version;
 	std::unique_ptr<AssAttachment> attach;
+	/// Data lines of the attachment being read, separated by line breaks
+	std::string attach_data;
 	void (AssParser::*state)(std::string const&);
 
 	void ParseAttachmentLine(std::string const& data);
+	void FinishAttachment();
 	void ParseEventLine(std::string const& data);
 	void ParseStyleLine(std::string const& data);
 	void ParseScriptInfoLine(std::string const& data);
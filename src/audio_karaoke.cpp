@@ -65,6 +65,7 @@ AudioKaraoke::AudioKaraoke(wxWindow *parent, agi::Context *c)
 , audio_opened(c->project->AddAudioProviderListener(&AudioKaraoke::OnAudioOpened, this))
 , active_line_changed(c->selectionController->AddActiveLineListener(&AudioKaraoke::OnActiveLineChanged, this))
 , kara(agi::make_unique<AssKaraoke>())
+, parsed_tags(agi::make_unique<ParsedTagsCache>())
 {
 	using std::bind;
 
@@ -114,6 +115,7 @@ void AudioKaraoke::OnActiveLineChanged(AssDialogue *new_line) {
 }
 
 void AudioKaraoke::OnFileChanged(int type, const AssDialogue *changed) {
+	parsed_tags->Clear();
 	if (enabled && (type & AssFile::COMMIT_DIAG_FULL) && (!changed || changed == active_line)) {
 		LoadFromLine();
 		split_area->Refresh(false);
@@ -335,7 +337,7 @@ void AudioKaraoke::OnScrollTimer(wxTimerEvent&) {
 void AudioKaraoke::LoadFromLine() {
 	scroll_x = 0;
 	scroll_timer.Stop();
-	kara->SetLine(active_line, true);
+	kara->SetLine(active_line, true, true, parsed_tags.get());
 	SetDisplayText();
 	accept_button->Enable(kara->GetText() != active_line->Text);
 	cancel_button->Enable(false);
@@ -26,6 +26,7 @@
 
 class AssDialogue;
 class AssKaraoke;
+class ParsedTagsCache;
 class wxButton;
 namespace agi { class AudioProvider; }
 namespace agi { struct Context; }
@@ -72,6 +73,8 @@ class AudioKaraoke final : public wxWindow {
 	AssDialogue *active_line = nullptr;
 	/// Karaoke data
 	std::unique_ptr<AssKaraoke> kara;
+	/// Parsed tags of the lines loaded since the last commit
+	std::unique_ptr<ParsedTagsCache> parsed_tags;
 
 	/// Current line's stripped text with spaces added between each syllable
 	std::vector<wxString> spaced_text;
@@ -56,10 +56,9 @@ AudioMarkerProviderKeyframes::AudioMarkerProviderKeyframes(agi::Context *c, cons
 AudioMarkerProviderKeyframes::~AudioMarkerProviderKeyframes() { }
 
 void AudioMarkerProviderKeyframes::Update() {
-	auto const& keyframes = p->Keyframes();
-	auto const& timecodes = p->Timecodes();
+	auto const& keyframes = p->IndexedKeyframes();
 
-	if (keyframes.empty() || !timecodes.IsLoaded() || !enabled_opt->GetBool()) {
+	if (!keyframes.HasTimes() || !enabled_opt->GetBool()) {
 		if (!markers.empty()) {
 			markers.clear();
 			AnnounceMarkerMoved();
@@ -69,8 +68,8 @@ void AudioMarkerProviderKeyframes::Update() {
 
 	markers.clear();
 	markers.reserve(keyframes.size());
-	for (int frame : keyframes)
-		markers.emplace_back(style.get(), timecodes.TimeAtFrame(frame, agi::vfr::START));
+	for (int time : keyframes.StartTimes())
+		markers.emplace_back(style.get(), time);
 	AnnounceMarkerMoved();
 }
 
@@ -57,8 +57,10 @@
 
 #include <libaegisub/dispatch.h>
 #include <libaegisub/format.h>
+#include <libaegisub/log.h>
 #include <libaegisub/lua/ffi.h>
 #include <libaegisub/lua/modules.h>
+#include <libaegisub/lua/script_cache.h>
 #include <libaegisub/lua/script_reader.h>
 #include <libaegisub/lua/utils.h>
 #include <libaegisub/make_unique.h>
@@ -70,6 +72,8 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/scope_exit.hpp>
 #include <cassert>
+#include <chrono>
+#include <luajit.h>
 #include <mutex>
 #include <wx/clipbrd.h>
 #include <wx/log.h>
@@ -489,6 +493,32 @@ namespace {
 		wxString help;
 		int cmd_type;
 
+		/// The state of the project the validation function was last run
+		/// for, and what it returned. Validate is called every time a menu
+		/// or toolbar is updated, so rerunning the function when nothing it
+		/// can see has changed is just wasted time.
+		struct ValidationCache {
+			const agi::Context *context = nullptr;
+			int commit_id = -1;
+			int selection_version = -1;
+			int project_version = -1;
+			const void *video_provider = nullptr;
+			int video_frame = -1;
+			int audio_selection_start = -1;
+			int audio_selection_end = -1;
+			int text_selection_start = -1;
+			int text_selection_end = -1;
+			int text_insertion_point = -1;
+			bool valid = false;
+			bool result = false;
+
+			bool operator==(ValidationCache const& other) const;
+		} last_validation;
+
+		/// Actually call the validation function, bypassing the cache
+		/// @param[out] cacheable Can the result be reused until the project changes?
+		bool RunValidate(const agi::Context *c, bool& cacheable);
+
 	public:
 		LuaCommand(lua_State *L);
 		~LuaCommand();
@@ -598,7 +628,7 @@ namespace {
 
 		// Replace the default lua module loader with our unicode compatible
 		// one and set the module search path
-		if (!Install(L, include_path)) {
+		if (!Install(L, include_path, config::path->Decode("?local/automation-cache"))) {
 			description = get_string_or_default(L, 1);
 			lua_pop(L, 1);
 			return;
@@ -908,16 +938,85 @@ namespace {
 		return rows;
 	}
 
+	/// Maximum time a macro validation function may run for before it's
+	/// aborted and the macro treated as not applicable
+	const auto validation_time_limit = std::chrono::milliseconds(500);
+
+	/// Registry key for the deadline of the validation function currently
+	/// running in a state, stored as a light userdata pointing at the
+	/// time_point so that each script's state has its own
+	const char validation_deadline_key[] = "aegisub.validation_deadline";
+
+	void validation_time_limit_hook(lua_State *L, lua_Debug *)
+	{
+		lua_getfield(L, LUA_REGISTRYINDEX, validation_deadline_key);
+		auto deadline = static_cast<std::chrono::steady_clock::time_point *>(lua_touserdata(L, -1));
+		lua_pop(L, 1);
+		if (deadline && std::chrono::steady_clock::now() > *deadline)
+			luaL_error(L, "Validation function took longer than %d ms and was aborted",
+				(int)validation_time_limit.count());
+	}
+
+	bool LuaCommand::ValidationCache::operator==(ValidationCache const& other) const
+	{
+		return context == other.context &&
+			commit_id == other.commit_id &&
+			selection_version == other.selection_version &&
+			project_version == other.project_version &&
+			video_provider == other.video_provider &&
+			video_frame == other.video_frame &&
+			audio_selection_start == other.audio_selection_start &&
+			audio_selection_end == other.audio_selection_end &&
+			text_selection_start == other.text_selection_start &&
+			text_selection_end == other.text_selection_end &&
+			text_insertion_point == other.text_insertion_point;
+	}
+
 	bool LuaCommand::Validate(const agi::Context *c)
 	{
 		if (!(cmd_type & cmd::COMMAND_VALIDATE)) return true;
 
+		// Everything which the functions in the aegisub table can read
+		ValidationCache state;
+		state.context = c;
+		state.commit_id = c->subsController->GetCommitId();
+		state.selection_version = c->selectionController->GetVersion();
+		state.project_version = c->project->GetVersion();
+		state.video_provider = c->project->VideoProvider();
+		state.video_frame = c->videoController->GetFrameN();
+		if (c->audioController && c->audioController->GetTimingController()) {
+			const TimeRange range = c->audioController->GetTimingController()->GetActiveLineRange();
+			state.audio_selection_start = range.begin();
+			state.audio_selection_end = range.end();
+		}
+		state.text_selection_start = c->textSelectionController->GetStagedSelectionStart();
+		state.text_selection_end = c->textSelectionController->GetStagedSelectionEnd();
+		state.text_insertion_point = c->textSelectionController->GetStagedInsertionPoint();
+		if (last_validation.valid && last_validation == state)
+			return last_validation.result;
+
+		bool cacheable = false;
+		state.result = RunValidate(c, cacheable);
+		state.valid = cacheable;
+		last_validation = state;
+		return state.result;
+	}
+
+	bool LuaCommand::RunValidate(const agi::Context *c, bool& cacheable)
+	{
 		set_context(L, c);
 
 		// Error handler goes under the function to call
 		lua_pushcclosure(L, add_stack_trace, 0);
 
 		GetFeatureFunction("validate");
+
+		// Hooks aren't called from compiled code, so the time limit can only
+		// be enforced if the function is interpreted. This only affects the
+		// validator and the functions defined inside it, so the rest of the
+		// script's compiled code is kept.
+		luaJIT_setmode(L, -1, LUAJIT_MODE_ALLFUNC | LUAJIT_MODE_OFF);
+
 		auto subsobj = new LuaAssFile(L, c->ass.get());
 
 		push_value(L, selected_rows(c));
@@ -926,24 +1025,42 @@ namespace {
 		else
 			lua_pushnil(L);
 
-		int err = lua_pcall(L, 3, 2, -5 /* three args, function, error handler */);
+		auto start = std::chrono::steady_clock::now();
+		auto deadline = start + validation_time_limit;
+		lua_pushlightuserdata(L, &deadline);
+		lua_setfield(L, LUA_REGISTRYINDEX, validation_deadline_key);
+		lua_sethook(L, validation_time_limit_hook, LUA_MASKCOUNT, 1000);
+		int err = lua_pcall(L, 3, 3, -5 /* three args, function, error handler */);
+		lua_sethook(L, nullptr, 0, 0);
+		lua_pushnil(L);
+		lua_setfield(L, LUA_REGISTRYINDEX, validation_deadline_key);
 		subsobj->ProcessingComplete();
 
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		if (elapsed > validation_time_limit / 5)
+			LOG_D("automation/lua/validate") << LuaScript::GetScriptObject(L)->GetName()
+				<< ": " << cmd_name << " took "
+				<< std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms";
+
 		if (err) {
 			wxLogWarning("Runtime error in Lua macro validation function:\n%s", get_wxstring(L, -1));
 			lua_pop(L, 2);
 			return false;
 		}
 
-		bool result = !!lua_toboolean(L, -2);
+		bool result = !!lua_toboolean(L, -3);
 
-		wxString new_help_string(get_wxstring(L, -1));
+		wxString new_help_string(get_wxstring(L, -2));
 		if (new_help_string.size()) {
 			help = new_help_string;
 			cmd_type |= cmd::COMMAND_DYNAMIC_HELP;
 		}
 
-		lua_pop(L, 3); // two return values and error handler
+		// Scripts which look at things other than the project state can
+		// return false as the third value to be asked again every time
+		cacheable = lua_isnil(L, -1) || lua_toboolean(L, -1);
+
+		lua_pop(L, 4); // three return values and error handler
 
 		return result;
 	}
@@ -1194,6 +1311,9 @@ namespace Automation4 {
 	LuaScriptFactory::LuaScriptFactory()
 	: ScriptFactory("Lua", "*.lua,*.moon")
 	{
+		// Cache files are replaced in place when a script changes, but
+		// nothing else would ever remove those for scripts which are gone
+		PruneCache(config::path->Decode("?local/automation-cache"));
 	}
 
 	std::unique_ptr<Script> LuaScriptFactory::Produce(agi::fs::path const& filename) const
@@ -30,6 +30,7 @@
 #include "auto4_base.h"
 
 #include <deque>
+#include <memory>
 #include <vector>
 #include <wx/string.h>
 
@@ -72,8 +73,14 @@ namespace Automation4 {
 
 		/// Set of subtitle lines being modified; initially a shallow copy of ass->Line
 		std::vector<AssEntry*> lines;
+		/// Has lines been filled in yet?
+		bool lines_initialized = false;
 		bool script_info_copied = false;
 
+		/// Shared with line proxies handed out to Lua, and cleared once the
+		/// lines they point to may no longer be valid
+		std::shared_ptr<bool> lines_valid = std::make_shared<bool>(true);
+
 		/// Commits to apply once processing completes successfully
 		std::deque<PendingCommit> pending_commits;
 		/// Lines to delete once processing complete successfully
@@ -86,6 +93,10 @@ namespace Automation4 {
 		/// to happen when the user modifies the headers in some way, which
 		/// most runs of a script will not do.
 		void InitScriptInfoIfNeeded();
+		/// Build the list of lines from the file if it hasn't already been
+		/// done. Modifiable files do this immediately, while read-only ones
+		/// wait until the script first asks for a line.
+		void InitLinesIfNeeded();
 		/// Add the line at the given index to the list of lines to be deleted
 		/// when the script completes, unless it's an AssInfo, since those are
 		/// owned by the container.
@@ -104,6 +115,8 @@ namespace Automation4 {
 		void ObjectGarbageCollect(lua_State *L);
 		int ObjectIPairs(lua_State *L);
 		int IterNext(lua_State *L);
+		int ObjectLines(lua_State *L);
+		int LinesNext(lua_State *L);
 
 		int LuaParseKaraokeData(lua_State *L);
 		int LuaGetScriptResolution(lua_State *L);
@@ -117,6 +130,9 @@ namespace Automation4 {
 
 		/// makes a Lua representation of AssEntry and places on the top of the stack
 		void AssEntryToLua(lua_State *L, size_t idx);
+		/// makes a read-only proxy for the AssEntry whose fields are only
+		/// converted when accessed, and places it on the top of the stack
+		void AssEntryToLuaProxy(lua_State *L, size_t idx);
 		/// assumes a Lua representation of AssEntry on the top of the stack, and creates an AssEntry object of it
 		static std::unique_ptr<AssEntry> LuaToAssEntry(lua_State *L, AssFile *ass=nullptr);
 
@@ -128,40 +128,32 @@ namespace {
 	const T *check_cast_constptr(const U *value) {
 		return typeid(const T) == typeid(*value) ? static_cast<const T *>(value) : nullptr;
 	}
-}
-
-namespace Automation4 {
-	LuaAssFile::~LuaAssFile() { }
 
-	void LuaAssFile::CheckAllowModify()
+	void push_extradata(lua_State *L, const AssDialogue *dia, const AssFile *ass)
 	{
-		if (!can_modify)
-			error(L, "Attempt to modify subtitles in read-only feature context.");
-	}
-
-	void LuaAssFile::CheckBounds(int idx)
-	{
-		if (idx <= 0 || idx > (int)lines.size())
-			error(L, "Requested out-of-range line from subtitle file: %d", idx);
+		auto const& ids = dia->ExtradataIds.get();
+		lua_createtable(L, 0, ids.size());
+		if (ids.empty()) return;
+		for (auto const& ed : ass->GetExtradata(ids)) {
+			push_value(L, ed.key);
+			push_value(L, ed.value);
+			lua_settable(L, -3);
+		}
 	}
 
-	void LuaAssFile::AssEntryToLua(lua_State *L, size_t idx)
+	void push_entry(lua_State *L, const AssEntry *e, const AssFile *ass)
 	{
-		lua_newtable(L);
-
-		const AssEntry *e = lines[idx];
-		if (!e)
-			e = &ass->Info[idx];
-
-		set_field(L, "section", e->GroupHeader());
-
 		if (auto info = check_cast_constptr<AssInfo>(e)) {
+			lua_createtable(L, 0, 5);
+			set_field(L, "section", e->GroupHeader());
 			set_field(L, "raw", info->GetEntryData());
 			set_field(L, "key", info->Key());
 			set_field(L, "value", info->Value());
 			set_field(L, "class", "info");
 		}
 		else if (auto dia = check_cast_constptr<AssDialogue>(e)) {
+			lua_createtable(L, 0, 17);
+			set_field(L, "section", e->GroupHeader());
 			set_field(L, "raw", dia->GetEntryData());
 			set_field(L, "comment", dia->Comment);
 
@@ -170,29 +162,25 @@ namespace Automation4 {
 			set_field(L, "start_time", dia->Start);
 			set_field(L, "end_time", dia->End);
 
-			set_field(L, "style", std::string(dia->Style));
-			set_field(L, "actor", std::string(dia->Actor));
-			set_field(L, "effect", std::string(dia->Effect));
+			set_field(L, "style", dia->Style.get());
+			set_field(L, "actor", dia->Actor.get());
+			set_field(L, "effect", dia->Effect.get());
 
 			set_field(L, "margin_l", dia->Margin[0]);
 			set_field(L, "margin_r", dia->Margin[1]);
 			set_field(L, "margin_t", dia->Margin[2]);
 			set_field(L, "margin_b", dia->Margin[2]);
 
-			set_field(L, "text", std::string(dia->Text));
+			set_field(L, "text", dia->Text.get());
 
-			// create extradata table
-			lua_newtable(L);
-			for (auto const& ed : ass->GetExtradata(dia->ExtradataIds)) {
-				push_value(L, ed.key);
-				push_value(L, ed.value);
-				lua_settable(L, -3);
-			}
+			push_extradata(L, dia, ass);
 			lua_setfield(L, -2, "extra");
 
 			set_field(L, "class", "dialogue");
 		}
 		else if (auto sty = check_cast_constptr<AssStyle>(e)) {
+			lua_createtable(L, 0, 27);
+			set_field(L, "section", e->GroupHeader());
 			set_field(L, "raw", sty->GetEntryData());
 			set_field(L, "name", sty->name);
 
@@ -235,7 +223,161 @@ namespace Automation4 {
 		}
 		else {
 			assert(false);
+			lua_newtable(L);
+		}
+	}
+
+	/// Read-only view of a line which converts fields to Lua values only when
+	/// they are accessed
+	struct LineProxy {
+		/// Cleared by the LuaAssFile once the entry may have been deleted
+		std::shared_ptr<bool> valid;
+		const AssEntry *entry;
+		const AssFile *ass;
+		/// Registry reference to the full table for non-dialogue lines,
+		/// built on first access
+		int table_ref = LUA_NOREF;
+
+		LineProxy(std::shared_ptr<bool> valid, const AssEntry *entry, const AssFile *ass)
+		: valid(std::move(valid)), entry(entry), ass(ass) { }
+	};
+
+	const char line_proxy_mt[] = "SubtitleLineProxy";
+
+	/// Get the line proxy at the given stack index, or nullptr if it isn't one
+	LineProxy *get_line_proxy(lua_State *L, int idx)
+	{
+		if (lua_type(L, idx) != LUA_TUSERDATA || !lua_getmetatable(L, idx))
+			return nullptr;
+		luaL_getmetatable(L, line_proxy_mt);
+		bool is_proxy = !!lua_rawequal(L, -1, -2);
+		lua_pop(L, 2);
+		return is_proxy ? static_cast<LineProxy *>(lua_touserdata(L, idx)) : nullptr;
+	}
+
+	LineProxy& check_line_proxy(lua_State *L, int idx)
+	{
+		auto& proxy = get<LineProxy>(L, idx, line_proxy_mt);
+		if (!*proxy.valid)
+			error(L, "Subtitle line is no longer valid");
+		return proxy;
+	}
+
+	int line_proxy_index(lua_State *L)
+	{
+		auto& proxy = check_line_proxy(L, 1);
+
+		auto dia = check_cast_constptr<AssDialogue>(proxy.entry);
+		if (!dia) {
+			// Only dialogue lines are numerous enough to be worth converting
+			// field-by-field, so other lines are converted once and the
+			// table kept for any further accesses
+			if (proxy.table_ref == LUA_NOREF) {
+				push_entry(L, proxy.entry, proxy.ass);
+				proxy.table_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+			}
+			lua_rawgeti(L, LUA_REGISTRYINDEX, proxy.table_ref);
+			lua_pushvalue(L, 2);
+			lua_rawget(L, -2);
+			return 1;
+		}
+
+		// Line tables only have string keys
+		if (lua_type(L, 2) != LUA_TSTRING) {
+			lua_pushnil(L);
+			return 1;
 		}
+		auto key = check_string(L, 2);
+
+		if (key == "class")            push_value(L, "dialogue");
+		else if (key == "section")     push_value(L, dia->GroupHeader());
+		else if (key == "raw")         push_value(L, dia->GetEntryData());
+		else if (key == "comment")     push_value(L, dia->Comment);
+		else if (key == "layer")       push_value(L, dia->Layer);
+		else if (key == "start_time")  push_value(L, (int)dia->Start);
+		else if (key == "end_time")    push_value(L, (int)dia->End);
+		else if (key == "style")       push_value(L, dia->Style.get());
+		else if (key == "actor")       push_value(L, dia->Actor.get());
+		else if (key == "effect")      push_value(L, dia->Effect.get());
+		else if (key == "margin_l")    push_value(L, dia->Margin[0]);
+		else if (key == "margin_r")    push_value(L, dia->Margin[1]);
+		else if (key == "margin_t")    push_value(L, dia->Margin[2]);
+		else if (key == "margin_b")    push_value(L, dia->Margin[2]);
+		else if (key == "text")        push_value(L, dia->Text.get());
+		else if (key == "extra")       push_extradata(L, dia, proxy.ass);
+		else                           lua_pushnil(L);
+		return 1;
+	}
+
+	int line_proxy_newindex(lua_State *L)
+	{
+		check_line_proxy(L, 1);
+		return error(L, "Subtitle line proxies are read-only. Use subs[i] to get a line which can be modified.");
+	}
+
+	int line_proxy_gc(lua_State *L)
+	{
+		auto proxy = static_cast<LineProxy *>(lua_touserdata(L, 1));
+		luaL_unref(L, LUA_REGISTRYINDEX, proxy->table_ref);
+		proxy->~LineProxy();
+		return 0;
+	}
+
+	std::unique_ptr<AssEntry> clone_entry(const AssEntry *e)
+	{
+		if (auto info = check_cast_constptr<AssInfo>(e))
+			return agi::make_unique<AssInfo>(*info);
+		if (auto dia = check_cast_constptr<AssDialogue>(e))
+			return agi::make_unique<AssDialogue>(*dia);
+		if (auto sty = check_cast_constptr<AssStyle>(e))
+			return agi::make_unique<AssStyle>(*sty);
+		return nullptr;
+	}
+}
+
+namespace Automation4 {
+	LuaAssFile::~LuaAssFile() { }
+
+	void LuaAssFile::CheckAllowModify()
+	{
+		if (!can_modify)
+			error(L, "Attempt to modify subtitles in read-only feature context.");
+	}
+
+	void LuaAssFile::CheckBounds(int idx)
+	{
+		if (idx <= 0 || idx > (int)lines.size())
+			error(L, "Requested out-of-range line from subtitle file: %d", idx);
+	}
+
+	void LuaAssFile::InitLinesIfNeeded()
+	{
+		if (lines_initialized) return;
+		lines_initialized = true;
+
+		lines.insert(lines.end(), ass->Info.size(), nullptr);
+		for (auto& line : ass->Styles)
+			lines.push_back(&line);
+		for (auto& line : ass->Events)
+			lines.push_back(&line);
+	}
+
+	void LuaAssFile::AssEntryToLua(lua_State *L, size_t idx)
+	{
+		const AssEntry *e = lines[idx];
+		if (!e)
+			e = &ass->Info[idx];
+
+		push_entry(L, e, ass);
+	}
+
+	void LuaAssFile::AssEntryToLuaProxy(lua_State *L, size_t idx)
+	{
+		const AssEntry *e = lines[idx];
+		if (!e)
+			e = &ass->Info[idx];
+
+		make<LineProxy>(L, line_proxy_mt, lines_valid, e, ass);
 	}
 
 	std::unique_ptr<AssEntry> LuaAssFile::LuaToAssEntry(lua_State *L, AssFile *ass)
@@ -243,6 +385,12 @@ namespace Automation4 {
 		// assume an assentry table is on the top of the stack
 		// convert it to a real AssEntry object, and pop the table from the stack
 
+		if (auto proxy = get_line_proxy(L, -1)) {
+			if (!*proxy->valid)
+				error(L, "Subtitle line is no longer valid");
+			return clone_entry(proxy->entry);
+		}
+
 		if (!lua_istable(L, -1))
 			error(L, "Can't convert a non-table value to AssEntry");
 
@@ -336,6 +484,7 @@ namespace Automation4 {
 
 	int LuaAssFile::ObjectIndexRead(lua_State *L)
 	{
+		InitLinesIfNeeded();
 		switch (lua_type(L, 2)) {
 			case LUA_TNUMBER:
 			{
@@ -366,6 +515,8 @@ namespace Automation4 {
 					lua_pushcclosure(L, closure_wrapper_v<&LuaAssFile::ObjectInsert, false>, 1);
 				else if (strcmp(idx, "append") == 0)
 					lua_pushcclosure(L, closure_wrapper_v<&LuaAssFile::ObjectAppend, false>, 1);
+				else if (strcmp(idx, "lines") == 0)
+					lua_pushcclosure(L, closure_wrapper<&LuaAssFile::ObjectLines>, 1);
 				else if (strcmp(idx, "script_resolution") == 0)
 					lua_pushcclosure(L, closure_wrapper<&LuaAssFile::LuaGetScriptResolution>, 1);
 				else {
@@ -475,6 +626,7 @@ namespace Automation4 {
 
 	int LuaAssFile::ObjectGetLen(lua_State *L)
 	{
+		InitLinesIfNeeded();
 		lua_pushnumber(L, lines.size());
 		return 1;
 	}
@@ -618,6 +770,7 @@ namespace Automation4 {
 
 	int LuaAssFile::IterNext(lua_State *L)
 	{
+		InitLinesIfNeeded();
 		size_t i = check_uint(L, 2);
 		if (i >= lines.size()) {
 			lua_pushnil(L);
@@ -629,6 +782,37 @@ namespace Automation4 {
 		return 2;
 	}
 
+	int LuaAssFile::ObjectLines(lua_State *L)
+	{
+		InitLinesIfNeeded();
+		size_t first = lua_isnoneornil(L, 1) ? 1 : std::max<size_t>(check_uint(L, 1), 1);
+		size_t last = lua_isnoneornil(L, 2) ? lines.size() : check_uint(L, 2);
+
+		lua_pushvalue(L, lua_upvalueindex(1)); // push 'this' as userdata
+		push_value(L, first);
+		push_value(L, last);
+		lua_pushcclosure(L, closure_wrapper<&LuaAssFile::LinesNext>, 3);
+		return 1;
+	}
+
+	int LuaAssFile::LinesNext(lua_State *L)
+	{
+		InitLinesIfNeeded();
+		size_t i = lua_tointeger(L, lua_upvalueindex(2));
+		size_t last = std::min<size_t>(lua_tointeger(L, lua_upvalueindex(3)), lines.size());
+		if (i > last) {
+			lua_pushnil(L);
+			return 1;
+		}
+
+		push_value(L, i + 1);
+		lua_replace(L, lua_upvalueindex(2));
+
+		push_value(L, i);
+		AssEntryToLuaProxy(L, i - 1);
+		return 2;
+	}
+
 	int LuaAssFile::LuaParseKaraokeData(lua_State *L)
 	{
 		auto e = LuaToAssEntry(L, ass);
@@ -701,6 +885,8 @@ namespace Automation4 {
 
 	std::vector<AssEntry *> LuaAssFile::ProcessingComplete(wxString const& undo_description)
 	{
+		*lines_valid = false;
+
 		auto apply_lines = [&](std::vector<AssEntry *> const& lines) {
 			if (script_info_copied)
 				ass->Info.clear();
@@ -739,6 +925,7 @@ namespace Automation4 {
 
 	void LuaAssFile::Cancel()
 	{
+		*lines_valid = false;
 		for (auto& line : lines_to_delete) line.release();
 		for (AssEntry *line : allocated_lines) delete line;
 		references--;
@@ -751,12 +938,20 @@ namespace Automation4 {
 	, can_modify(can_modify)
 	, can_set_undo(can_set_undo)
 	{
-		for (auto& line : ass->Info)
-			lines.push_back(nullptr);
-		for (auto& line : ass->Styles)
-			lines.push_back(&line);
-		for (auto& line : ass->Events)
-			lines.push_back(&line);
+		// Read-only features such as macro validation functions frequently
+		// never look at the lines at all, so only build the line list for
+		// them if it's actually used
+		if (can_modify)
+			InitLinesIfNeeded();
+
+		// register the metatable for line proxies if this is the first
+		// file object created in this state
+		if (luaL_newmetatable(L, line_proxy_mt)) {
+			set_field<line_proxy_index>(L, "__index");
+			set_field<line_proxy_newindex>(L, "__newindex");
+			set_field<line_proxy_gc>(L, "__gc");
+		}
+		lua_pop(L, 1);
 
 		// prepare userdata object
 		*static_cast<LuaAssFile**>(lua_newuserdata(L, sizeof(LuaAssFile*))) = this;
@@ -130,12 +130,18 @@ BEGIN_EVENT_TABLE(BaseGrid,wxWindow)
 	EVT_MENU_RANGE(MENU_SHOW_COL,MENU_SHOW_COL+15,BaseGrid::OnShowColMenu)
 END_EVENT_TABLE()
 
-void BaseGrid::OnSubtitlesCommit(int type) {
-	if (type == AssFile::COMMIT_NEW || type & AssFile::COMMIT_ORDER || type & AssFile::COMMIT_DIAG_ADDREM || type & AssFile::COMMIT_FOLD)
-		UpdateMaps();
+void BaseGrid::OnSubtitlesCommit(int type, const AssDialogue *single_line) {
+	bool update_maps = type == AssFile::COMMIT_NEW || type & AssFile::COMMIT_ORDER || type & AssFile::COMMIT_DIAG_ADDREM || type & AssFile::COMMIT_FOLD;
+	if (update_maps)
+		UpdateMaps(type);
 
 	if (type & AssFile::COMMIT_DIAG_META) {
-		SetColumnWidths();
+		// Remeasuring every line isn't needed when only one line changed and
+		// the maps (and column widths) weren't already rebuilt
+		if (single_line && !update_maps)
+			UpdateColumnWidths(single_line);
+		else
+			SetColumnWidths();
 		Refresh(false);
 		return;
 	}
@@ -162,10 +168,12 @@ void BaseGrid::OnShowColMenu(wxCommandEvent &event) {
 }
 
 void BaseGrid::OnHighlightVisibleChange(agi::OptionValue const& opt) {
-	if (opt.GetBool())
+	highlight_visible = opt.GetBool();
+	if (highlight_visible)
 		seek_listener.Unblock();
 	else
 		seek_listener.Block();
+	Refresh(false);
 }
 
 void BaseGrid::UpdateStyle() {
@@ -192,6 +200,12 @@ void BaseGrid::UpdateStyle() {
 	row_colors.FoldClosed.SetColour(to_wx(OPT_GET("Colour/Subtitle Grid/Background/Closed Fold")->GetColor()));
 	row_colors.LeftCol.SetColour(to_wx(OPT_GET("Colour/Subtitle Grid/Left Column")->GetColor()));
 
+	text_colors.Standard = to_wx(OPT_GET("Colour/Subtitle Grid/Standard")->GetColor());
+	text_colors.Selection = to_wx(OPT_GET("Colour/Subtitle Grid/Selection")->GetColor());
+	text_colors.Collision = to_wx(OPT_GET("Colour/Subtitle Grid/Collision")->GetColor());
+	text_colors.Lines = wxPen(to_wx(OPT_GET("Colour/Subtitle Grid/Lines")->GetColor()));
+	text_colors.ActiveBorder = wxPen(to_wx(OPT_GET("Colour/Subtitle Grid/Active Border")->GetColor()));
+
 	if (width_helper)
 		width_helper->ClearCache();
 
@@ -201,17 +215,55 @@ void BaseGrid::UpdateStyle() {
 	Refresh(false);
 }
 
-void BaseGrid::UpdateMaps() {
-	index_line_map.clear();
-	vis_index_line_map.clear();
+void BaseGrid::UpdateMaps(int type) {
+	auto& events = context->ass->Events;
+	size_t old_rows = index_line_map.size();
+	bool full_update = type == AssFile::COMMIT_NEW || events.empty();
+
+	// Fold changes leave the set and order of lines alone
+	std::vector<const AssDialogue *> new_lines;
+	bool removed = false;
+	if (full_update || type & (AssFile::COMMIT_ORDER | AssFile::COMMIT_DIAG_ADDREM)) {
+		// AssFile::Commit has already renumbered the lines, so the last
+		// line's Row gives the row count without a separate walk
+		index_line_map.resize(events.empty() ? 0 : events.back().Row + 1);
+
+		int max_id = max_line_id;
+		size_t kept = 0;
+		for (auto& line : events) {
+			index_line_map[line.Row] = &line;
+			if (line.Id > max_line_id) {
+				new_lines.push_back(&line);
+				max_id = std::max(max_id, line.Id);
+			}
+			else
+				++kept;
+		}
+		max_line_id = max_id;
+
+		// Every line which was in the grid before has an Id no greater than
+		// the old max_line_id, so any missing from the file were deleted,
+		// regardless of how many lines replaced them
+		removed = kept != old_rows;
+	}
 
-	for (auto& curdiag : context->ass->Events)
-		index_line_map.push_back(&curdiag);
+	// Without any folds every line is visible
+	if (context->foldController->GetMaxDepth() == 0)
+		vis_index_line_map = index_line_map;
+	else {
+		vis_index_line_map.clear();
+		for (AssDialogue *curdiag = &*events.begin(); curdiag != nullptr; curdiag = curdiag->Fold.getNextVisible())
+			vis_index_line_map.push_back(curdiag);
+	}
 
-	for (AssDialogue *curdiag = &*context->ass->Events.begin(); curdiag != nullptr; curdiag = curdiag->Fold.getNextVisible())
-		vis_index_line_map.push_back(&*curdiag);
+	// If lines were only added or moved the columns can only grow, so only
+	// the new lines need to be measured. Removing lines may make a column
+	// narrower, which requires checking every line.
+	if (full_update || removed)
+		SetColumnWidths();
+	else
+		UpdateColumnWidths(new_lines);
 
-	SetColumnWidths();
 	AdjustScrollbar();
 	Refresh(false);
 }
@@ -316,12 +368,12 @@ void BaseGrid::OnPaint(wxPaintEvent &) {
 	dc.DrawRectangle(0, lineHeight, columns[0]->Width(), h-lineHeight);
 
 	// Row colors
-	wxColour text_standard(to_wx(OPT_GET("Colour/Subtitle Grid/Standard")->GetColor()));
-	wxColour text_selection(to_wx(OPT_GET("Colour/Subtitle Grid/Selection")->GetColor()));
-	wxColour text_collision(to_wx(OPT_GET("Colour/Subtitle Grid/Collision")->GetColor()));
+	wxColour const& text_standard = text_colors.Standard;
+	wxColour const& text_selection = text_colors.Selection;
+	wxColour const& text_collision = text_colors.Collision;
 
 	// First grid row
-	wxPen grid_pen(to_wx(OPT_GET("Colour/Subtitle Grid/Lines")->GetColor()));
+	wxPen const& grid_pen = text_colors.Lines;
 	dc.SetPen(grid_pen);
 	dc.DrawLine(0, 0, w, 0);
 	dc.SetPen(*wxTRANSPARENT_PEN);
@@ -374,7 +426,7 @@ void BaseGrid::OnPaint(wxPaintEvent &) {
 		else if (curDiag->Comment)
 			color = row_colors.Comment;
 
-		if (OPT_GET("Subtitle/Grid/Highlight Subtitles in Frame")->GetBool() && IsDisplayed(curDiag)) {
+		if (highlight_visible && IsDisplayed(curDiag)) {
 			if (color == row_colors.Default)
 				color = row_colors.Visible;
 			visible_rows.push_back(i + yPos);
@@ -429,7 +481,7 @@ void BaseGrid::OnPaint(wxPaintEvent &) {
 	}
 
 	if (active_line && active_line->Fold.getVisibleRow() >= yPos && active_line->Fold.getVisibleRow() < yPos + nDraw) {
-		dc.SetPen(wxPen(to_wx(OPT_GET("Colour/Subtitle Grid/Active Border")->GetColor())));
+		dc.SetPen(text_colors.ActiveBorder);
 		dc.SetBrush(*wxTRANSPARENT_BRUSH);
 		dc.DrawRectangle(0, (active_line->Fold.getVisibleRow() - yPos + 1) * lineHeight, w, lineHeight + 1);
 	}
@@ -629,27 +681,73 @@ void BaseGrid::AdjustScrollbar() {
 }
 
 void BaseGrid::SetColumnWidths() {
-	int w, h;
-	GetClientSize(&w, &h);
-
 	// DC for text extents test
 	wxClientDC dc(this);
 	dc.SetFont(font);
 
-	text_refresh_rects.clear();
-	int x = 0;
-
 	if (!width_helper)
 		width_helper = agi::make_unique<WidthHelper>();
 	width_helper->SetDC(&dc);
 
-	for (auto const& column : columns) {
+	for (auto const& column : columns)
 		column->UpdateWidth(context, *width_helper);
+	width_helper->Age();
+
+	UpdateTextRefreshRects();
+}
+
+void BaseGrid::UpdateColumnWidths(const AssDialogue *line) {
+	if (!width_helper) {
+		SetColumnWidths();
+		return;
+	}
+
+	wxClientDC dc(this);
+	dc.SetFont(font);
+	width_helper->SetDC(&dc);
+
+	bool changed = false;
+	for (auto const& column : columns) {
+		int old_width = column->Width();
+		column->UpdateWidthForLine(line, context, *width_helper);
+		changed = changed || column->Width() != old_width;
+	}
+
+	if (changed)
+		UpdateTextRefreshRects();
+}
+
+void BaseGrid::UpdateColumnWidths(std::vector<const AssDialogue *> const& new_lines) {
+	if (!width_helper) {
+		SetColumnWidths();
+		return;
+	}
+
+	wxClientDC dc(this);
+	dc.SetFont(font);
+	width_helper->SetDC(&dc);
+
+	bool changed = false;
+	for (auto const& column : columns) {
+		int old_width = column->Width();
+		column->UpdateWidthForNewLines(new_lines, context, *width_helper);
+		changed = changed || column->Width() != old_width;
+	}
+
+	if (changed)
+		UpdateTextRefreshRects();
+}
+
+void BaseGrid::UpdateTextRefreshRects() {
+	int w, h;
+	GetClientSize(&w, &h);
+	text_refresh_rects.clear();
+	int x = 0;
+	for (auto const& column : columns) {
 		if (column->Width() && column->RefreshOnTextChange())
 			text_refresh_rects.emplace_back(x, 0, column->Width(), h);
 		x += column->Width();
 	}
-	width_helper->Age();
 }
 
 AssDialogue *BaseGrid::GetDialogue(int n) const {
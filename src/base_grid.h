@@ -85,8 +85,23 @@ class BaseGrid final : public wxWindow {
 		wxBrush FoldClosed;
 	} row_colors;
 
+	/// Cached text and line colours
+	struct {
+		wxColour Standard;
+		wxColour Selection;
+		wxColour Collision;
+		wxPen Lines;
+		wxPen ActiveBorder;
+	} text_colors;
+
+	/// Should lines visible on the current video frame be highlighted?
+	bool highlight_visible = false;
+
 	std::vector<AssDialogue*> index_line_map;  ///< Row number -> dialogue line
 	std::vector<AssDialogue*> vis_index_line_map;  ///< Visible Row number -> dialogue line
+	/// Highest AssDialogue::Id in index_line_map, used to spot newly inserted
+	/// lines without comparing against the previous map
+	int max_line_id = 0;
 
 	/// Connection for video seek event. Stored explicitly so that it can be
 	/// blocked if the relevant option is disabled
@@ -104,16 +119,23 @@ class BaseGrid final : public wxWindow {
 	void OnScroll(wxScrollEvent &event);
 	void OnShowColMenu(wxCommandEvent &event);
 	void OnSize(wxSizeEvent &event);
-	void OnSubtitlesCommit(int type);
+	void OnSubtitlesCommit(int type, const AssDialogue *single_line);
 	void OnActiveLineChanged(AssDialogue *);
 	void OnSeek();
 
 	void AdjustScrollbar();
 	void SetColumnWidths();
+	/// Grow the columns if needed to fit a line which has changed
+	void UpdateColumnWidths(const AssDialogue *line);
+	/// Grow the columns to fit newly inserted lines
+	void UpdateColumnWidths(std::vector<const AssDialogue *> const& new_lines);
+	/// Recalculate the regions to redraw when only line text has changed
+	void UpdateTextRefreshRects();
 
 	bool IsDisplayed(const AssDialogue *line) const;
 
-	void UpdateMaps();
+	/// Update the row maps and column widths for a commit of the given type
+	void UpdateMaps(int type);
 	void UpdateStyle();
 
 	void SelectRow(int row, bool addToSelected = false, bool select=true);
@@ -31,16 +31,23 @@
 
 #include "command.h"
 
+#include "../ass_file.h"
 #include "../compat.h"
+#include "../dialog_progress.h"
 #include "../include/aegisub/context.h"
+#include "../include/aegisub/video_provider.h"
+#include "../keyframe_detector.h"
 #include "../libresrc/libresrc.h"
 #include "../options.h"
 #include "../project.h"
 #include "../utils.h"
+#include "../video_provider_manager.h"
 
 #include <libaegisub/keyframe.h>
 #include <libaegisub/make_unique.h>
 
+#include <wx/msgdlg.h>
+
 namespace {
 	using cmd::Command;
 
@@ -61,6 +68,45 @@ struct keyframe_close final : public Command {
 	}
 };
 
+struct keyframe_detect final : public Command {
+	CMD_NAME("keyframe/detect")
+	STR_MENU("Detect Keyframes...")
+	STR_DISP("Detect Keyframes")
+	STR_HELP("Find the scene changes in the video and save them as a keyframe file")
+	CMD_TYPE(COMMAND_VALIDATE)
+
+	bool Validate(const agi::Context *c) override {
+		return !!c->project->VideoProvider();
+	}
+
+	void operator()(agi::Context *c) override {
+		auto filename = SaveFileSelector(_("Save keyframes file"), "Path/Last/Keyframes", "", "*.key.txt", "Text files (*.txt)|*.txt", c->parent);
+		if (filename.empty()) return;
+
+		DialogProgress progress(c->parent, _("Detecting keyframes"), _("Looking for scene changes in the video"));
+		std::vector<int> keyframes;
+		try {
+			// The loaded provider is in use by the video display on its own
+			// thread, so decode with a second one
+			auto provider = VideoProviderFactory::GetProvider(c->project->VideoName(), c->ass->GetScriptInfo("YCbCr Matrix"), &progress);
+			progress.Run([&](agi::ProgressSink *ps) {
+				keyframes = DetectKeyframes(*provider, ps);
+			});
+		}
+		catch (agi::UserCancelException const&) { return; }
+		catch (agi::Exception const& err) {
+			wxMessageBox(to_wx(err.GetMessage()), "Error", wxOK | wxICON_ERROR | wxCENTER, c->parent);
+			return;
+		}
+
+		// Errors while decoding are reported in the progress dialog
+		if (keyframes.empty()) return;
+
+		agi::keyframe::Save(filename, keyframes);
+		c->project->LoadKeyframes(filename);
+	}
+};
+
 struct keyframe_open final : public Command {
 	CMD_NAME("keyframe/open")
 	CMD_ICON(open_keyframes_menu)
@@ -107,6 +153,7 @@ struct keyframe_save final : public Command {
 namespace cmd {
 	void init_keyframe() {
 		reg(agi::make_unique<keyframe_close>());
+		reg(agi::make_unique<keyframe_detect>());
 		reg(agi::make_unique<keyframe_open>());
 		reg(agi::make_unique<keyframe_save>());
 	}
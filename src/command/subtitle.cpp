@@ -36,6 +36,7 @@
 #include "../compat.h"
 #include "../dialog_search_replace.h"
 #include "../dialogs.h"
+#include "../dialogue_time_index.h"
 #include "../frame_main.h"
 #include "../include/aegisub/context.h"
 #include "../libresrc/libresrc.h"
@@ -53,6 +54,7 @@
 #include <libaegisub/charset_conv.h>
 #include <libaegisub/make_unique.h>
 
+#include <algorithm>
 #include <boost/range/algorithm/copy.hpp>
 #include <wx/msgdlg.h>
 #include <wx/choicdlg.h>
@@ -418,13 +420,21 @@ struct subtitle_select_visible final : public Command {
 		Selection new_selection;
 		int frame = c->videoController->GetFrameN();
 
-		for (auto& diag : c->ass->Events) {
-			if (c->videoController->FrameAtTime(diag.Start, agi::vfr::START) <= frame &&
-				c->videoController->FrameAtTime(diag.End, agi::vfr::END) >= frame)
+		// Only lines near the frame's time can be visible on it
+		auto lines = c->timeIndex->LinesOverlapping(
+			c->videoController->TimeAtFrame(frame - 1),
+			c->videoController->TimeAtFrame(frame + 1) + 1);
+		std::sort(begin(lines), end(lines), [](const AssDialogue *a, const AssDialogue *b) {
+			return a->Row < b->Row;
+		});
+
+		for (auto diag : lines) {
+			if (c->videoController->FrameAtTime(diag->Start, agi::vfr::START) <= frame &&
+				c->videoController->FrameAtTime(diag->End, agi::vfr::END) >= frame)
 			{
 				if (new_selection.empty())
-					c->selectionController->SetActiveLine(&diag);
-				new_selection.insert(&diag);
+					c->selectionController->SetActiveLine(diag);
+				new_selection.insert(diag);
 			}
 		}
 
@@ -448,6 +458,19 @@ struct subtitle_spellcheck final : public Command {
 		ShowSpellcheckerDialog(c);
 	}
 };
+
+struct subtitle_spellcheck_report final : public Command {
+	CMD_NAME("subtitle/spellcheck/report")
+	CMD_ICON(spellcheck_toolbutton)
+	STR_MENU("Spell Check &Report...")
+	STR_DISP("Spell Check Report")
+	STR_HELP("List every misspelled word in the script and fix each one everywhere at once")
+
+	void operator()(agi::Context *c) override {
+		c->videoController->Stop();
+		ShowSpellCheckReportDialog(c);
+	}
+};
 }
 
 namespace cmd {
@@ -471,5 +494,6 @@ namespace cmd {
 		reg(agi::make_unique<subtitle_select_all>());
 		reg(agi::make_unique<subtitle_select_visible>());
 		reg(agi::make_unique<subtitle_spellcheck>());
+		reg(agi::make_unique<subtitle_spellcheck_report>());
 	}
 }
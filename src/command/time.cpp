@@ -197,34 +197,24 @@ struct time_snap_scene final : public validate_video_loaded {
 	STR_HELP("Set start and end of subtitles to the keyframes around current video frame")
 
 	void operator()(agi::Context *c) override {
-		auto const& keyframes = c->project->Keyframes();
-		if (keyframes.empty()) return;
+		auto const& keyframes = c->project->IndexedKeyframes();
+		if (!keyframes.HasTimes()) return;
 
 		VideoController *con = c->videoController.get();
 		int curFrame = con->GetFrameN();
-		int prev = 0;
-		int next = 0;
-
-		if (curFrame < keyframes.front())
-			next = keyframes.front();
-		else if (curFrame >= keyframes.back()) {
-			prev = keyframes.back();
-			next = c->project->VideoProvider()->GetFrameCount();
-		}
-		else {
-			auto kf = std::lower_bound(keyframes.begin(), keyframes.end(), curFrame);
-			if (*kf == curFrame) {
-				prev = *kf;
-				next = *(kf + 1);
-			}
-			else {
-				prev = *(kf - 1);
-				next = *kf;
-			}
-		}
 
-		int start_ms = con->TimeAtFrame(prev,agi::vfr::START);
-		int end_ms = con->TimeAtFrame(next-1,agi::vfr::END);
+		// The scene runs from the start of the video or the last keyframe at
+		// or before the current frame to the end of the video or the frame
+		// before the next keyframe
+		size_t prev = keyframes.LastAtOrBefore(curFrame);
+		size_t next = keyframes.FirstAtOrAfter(curFrame + 1);
+
+		int start_ms = prev == keyframes.size()
+			? con->TimeAtFrame(0, agi::vfr::START)
+			: keyframes.StartTime(prev);
+		int end_ms = next == keyframes.size()
+			? con->TimeAtFrame(c->project->VideoProvider()->GetFrameCount() - 1, agi::vfr::END)
+			: keyframes.EndTime(next);
 
 		for (auto line : c->selectionController->GetSelectedSet()) {
 			line->Start = start_ms;
@@ -89,6 +89,18 @@ struct tool_font_collector final : public Command {
 	}
 };
 
+struct tool_font_collector_batch final : public Command {
+	CMD_NAME("tool/font_collector/batch")
+	CMD_ICON(font_collector_button)
+	STR_MENU("Fonts Collector (&Multiple Files)...")
+	STR_DISP("Fonts Collector (Multiple Files)")
+	STR_HELP("Collect the fonts used by several subtitle files at once")
+
+	void operator()(agi::Context *c) override {
+		ShowBatchFontsCollectorDialog(c);
+	}
+};
+
 struct tool_line_select final : public Command {
 	CMD_NAME("tool/line/select")
 	CMD_ICON(select_lines_button)
@@ -280,6 +292,7 @@ namespace cmd {
 	void init_tool() {
 		reg(agi::make_unique<tool_export>());
 		reg(agi::make_unique<tool_font_collector>());
+		reg(agi::make_unique<tool_font_collector_batch>());
 		reg(agi::make_unique<tool_line_select>());
 		reg(agi::make_unique<tool_resampleres>());
 		reg(agi::make_unique<tool_style_assistant>());
@@ -19,6 +19,7 @@
 #include "ass_file.h"
 #include "audio_controller.h"
 #include "auto4_base.h"
+#include "dialogue_time_index.h"
 #include "dialog_manager.h"
 #include "fold_controller.h"
 #include "initial_line_state.h"
@@ -42,6 +43,7 @@ Context::Context()
 , local_scripts(make_unique<Automation4::LocalScriptManager>(this))
 , selectionController(make_unique<SelectionController>(this))
 , foldController(make_unique<FoldController>(this))
+, timeIndex(make_unique<DialogueTimeIndex>(this))
 , videoController(make_unique<VideoController>(this))
 , audioController(make_unique<AudioController>(this))
 , initialLineState(make_unique<InitialLineState>(this))
@@ -16,6 +16,8 @@
 
 #include "font_file_lister.h"
 
+#include "ass_file.h"
+#include "charset_detect.h"
 #include "compat.h"
 #include "dialog_manager.h"
 #include "format.h"
@@ -23,14 +25,25 @@
 #include "include/aegisub/context.h"
 #include "libresrc/libresrc.h"
 #include "options.h"
+#include "project.h"
+#include "subtitle_format.h"
+#include "subtitle_format_ass.h"
 #include "utils.h"
 #include "value_event.h"
 
+#include <libaegisub/charset.h>
 #include <libaegisub/dispatch.h>
 #include <libaegisub/format_path.h>
 #include <libaegisub/fs.h>
+#include <libaegisub/io.h>
 #include <libaegisub/path.h>
 #include <libaegisub/make_unique.h>
+#include <libaegisub/vfr.h>
+
+#include <future>
+#include <map>
+#include <set>
+#include <unordered_map>
 
 #include <wx/button.h>
 #include <wx/dialog.h>
@@ -56,11 +69,15 @@ enum class FcMode {
 	SymlinkToFolder = 4
 };
 
-class DialogFontsCollector final : public wxDialog {
+class DialogFontsCollector : public wxDialog {
+	agi::Context *c;
 	AssFile *subs;
 	agi::Path &path;
 	FcMode mode = FcMode::CheckFontsOnly;
 
+	/// Scripts to collect the fonts of instead of the open file
+	std::vector<agi::fs::path> scripts;
+
 	wxStyledTextCtrl *collection_log;
 	wxButton *close_btn;
 	wxButton *dest_browse_button;
@@ -80,21 +97,171 @@ class DialogFontsCollector final : public wxDialog {
 
 	void UpdateControls();
 
+	/// Is copying the fonts to the subtitle file's folder possible?
+	bool CanCopyToScriptFolder() const;
+
 public:
-	DialogFontsCollector(agi::Context *c);
+	DialogFontsCollector(agi::Context *c, std::vector<agi::fs::path> scripts = {});
+};
+
+/// Fonts collector for several subtitle files which are not open, which
+/// resolves each font once and writes all of the fonts to one destination
+class DialogBatchFontsCollector final : public DialogFontsCollector {
+	static std::vector<agi::fs::path> SelectScripts(agi::Context *c);
+
+public:
+	DialogBatchFontsCollector(agi::Context *c)
+	: DialogFontsCollector(c, SelectScripts(c))
+	{
+	}
 };
 
 using color_str_pair = std::pair<int, wxString>;
 wxDEFINE_EVENT(EVT_ADD_TEXT, ValueEvent<color_str_pair>);
 wxDEFINE_EVENT(EVT_COLLECTION_DONE, wxThreadEvent);
 
-void FontsCollectorThread(AssFile *subs, agi::fs::path const& destination, FcMode oper, wxEvtHandler *collector) {
+/// Read a font file into memory so that it can be read while the previous
+/// font is being compressed
+/// @return The file's contents, or nullptr if it could not be read
+std::unique_ptr<std::string> read_font(agi::fs::path const& path) {
+	try {
+		auto size = agi::fs::Size(path);
+		auto in = agi::io::Open(path, true);
+		auto data = agi::make_unique<std::string>(size, '\0');
+		in->read(&(*data)[0], size);
+		if (static_cast<uintmax_t>(in->gcount()) == size)
+			return data;
+	}
+	catch (agi::Exception const&) { }
+	return nullptr;
+}
+
+/// Remove fonts which have the same contents as an earlier font in the list,
+/// such as the same font installed in more than one place
+template<typename AppendText>
+void remove_duplicate_fonts(std::vector<agi::fs::path> &paths, AppendText append_text) {
+	// Only fonts with the same size can be identical, so group them by size
+	// first to avoid reading most of the files
+	std::map<uintmax_t, std::vector<size_t>> by_size;
+	for (size_t i = 0; i < paths.size(); ++i) {
+		try {
+			by_size[agi::fs::Size(paths[i])].push_back(i);
+		}
+		catch (agi::fs::FileSystemError const&) {
+			// Report the error when copying
+		}
+	}
+
+	std::vector<bool> duplicate(paths.size());
+	for (auto const& group : by_size) {
+		if (group.second.size() < 2) continue;
+
+		std::unordered_multimap<size_t, std::pair<size_t, std::unique_ptr<std::string>>> seen;
+		for (size_t i : group.second) {
+			auto data = read_font(paths[i]);
+			if (!data) continue;
+
+			auto hash = std::hash<std::string>()(*data);
+			auto range = seen.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it) {
+				if (*it->second.second == *data) {
+					append_text(fmt_tl("* %s is identical to %s, skipping.\n", paths[i], paths[it->second.first]), 3);
+					duplicate[i] = true;
+					break;
+				}
+			}
+			if (!duplicate[i])
+				seen.emplace(hash, std::make_pair(i, std::move(data)));
+		}
+	}
+
+	size_t kept = 0;
+	for (size_t i = 0; i < paths.size(); ++i) {
+		if (duplicate[i]) continue;
+		if (kept != i)
+			paths[kept] = std::move(paths[i]);
+		++kept;
+	}
+	paths.resize(kept);
+}
+
+/// Load a subtitle file to collect the fonts of on the collector's thread
+std::unique_ptr<AssFile> load_script(agi::fs::path const& script, agi::vfr::Framerate const& fps) {
+	// Asking the user for anything has to be done on the main thread
+	auto encoding = agi::charset::Detect(script);
+	if (encoding.empty())
+		agi::dispatch::Main().Sync([&] { encoding = CharSetDetect::GetEncoding(script); });
+
+	auto reader = SubtitleFormat::GetReader(script, encoding);
+	auto file = agi::make_unique<AssFile>();
+	// Readers for other formats may ask for a frame rate or import options
+	if (dynamic_cast<const AssSubtitleFormat *>(reader))
+		reader->ReadFile(file.get(), script, fps, encoding);
+	else
+		agi::dispatch::Main().Sync([&] { reader->ReadFile(file.get(), script, fps, encoding); });
+	return file;
+}
+
+/// Get a name for a zip entry which hasn't been used yet, so that different
+/// fonts with the same file name don't overwrite each other
+agi::fs::path unique_entry_name(agi::fs::path const& filename, std::set<agi::fs::path> &names) {
+	auto name = filename;
+	for (int i = 2; !names.insert(name).second; ++i)
+		name = agi::format("%s (%d)%s", filename.stem(), i, filename.extension());
+	return name;
+}
+
+/// Copy or symlink a font file to a folder
+/// @return 1 if copied, 2 if the destination already exists, 3 if symlinked, 0 on failure
+int copy_font(agi::fs::path const& path, agi::fs::path const& destination, FcMode oper) {
+	auto dest = destination/path.filename();
+	if (agi::fs::FileExists(dest))
+		return 2;
+#ifndef _WIN32
+	if (oper == FcMode::SymlinkToFolder) {
+		// returns 0 on success, -1 on error...
+		if (symlink(path.c_str(), dest.c_str()))
+			return 0;
+		return 3;
+	}
+#endif
+	try {
+		agi::fs::Copy(path, dest);
+		return 1;
+	}
+	catch (...) {
+		return 0;
+	}
+}
+
+/// @param subs The open file, which is used if there are no scripts
+/// @param scripts Files to load and collect the fonts of
+/// @param fps Frame rate for loading frame-based subtitle formats
+void FontsCollectorThread(const AssFile *subs, std::vector<agi::fs::path> const& scripts, agi::vfr::Framerate const& fps, agi::fs::path const& destination, FcMode oper, wxEvtHandler *collector) {
 	agi::dispatch::Background().Async([=]{
 		auto AppendText = [&](wxString text, int colour) {
 			collector->AddPendingEvent(ValueEvent<color_str_pair>(EVT_ADD_TEXT, -1, {colour, text.Clone()}));
 		};
 
-		auto paths = FontCollector(AppendText).GetFontPaths(subs);
+		std::vector<std::pair<std::string, const AssFile *>> files;
+		std::vector<std::unique_ptr<AssFile>> loaded;
+		if (scripts.empty())
+			files.emplace_back("", subs);
+		for (auto const& script : scripts) {
+			try {
+				loaded.push_back(load_script(script, fps));
+				files.emplace_back(script.filename().string(), loaded.back().get());
+			}
+			catch (agi::UserCancelException const&) {
+				collector->AddPendingEvent(wxThreadEvent(EVT_COLLECTION_DONE));
+				return;
+			}
+			catch (agi::Exception const& e) {
+				AppendText(fmt_tl("* Failed to load %s: %s\n", script, to_wx(e.GetMessage())), 2);
+			}
+		}
+
+		auto paths = FontCollector(AppendText).GetFontPaths(files);
 		if (paths.empty()) {
 			collector->AddPendingEvent(wxThreadEvent(EVT_COLLECTION_DONE));
 			return;
@@ -142,54 +309,13 @@ void FontsCollectorThread(AssFile *subs, agi::fs::path const& destination, FcMod
 			}
 		}
 
-		int64_t total_size = 0;
-		bool allOk = true;
-		for (auto path : paths) {
+		for (auto& path : paths)
 			path.make_preferred();
+		remove_duplicate_fonts(paths, AppendText);
 
-			int ret = 0;
-			total_size += agi::fs::Size(path);
-
-			switch (oper) {
-				case FcMode::SymlinkToFolder:
-				case FcMode::CopyToScriptFolder:
-				case FcMode::CopyToFolder: {
-					auto dest = destination/path.filename();
-					if (agi::fs::FileExists(dest))
-						ret = 2;
-#ifndef _WIN32
-					else if (oper == FcMode::SymlinkToFolder) {
-						// returns 0 on success, -1 on error...
-						if (symlink(path.c_str(), dest.c_str()))
-							ret = 0;
-						else
-							ret = 3;
-					}
-#endif
-					else {
-						try {
-							agi::fs::Copy(path, dest);
-							ret = true;
-						}
-						catch (...) {
-							ret = false;
-						}
-					}
-				}
-				break;
-
-				case FcMode::CopyToZip: {
-					wxFFileInputStream in(path.wstring());
-					if (!in.IsOk())
-						ret = false;
-					else {
-						ret = zip->PutNextEntry(path.filename().wstring());
-						zip->Write(in);
-					}
-				}
-				default: break;
-			}
-
+		int64_t total_size = 0;
+		bool allOk = true;
+		auto report = [&](agi::fs::path const& path, int ret) {
 			if (ret == 1)
 				AppendText(fmt_tl("* Copied %s.\n", path), 1);
 			else if (ret == 2)
@@ -200,6 +326,47 @@ void FontsCollectorThread(AssFile *subs, agi::fs::path const& destination, FcMod
 				AppendText(fmt_tl("* Failed to copy %s.\n", path), 2);
 				allOk = false;
 			}
+		};
+
+		if (oper == FcMode::CopyToZip) {
+			// Read the next font while the current one is being compressed
+			std::future<std::unique_ptr<std::string>> next;
+			auto prefetch = [&](size_t i) {
+				if (i < paths.size())
+					next = std::async(std::launch::async, read_font, paths[i]);
+			};
+
+			std::set<agi::fs::path> names;
+			prefetch(0);
+			for (size_t i = 0; i < paths.size(); ++i) {
+				auto data = next.get();
+				prefetch(i + 1);
+
+				int ret = 0;
+				if (data) {
+					auto name = unique_entry_name(paths[i].filename(), names);
+					if (name != paths[i].filename())
+						AppendText(fmt_tl("* Another font is already named %s, so %s will be named %s.\n", paths[i].filename(), paths[i], name), 3);
+					total_size += data->size();
+					ret = zip->PutNextEntry(name.wstring());
+					zip->Write(data->data(), data->size());
+				}
+				report(paths[i], ret);
+			}
+		}
+		else {
+			// Copying is limited by the disk rather than the CPU, but having
+			// several copies in flight lets the OS schedule the IO better
+			std::vector<int> results(paths.size());
+			agi::dispatch::ParallelFor(paths.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i)
+					results[i] = copy_font(paths[i], destination, oper);
+			});
+
+			for (size_t i = 0; i < paths.size(); ++i) {
+				total_size += agi::fs::Size(paths[i]);
+				report(paths[i], results[i]);
+			}
 		}
 
 		if (allOk)
@@ -216,10 +383,12 @@ void FontsCollectorThread(AssFile *subs, agi::fs::path const& destination, FcMod
 	});
 }
 
-DialogFontsCollector::DialogFontsCollector(agi::Context *c)
-: wxDialog(c->parent, -1, _("Fonts Collector"))
+DialogFontsCollector::DialogFontsCollector(agi::Context *c, std::vector<agi::fs::path> scripts)
+: wxDialog(c->parent, -1, scripts.empty() ? _("Fonts Collector") : _("Fonts Collector (Multiple Files)"))
+, c(c)
 , subs(c->ass.get())
 , path(*c->path)
+, scripts(std::move(scripts))
 {
 	SetIcon(GETICON(font_collector_button_16));
 
@@ -235,9 +404,11 @@ DialogFontsCollector::DialogFontsCollector(agi::Context *c)
 
 	mode = static_cast<FcMode>(mid<int>(0, OPT_GET("Tool/Fonts Collector/Action")->GetInt(), countof(modes)));
 	collection_mode = new wxRadioBox(this, -1, _("Action"), wxDefaultPosition, wxDefaultSize, countof(modes), modes, 1);
+	if (mode == FcMode::CopyToScriptFolder && !CanCopyToScriptFolder())
+		mode = FcMode::CopyToFolder;
 	collection_mode->SetSelection(static_cast<int>(mode));
 
-	if (c->path->Decode("?script") == "?script")
+	if (!CanCopyToScriptFolder())
 		collection_mode->Enable(2, false);
 
 	wxStaticBoxSizer *destination_box = new wxStaticBoxSizer(wxVERTICAL, this, _("Destination"));
@@ -327,7 +498,7 @@ void DialogFontsCollector::OnStart(wxCommandEvent &) {
 	collection_mode->Enable(false);
 	dest_label->Enable(false);
 
-	FontsCollectorThread(subs, dest_path, mode, GetEventHandler());
+	FontsCollectorThread(subs, scripts, c->project->Timecodes(), dest_path, mode, GetEventHandler());
 }
 
 void DialogFontsCollector::OnBrowse(wxCommandEvent &) {
@@ -416,13 +587,39 @@ void DialogFontsCollector::OnCollectionComplete(wxThreadEvent &) {
 	start_btn->Enable();
 	close_btn->Enable();
 	collection_mode->Enable();
-	if (path.Decode("?script") == "?script")
+	if (!CanCopyToScriptFolder())
 		collection_mode->Enable(2, false);
 
 	UpdateControls();
 }
+
+bool DialogFontsCollector::CanCopyToScriptFolder() const {
+	return scripts.empty() && path.Decode("?script") != "?script";
+}
+
+std::vector<agi::fs::path> DialogBatchFontsCollector::SelectScripts(agi::Context *c) {
+	wxFileDialog diag(c->parent,
+		_("Choose subtitle files to collect the fonts of"),
+		to_wx(OPT_GET("Path/Last/Subtitles")->GetString()), "",
+		to_wx(SubtitleFormat::GetWildcards(0)),
+		wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_MULTIPLE);
+	if (diag.ShowModal() == wxID_CANCEL)
+		throw agi::UserCancelException("Fonts collector cancelled");
+
+	wxArrayString paths;
+	diag.GetPaths(paths);
+
+	std::vector<agi::fs::path> scripts;
+	for (auto const& fn : paths)
+		scripts.emplace_back(fn.wx_str());
+	return scripts;
+}
 }
 
 void ShowFontsCollectorDialog(agi::Context *c) {
 	c->dialog->Show<DialogFontsCollector>(c);
 }
+
+void ShowBatchFontsCollectorDialog(agi::Context *c) {
+	c->dialog->Show<DialogBatchFontsCollector>(c);
+}
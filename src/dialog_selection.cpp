@@ -75,7 +75,7 @@ enum Mode {
 	REGEXP
 };
 
-std::set<AssDialogue*> process(std::string const& match_text, bool match_case, Mode mode, bool invert, bool comments, bool dialogue, int field_n, AssFile *ass) {
+std::set<AssDialogue*> process(std::string const& match_text, bool match_case, Mode mode, bool invert, bool comments, bool dialogue, int field_n, agi::Context *c) {
 	SearchReplaceSettings settings = {
 		match_text,
 		std::string(),
@@ -88,18 +88,15 @@ std::set<AssDialogue*> process(std::string const& match_text, bool match_case, M
 		mode == Mode::EXACT
 	};
 
-	auto predicate = SearchReplaceEngine::GetMatcher(settings);
-
-	std::set<AssDialogue*> matches;
-	for (auto& diag : ass->Events) {
+	std::vector<AssDialogue*> lines;
+	for (auto& diag : c->ass->Events) {
 		if (diag.Comment && !comments) continue;
 		if (!diag.Comment && !dialogue) continue;
-
-		if (invert != predicate(&diag, 0))
-			matches.insert(&diag);
+		lines.push_back(&diag);
 	}
 
-	return matches;
+	auto matches = c->search->FilterMatches(settings, lines, invert);
+	return std::set<AssDialogue*>(begin(matches), end(matches));
 }
 
 DialogSelection::DialogSelection(agi::Context *c) :
@@ -190,7 +187,7 @@ void DialogSelection::Process(wxCommandEvent& event) {
 			from_wx(match_text->GetValue()), case_sensitive->IsChecked(),
 			static_cast<Mode>(match_mode->GetSelection()), select_unmatching_lines->GetValue(),
 			apply_to_comments->IsChecked(), apply_to_dialogue->IsChecked(),
-			dialogue_field->GetSelection(), con->ass.get());
+			dialogue_field->GetSelection(), con);
 	}
 	catch (agi::Exception const&) {
 		if (event.GetId() == wxID_OK) Close();
@@ -25,22 +25,19 @@
 #include "options.h"
 #include "project.h"
 #include "selection_controller.h"
+#include "shift_history.h"
 #include "subs_controller.h"
 #include "timeedit_ctrl.h"
 
 #include <libaegisub/ass/time.h>
-#include <libaegisub/fs.h>
-#include <libaegisub/io.h>
+#include <libaegisub/dispatch.h>
 #include <libaegisub/log.h>
 #include <libaegisub/path.h>
 #include <libaegisub/signal.h>
 #include <libaegisub/vfr.h>
 
-#include <libaegisub/cajun/elements.h>
-#include <libaegisub/cajun/reader.h>
-#include <libaegisub/cajun/writer.h>
-
 #include <boost/filesystem/path.hpp>
+#include <wx/button.h>
 #include <wx/dialog.h>
 #include <wx/listbox.h>
 #include <wx/radiobox.h>
@@ -52,8 +49,7 @@ namespace {
 class DialogShiftTimes final : public wxDialog {
 	agi::Context *context;
 
-	agi::fs::path history_filename;
-	json::Array history;
+	ShiftHistory history;
 	agi::vfr::Framerate fps;
 	agi::signal::Connection timecodes_loaded_slot;
 	agi::signal::Connection selected_set_changed_slot;
@@ -67,16 +63,23 @@ class DialogShiftTimes final : public wxDialog {
 	wxRadioBox *selection_mode;
 	wxRadioBox *time_fields;
 	wxListBox *history_box;
+	wxButton *replay_button;
+	wxButton *revert_button;
 
-	void SaveHistory(json::Array shifted_blocks);
+	/// Get a history entry for the shift set in the dialog
+	ShiftHistoryEntry GetHistoryEntry(std::vector<std::pair<int, int>> shifted_blocks);
 	void LoadHistory();
 	void Process(wxCommandEvent&);
-	int Shift(int initial_time, int shift, bool by_time, agi::vfr::Time type);
+	/// Shift the given lines, commit and close the dialog
+	void Apply(std::vector<AssDialogue *> const& lines, ShiftHistoryEntry const& entry);
+	/// Redo the selected history entry's shift, or undo it if revert is set
+	void ApplyHistory(bool revert);
 
 	void OnClear(wxCommandEvent&);
 	void OnByTime(wxCommandEvent&);
 	void OnByFrames(wxCommandEvent&);
 	void OnHistoryClick(wxCommandEvent&);
+	void OnHistorySelect(wxCommandEvent&);
 
 	void OnSelectedSetChanged();
 	void OnTimecodesLoaded(agi::vfr::Framerate const& new_fps);
@@ -86,39 +89,36 @@ public:
 	~DialogShiftTimes();
 };
 
-static wxString get_history_string(json::Object &obj) {
-	wxString filename = to_wx(obj["filename"]);
+static wxString get_history_string(ShiftHistoryEntry const& entry) {
+	wxString filename = to_wx(entry.filename);
 	if (filename.empty())
 		filename = _("unsaved");
 
-	wxString shift_amount(to_wx(obj["amount"]));
-	if (!obj["is by time"])
-		shift_amount = fmt_tl("%s frames", shift_amount);
+	wxString shift_amount = entry.by_time
+		? to_wx(agi::Time(entry.amount).GetAssFormatted())
+		: fmt_tl("%d frames", entry.amount);
 
-	wxString shift_direction = obj["is backward"] ? _("backward") : _("forward");
+	wxString shift_direction = entry.backward ? _("backward") : _("forward");
 
-	int64_t time_field = obj["fields"];
 	wxString fields =
-		time_field == 0 ? _("s+e") :
-		time_field == 1 ? _("s")   :
-		                  _("e")   ;
+		entry.fields == 0 ? _("s+e") :
+		entry.fields == 1 ? _("s")   :
+		                    _("e")   ;
 
-	json::Array& sel = obj["selection"];
+	auto const& sel = entry.blocks;
 	wxString lines;
 
-	int64_t sel_mode = obj["mode"];
-	if (sel_mode == 0)
+	if (entry.mode == 0)
 		lines = _("all");
-	else if (sel_mode == 2) {
+	else if (entry.mode == 2) {
 		if (!sel.empty())
-			lines = fmt_tl("from %d onward", (int64_t)static_cast<json::Object&>(sel.front())["start"]);
+			lines = fmt_tl("from %d onward", sel.front().first);
 	}
 	else {
 		lines += _("sel ");
 		for (auto it = sel.begin(); it != sel.end(); ++it) {
-			json::Object& range = *it;
-			int beg = (int64_t)range["start"];
-			int end = (int64_t)range["end"];
+			int beg = it->first;
+			int end = it->second;
 			if (beg == end)
 				lines += std::to_wstring(beg);
 			else
@@ -131,10 +131,67 @@ static wxString get_history_string(json::Object &obj) {
 	return fmt_wx("%s, %s %s, %s, %s", filename, shift_amount, shift_direction, fields, lines);
 }
 
+/// Get the lines a shift from the history applies to
+static std::vector<AssDialogue *> get_history_lines(AssFile *ass, ShiftHistoryEntry const& entry) {
+	std::vector<AssDialogue *> lines;
+	if (entry.mode != 0 && entry.blocks.empty())
+		return lines;
+
+	auto block = entry.blocks.begin();
+	for (auto& line : ass->Events) {
+		int row = line.Row + 1;
+		if (entry.mode == 1) {
+			while (block != entry.blocks.end() && block->second < row)
+				++block;
+			if (block == entry.blocks.end()) break;
+			if (row < block->first) continue;
+		}
+		else if (entry.mode == 2 && row < entry.blocks.front().first)
+			continue;
+		lines.push_back(&line);
+	}
+	return lines;
+}
+
+/// Shift the times of lines by a number of milliseconds or frames
+static void shift_lines(std::vector<AssDialogue *> const& lines, int shift, bool by_time,
+	bool start, bool end, agi::vfr::Framerate const& fps)
+{
+	std::vector<int> starts(lines.size()), ends(lines.size());
+	for (size_t i = 0; i < lines.size(); ++i) {
+		starts[i] = lines[i]->Start;
+		ends[i] = lines[i]->End;
+	}
+
+	// Shifting by frames converts each time to a frame and back, which is
+	// nearly all of the work, so the lines are split between threads
+	auto shift_times = [&](int *times, size_t count, agi::vfr::Time type) {
+		if (!by_time)
+			fps.FramesAtTimes(times, times, count, type);
+		for (size_t i = 0; i < count; ++i)
+			times[i] += shift;
+		if (!by_time)
+			fps.TimesAtFrames(times, times, count, type);
+	};
+	agi::dispatch::ParallelFor(lines.size(), 4096, [&](size_t begin, size_t stop) {
+		if (start)
+			shift_times(&starts[begin], stop - begin, agi::vfr::START);
+		if (end)
+			shift_times(&ends[begin], stop - begin, agi::vfr::END);
+	});
+
+	for (size_t i = 0; i < lines.size(); ++i) {
+		if (start)
+			lines[i]->Start = starts[i];
+		if (end)
+			lines[i]->End = ends[i];
+	}
+}
+
 DialogShiftTimes::DialogShiftTimes(agi::Context *context)
 : wxDialog(context->parent, -1, _("Shift Times"))
 , context(context)
-, history_filename(config::path->Decode("?user/shift_history.json"))
+, history(config::path->Decode("?user/shift_history.dat"), config::path->Decode("?user/shift_history.json"))
 , timecodes_loaded_slot(context->project->AddTimecodesListener(&DialogShiftTimes::OnTimecodesLoaded, this))
 , selected_set_changed_slot(context->selectionController->AddSelectionListener(&DialogShiftTimes::OnSelectedSetChanged, this))
 {
@@ -172,6 +229,16 @@ DialogShiftTimes::DialogShiftTimes(agi::Context *context)
 	wxButton *clear_button = new wxButton(this, -1, _("&Clear"));
 	clear_button->Bind(wxEVT_BUTTON, &DialogShiftTimes::OnClear, this);
 
+	replay_button = new wxButton(this, -1, _("Re&play"));
+	replay_button->SetToolTip(_("Shift the same lines by the same amount again"));
+	replay_button->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) { ApplyHistory(false); });
+	replay_button->Disable();
+
+	revert_button = new wxButton(this, -1, _("Re&vert"));
+	revert_button->SetToolTip(_("Shift the same lines by the same amount in the opposite direction"));
+	revert_button->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) { ApplyHistory(true); });
+	revert_button->Disable();
+
 	// Set initial control states
 	OnTimecodesLoaded(context->project->Timecodes());
 	OnSelectedSetChanged();
@@ -211,8 +278,13 @@ DialogShiftTimes::DialogShiftTimes(agi::Context *context)
 	left_sizer->Add(time_fields, wxSizerFlags().Expand());
 
 	wxSizer *history_sizer = new wxStaticBoxSizer(wxVERTICAL, this, _("Load from history"));
+	wxSizer *history_button_sizer = new wxBoxSizer(wxHORIZONTAL);
+	history_button_sizer->Add(replay_button, wxSizerFlags(1).Expand());
+	history_button_sizer->Add(revert_button, wxSizerFlags(1).Expand().Border(wxLEFT));
+	history_button_sizer->Add(clear_button, wxSizerFlags(1).Expand().Border(wxLEFT));
+
 	history_sizer->Add(history_box, wxSizerFlags(1).Expand());
-	history_sizer->Add(clear_button, wxSizerFlags().Expand().Border(wxTOP));
+	history_sizer->Add(history_button_sizer, wxSizerFlags().Expand().Border(wxTOP));
 
 	wxSizer *top_sizer = new wxBoxSizer(wxHORIZONTAL);
 	top_sizer->Add(left_sizer, wxSizerFlags().Border(wxALL & ~wxRIGHT).Expand());
@@ -228,6 +300,7 @@ DialogShiftTimes::DialogShiftTimes(agi::Context *context)
 	Bind(wxEVT_BUTTON, std::bind(&HelpButton::OpenPage, "Shift Times"), wxID_HELP);
 	shift_time->Bind(wxEVT_TEXT_ENTER, &DialogShiftTimes::Process, this);
 	history_box->Bind(wxEVT_LISTBOX_DCLICK, &DialogShiftTimes::OnHistoryClick, this);
+	history_box->Bind(wxEVT_LISTBOX, &DialogShiftTimes::OnHistorySelect, this);
 }
 
 DialogShiftTimes::~DialogShiftTimes() {
@@ -268,9 +341,10 @@ void DialogShiftTimes::OnSelectedSetChanged() {
 }
 
 void DialogShiftTimes::OnClear(wxCommandEvent &) {
-	agi::fs::Remove(history_filename);
+	history.Clear();
 	history_box->Clear();
-	history.clear();
+	replay_button->Disable();
+	revert_button->Disable();
 }
 
 void DialogShiftTimes::OnByTime(wxCommandEvent &) {
@@ -284,52 +358,54 @@ void DialogShiftTimes::OnByFrames(wxCommandEvent &) {
 }
 
 void DialogShiftTimes::OnHistoryClick(wxCommandEvent &evt) {
-	size_t entry = evt.GetInt();
-	if (entry >= history.size()) return;
+	size_t entry_index = evt.GetInt();
+	if (entry_index >= history_box->GetCount()) return;
 
-	json::Object& obj = history[entry];
-	if (obj["is by time"]) {
-		shift_time->SetTime(agi::Time((std::string)obj["amount"]));
+	auto entry = history.Get(entry_index);
+	if (entry.by_time) {
+		shift_time->SetTime(entry.amount);
 		shift_by_time->SetValue(true);
 		OnByTime(evt);
 	}
 	else {
-		shift_frames->SetValue(to_wx(obj["amount"]));
+		shift_frames->SetValue(std::to_wstring(entry.amount));
 		if (shift_by_frames->IsEnabled()) {
 			shift_by_frames->SetValue(true);
 			OnByFrames(evt);
 		}
 	}
 
-	if (obj["is backward"])
+	if (entry.backward)
 		shift_backward->SetValue(true);
 	else
 		shift_forward->SetValue(true);
 
-	selection_mode->SetSelection((int64_t)obj["mode"]);
-	time_fields->SetSelection((int64_t)obj["fields"]);
+	selection_mode->SetSelection(entry.mode);
+	time_fields->SetSelection(entry.fields);
 }
 
-void DialogShiftTimes::SaveHistory(json::Array shifted_blocks) {
-	json::Object new_entry;
-	new_entry["filename"] = context->subsController->Filename().filename().string();
-	new_entry["is by time"] = shift_by_time->GetValue();
-	new_entry["is backward"] = shift_backward->GetValue();
-	new_entry["amount"] = from_wx(shift_by_time->GetValue() ? shift_time->GetValue() : shift_frames->GetValue());
-	new_entry["fields"] = time_fields->GetSelection();
-	new_entry["mode"] = selection_mode->GetSelection();
-	new_entry["selection"] = std::move(shifted_blocks);
-
-	history.insert(history.begin(), std::move(new_entry));
-	if (history.size() > 50)
-		history.resize(50);
+void DialogShiftTimes::OnHistorySelect(wxCommandEvent &evt) {
+	bool selected = evt.GetInt() >= 0;
+	replay_button->Enable(selected);
+	revert_button->Enable(selected);
+}
 
-	try {
-		agi::JsonWriter::Write(history, agi::io::Save(history_filename).Get());
-	}
-	catch (agi::fs::FileSystemError const& e) {
-		LOG_E("dialog_shift_times/save_history") << "Cannot save shift times history: " << e.GetMessage();
+ShiftHistoryEntry DialogShiftTimes::GetHistoryEntry(std::vector<std::pair<int, int>> shifted_blocks) {
+	ShiftHistoryEntry entry;
+	entry.filename = context->subsController->Filename().filename().string();
+	entry.by_time = shift_by_time->GetValue();
+	entry.backward = shift_backward->GetValue();
+	if (entry.by_time)
+		entry.amount = shift_time->GetTime();
+	else {
+		long frames = 0;
+		shift_frames->GetValue().ToLong(&frames);
+		entry.amount = frames;
 	}
+	entry.fields = time_fields->GetSelection();
+	entry.mode = selection_mode->GetSelection();
+	entry.blocks = std::move(shifted_blocks);
+	return entry;
 }
 
 void DialogShiftTimes::LoadHistory() {
@@ -337,19 +413,13 @@ void DialogShiftTimes::LoadHistory() {
 	history_box->Freeze();
 
 	try {
-		json::UnknownElement root;
-		json::Reader::Read(root, *agi::io::Open(history_filename));
-		history = std::move(static_cast<json::Array&>(root));
-
-		for (auto& history_entry : history)
-			history_box->Append(get_history_string(history_entry));
+		for (size_t i = 0; i < history.size(); ++i)
+			history_box->Append(get_history_string(history.Get(i)));
 	}
-	catch (agi::fs::FileSystemError const& e) {
+	catch (agi::InvalidInputException const& e) {
+		// Entries after a corrupt one are just left out of the list
 		LOG_D("dialog_shift_times/load_history") << "Cannot load shift times history: " << e.GetMessage();
 	}
-	catch (json::Exception const& e) {
-		LOG_D("dialog_shift_times/load_history") << "Cannot load shift times history: " << e.what();
-	}
 	catch (...) {
 		history_box->Thaw();
 		throw;
@@ -360,40 +430,25 @@ void DialogShiftTimes::LoadHistory() {
 
 void DialogShiftTimes::Process(wxCommandEvent &) {
 	int mode = selection_mode->GetSelection();
-	int type = time_fields->GetSelection();
-	bool reverse = shift_backward->GetValue();
 	bool by_time = shift_by_time->GetValue();
 
-	bool start = type != 2;
-	bool end = type != 1;
-
 	auto const& sel = context->selectionController->GetSelectedSet();
 
-	long shift;
-	if (by_time) {
-		shift = shift_time->GetTime();
-		if (shift == 0) {
-			Close();
-			return;
-		}
+	if (by_time && shift_time->GetTime() == 0) {
+		Close();
+		return;
 	}
-	else
-		shift_frames->GetValue().ToLong(&shift);
-
-	if (reverse)
-		shift = -shift;
 
 	// Track which rows were shifted for the log
 	int block_start = 0;
-	json::Array shifted_blocks;
+	std::vector<std::pair<int, int>> shifted_blocks;
+	std::vector<AssDialogue *> lines;
+	lines.reserve(mode == 1 ? sel.size() : context->ass->Events.size());
 
 	for (auto& line : context->ass->Events) {
 		if (!sel.count(&line)) {
 			if (block_start) {
-				json::Object block;
-				block["start"] = block_start;
-				block["end"] = line.Row;
-				shifted_blocks.push_back(std::move(block));
+				shifted_blocks.emplace_back(block_start, line.Row);
 				block_start = 0;
 			}
 			if (mode == 1) continue;
@@ -402,30 +457,37 @@ void DialogShiftTimes::Process(wxCommandEvent &) {
 		else if (!block_start)
 			block_start = line.Row + 1;
 
-		if (start)
-			line.Start = Shift(line.Start, shift, by_time, agi::vfr::START);
-		if (end)
-			line.End = Shift(line.End, shift, by_time, agi::vfr::END);
+		lines.push_back(&line);
 	}
 
-	context->ass->Commit(_("shifting"), AssFile::COMMIT_DIAG_TIME);
+	if (block_start)
+		shifted_blocks.emplace_back(block_start, context->ass->Events.back().Row + 1);
 
-	if (block_start) {
-		json::Object block;
-		block["start"] = block_start;
-		block["end"] = context->ass->Events.back().Row + 1;
-		shifted_blocks.push_back(std::move(block));
-	}
+	auto entry = GetHistoryEntry(std::move(shifted_blocks));
+	history.Add(entry);
+	Apply(lines, entry);
+}
 
-	SaveHistory(std::move(shifted_blocks));
-	Close();
+void DialogShiftTimes::ApplyHistory(bool revert) {
+	int entry_index = history_box->GetSelection();
+	if (entry_index == wxNOT_FOUND) return;
+
+	auto entry = history.Get(entry_index);
+	if (!entry.by_time && !fps.IsLoaded()) return;
+
+	if (revert)
+		entry.backward = !entry.backward;
+	entry.filename = context->subsController->Filename().filename().string();
+
+	auto lines = get_history_lines(context->ass.get(), entry);
+	history.Add(entry);
+	Apply(lines, entry);
 }
 
-int DialogShiftTimes::Shift(int initial_time, int shift, bool by_time, agi::vfr::Time type) {
-	if (by_time)
-		return initial_time + shift;
-	else
-		return fps.TimeAtFrame(shift + fps.FrameAtTime(initial_time, type), type);
+void DialogShiftTimes::Apply(std::vector<AssDialogue *> const& lines, ShiftHistoryEntry const& entry) {
+	shift_lines(lines, entry.Shift(), entry.by_time, entry.fields != 2, entry.fields != 1, fps);
+	context->ass->Commit(_("shifting"), AssFile::COMMIT_DIAG_TIME);
+	Close();
 }
 }
 
@@ -18,6 +18,7 @@
 #include "ass_file.h"
 #include "compat.h"
 #include "dialog_manager.h"
+#include "format.h"
 #include "help_button.h"
 #include "include/aegisub/context.h"
 #include "include/aegisub/spellchecker.h"
@@ -27,25 +28,36 @@
 #include "text_selection_controller.h"
 
 #include <libaegisub/ass/dialogue_parser.h>
+#include <libaegisub/dispatch.h>
 #include <libaegisub/exception.h>
 #include <libaegisub/spellchecker.h>
 
+#include <algorithm>
+#include <atomic>
 #include <boost/locale/conversion.hpp>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <wx/arrstr.h>
 #include <wx/checkbox.h>
 #include <wx/combobox.h>
 #include <wx/dialog.h>
 #include <wx/intl.h>
 #include <wx/listbox.h>
+#include <wx/listctrl.h>
 #include <wx/msgdlg.h>
 #include <wx/sizer.h>
 #include <wx/stattext.h>
 #include <wx/textctrl.h>
 
 namespace {
+/// Words which the user has said to ignore, which are shared between the spell
+/// checker dialogs and kept for the rest of the session
+std::set<std::string> ignored_words;
+
 class DialogSpellChecker final : public wxDialog {
 	agi::Context *context; ///< The project context
 	std::unique_ptr<agi::SpellChecker> spellchecker; ///< The spellchecking engine
@@ -53,9 +65,6 @@ class DialogSpellChecker final : public wxDialog {
 	/// Words which the user has indicated should always be corrected
 	std::map<std::string, std::string> auto_replace;
 
-	/// Words which the user has temporarily added to the dictionary
-	std::set<std::string> auto_ignore;
-
 	/// Dictionaries available
 	wxArrayString dictionary_lang_codes;
 
@@ -74,6 +83,19 @@ class DialogSpellChecker final : public wxDialog {
 	AssDialogue *active_line = nullptr; ///< The most recently checked line
 	bool has_looped = false;            ///< Has the search already looped from the end to beginning?
 
+	/// Lines which the background check found to have no misspelled words,
+	/// and the text they had when they were checked
+	std::unordered_map<const AssDialogue *, boost::flyweight<std::string>> clean_lines;
+	/// Set to cancel the currently running background check
+	std::shared_ptr<std::atomic<bool>> cancel_check;
+
+	/// Start checking all of the lines on a background thread so that
+	/// FindNext can skip the ones without any misspelled words
+	void StartBackgroundCheck();
+
+	/// Was the line found to be clean and has it not changed since?
+	bool IsClean(const AssDialogue *line) const;
+
 	/// Find the next misspelled word and close the dialog if there are none
 	/// @return Are there any more misspelled words?
 	bool FindNext();
@@ -97,6 +119,7 @@ class DialogSpellChecker final : public wxDialog {
 
 public:
 	DialogSpellChecker(agi::Context *context);
+	~DialogSpellChecker();
 };
 
 DialogSpellChecker::DialogSpellChecker(agi::Context *context)
@@ -199,7 +222,7 @@ DialogSpellChecker::DialogSpellChecker(agi::Context *context)
 
 		actions_sizer->Add(button = new wxButton(this, -1, _("Ignore a&ll")), button_flags);
 		button->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) {
-			auto_ignore.insert(from_wx(orig_word->GetValue()));
+			ignored_words.insert(from_wx(orig_word->GetValue()));
 			FindNext();
 		});
 
@@ -212,6 +235,7 @@ DialogSpellChecker::DialogSpellChecker(agi::Context *context)
 		actions_sizer->Add(remove_button = new wxButton(this, -1, _("Remove fro&m dictionary")), button_flags);
 		remove_button->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) {
 			spellchecker->RemoveWord(from_wx(replace_word->GetValue()));
+			StartBackgroundCheck();
 			SetWord(from_wx(orig_word->GetValue()));
 		});
 
@@ -223,10 +247,72 @@ DialogSpellChecker::DialogSpellChecker(agi::Context *context)
 	SetSizerAndFit(main_sizer);
 	CenterOnParent();
 
+	StartBackgroundCheck();
+
 	if (FindNext())
 		Show();
 }
 
+DialogSpellChecker::~DialogSpellChecker() {
+	if (cancel_check) *cancel_check = true;
+}
+
+void DialogSpellChecker::StartBackgroundCheck() {
+	if (cancel_check) *cancel_check = true;
+	cancel_check.reset();
+	clean_lines.clear();
+
+	auto loader = SpellCheckerFactory::GetBackgroundSpellCheckerLoader();
+	if (!loader) return;
+
+	// The lines can't be touched off the main thread, so check a snapshot of
+	// their text and only trust the results while the text still matches
+	std::vector<std::pair<const AssDialogue *, boost::flyweight<std::string>>> lines;
+	lines.reserve(context->ass->Events.size());
+	for (auto const& line : context->ass->Events)
+		lines.emplace_back(&line, line.Text);
+
+	auto cancel = std::make_shared<std::atomic<bool>>(false);
+	cancel_check = cancel;
+	agi::dispatch::Background().Async([=] {
+		auto checker = loader();
+		if (!checker) return;
+
+		std::vector<std::pair<const AssDialogue *, boost::flyweight<std::string>>> clean;
+		for (auto const& line : lines) {
+			if (*cancel) return;
+
+			std::string const& text = line.second.get();
+			auto tokens = agi::ass::TokenizeDialogueBody(text);
+			agi::ass::SplitWords(text, tokens);
+
+			bool misspelled = false;
+			size_t pos = 0;
+			for (auto const& tok : tokens) {
+				if (tok.type == agi::ass::DialogueTokenType::WORD && !checker->CheckWord(text.substr(pos, tok.length))) {
+					misspelled = true;
+					break;
+				}
+				pos += tok.length;
+			}
+			if (!misspelled)
+				clean.push_back(line);
+		}
+
+		agi::dispatch::Main().Async([=] {
+			if (*cancel) return;
+			for (auto const& line : clean)
+				clean_lines.insert(line);
+			cancel_check.reset();
+		});
+	});
+}
+
+bool DialogSpellChecker::IsClean(const AssDialogue *line) const {
+	auto it = clean_lines.find(line);
+	return it != clean_lines.end() && it->second == line->Text;
+}
+
 void DialogSpellChecker::OnReplace(wxCommandEvent&) {
 	Replace();
 	FindNext();
@@ -236,6 +322,7 @@ void DialogSpellChecker::OnChangeLanguage(wxCommandEvent&) {
 	wxString code = dictionary_lang_codes[language->GetSelection()];
 	OPT_SET("Tool/Spell Checker/Language")->SetString(from_wx(code));
 
+	StartBackgroundCheck();
 	FindNext();
 }
 
@@ -255,7 +342,7 @@ bool DialogSpellChecker::FindNext() {
 	int start_pos = context->textSelectionController->GetInsertionPoint();
 	int commit_id = -1;
 
-	if (CheckLine(active_line, start_pos, &commit_id))
+	if (!IsClean(active_line) && CheckLine(active_line, start_pos, &commit_id))
 		return true;
 
 	auto it = context->ass->iterator_to(*active_line);
@@ -271,7 +358,7 @@ bool DialogSpellChecker::FindNext() {
 		}
 
 		active_line = &*it;
-		if (CheckLine(active_line, 0, &commit_id))
+		if (!IsClean(active_line) && CheckLine(active_line, 0, &commit_id))
 			return true;
 	}
 
@@ -306,7 +393,7 @@ bool DialogSpellChecker::CheckLine(AssDialogue *active_line, int start_pos, int
 		word_len = tok.length;
 		std::string word = text.substr(word_start, word_len);
 
-		if (auto_ignore.count(word) || spellchecker->CheckWord(word) || (ignore_uppercase && word == boost::locale::to_upper(word))) {
+		if (ignored_words.count(word) || spellchecker->CheckWord(word) || (ignore_uppercase && word == boost::locale::to_upper(word))) {
 			word_start += tok.length;
 			continue;
 		}
@@ -358,8 +445,512 @@ void DialogSpellChecker::SetWord(std::string const& word) {
 
 	add_button->Enable(spellchecker->CanAddWord(word));
 }
+
+/// A misspelled word and everywhere it appears in the script
+struct Misspelling {
+	struct Hit {
+		AssDialogue *line;                 ///< Line the word is in
+		boost::flyweight<std::string> text; ///< Text of the line when it was checked
+		size_t start;                      ///< Byte offset of the word in text
+	};
+
+	std::string word;
+	std::vector<Hit> hits; ///< Occurrences of the word in script order
+
+	/// Suggested replacements, which are only looked up once the word is selected
+	std::vector<std::string> suggestions;
+	bool have_suggestions = false;
+};
+
+typedef std::vector<std::pair<AssDialogue *, boost::flyweight<std::string>>> LineSnapshot;
+
+/// Find the byte offset of the first occurrence of a word in a line
+size_t FindWord(std::string const& text, std::string const& word) {
+	auto tokens = agi::ass::TokenizeDialogueBody(text);
+	agi::ass::SplitWords(text, tokens);
+
+	size_t pos = 0;
+	for (auto const& tok : tokens) {
+		if (tok.type == agi::ass::DialogueTokenType::WORD && text.compare(pos, tok.length, word) == 0)
+			return pos;
+		pos += tok.length;
+	}
+	return std::string::npos;
+}
+
+/// Spell checkers for the threads checking a script, which are kept between
+/// checks as loading a dictionary takes longer than checking most scripts
+class SpellCheckerPool {
+	std::function<std::unique_ptr<agi::SpellChecker>()> loader;
+	std::vector<std::unique_ptr<agi::SpellChecker>> checkers;
+	std::mutex lock;
+
+public:
+	/// Language option the checkers were loaded for
+	const std::string language;
+
+	SpellCheckerPool(std::function<std::unique_ptr<agi::SpellChecker>()> loader, std::string language)
+	: loader(std::move(loader)), language(std::move(language)) { }
+
+	/// Take a checker from the pool, loading a new one if they're all in use
+	std::unique_ptr<agi::SpellChecker> Get() {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (!checkers.empty()) {
+				auto checker = std::move(checkers.back());
+				checkers.pop_back();
+				return checker;
+			}
+		}
+		return loader();
+	}
+
+	/// Return a checker to the pool once a thread is done with it
+	void Put(std::unique_ptr<agi::SpellChecker> checker) {
+		std::lock_guard<std::mutex> guard(lock);
+		checkers.push_back(std::move(checker));
+	}
+};
+
+/// Check all of the given lines, splitting them between as many threads as
+/// are available with a separate spell checker for each
+/// @param lines Lines to check
+/// @param pool Spell checkers for the threads
+/// @param ignored Words to not report
+/// @param ignore_uppercase Skip words which are entirely upper case
+/// @param min_chunk Fewest lines worth using another spell checker for
+/// @param cancel Flag which is set when the results are no longer wanted
+/// @return Misspelled words sorted by the number of times they appear
+std::vector<Misspelling> FindMisspellings(LineSnapshot const& lines, SpellCheckerPool& pool, std::set<std::string> const& ignored, bool ignore_uppercase, size_t min_chunk, std::atomic<bool> const& cancel) {
+	struct ChunkResult {
+		size_t begin;
+		std::unordered_map<std::string, std::vector<Misspelling::Hit>> words;
+	};
+	std::vector<ChunkResult> chunks;
+	std::mutex chunks_lock;
+
+	agi::dispatch::ParallelFor(lines.size(), min_chunk, [&](size_t begin, size_t end) {
+		if (cancel) return;
+		auto checker = pool.Get();
+		if (!checker) return;
+
+		ChunkResult result;
+		result.begin = begin;
+		std::unordered_map<std::string, bool> checked;
+
+		for (size_t i = begin; i < end && !cancel; ++i) {
+			std::string const& text = lines[i].second.get();
+			auto tokens = agi::ass::TokenizeDialogueBody(text);
+			agi::ass::SplitWords(text, tokens);
+
+			size_t pos = 0;
+			for (auto const& tok : tokens) {
+				size_t start = pos;
+				pos += tok.length;
+				if (tok.type != agi::ass::DialogueTokenType::WORD) continue;
+
+				std::string word = text.substr(start, tok.length);
+				auto it = checked.find(word);
+				if (it == checked.end()) {
+					bool ok = ignored.count(word) || (ignore_uppercase && word == boost::locale::to_upper(word)) || checker->CheckWord(word);
+					it = checked.emplace(word, ok).first;
+				}
+				if (!it->second)
+					result.words[word].push_back({lines[i].first, lines[i].second, start});
+			}
+		}
+
+		pool.Put(std::move(checker));
+
+		std::lock_guard<std::mutex> lock(chunks_lock);
+		chunks.push_back(std::move(result));
+	});
+
+	// Merge the chunks in order so that each word's hits stay in script order
+	sort(begin(chunks), end(chunks), [](ChunkResult const& a, ChunkResult const& b) {
+		return a.begin < b.begin;
+	});
+
+	std::unordered_map<std::string, size_t> index;
+	std::vector<Misspelling> ret;
+	for (auto& chunk : chunks) {
+		for (auto& word : chunk.words) {
+			auto it = index.emplace(word.first, ret.size()).first;
+			if (it->second == ret.size()) {
+				ret.emplace_back();
+				ret.back().word = word.first;
+			}
+			auto& hits = ret[it->second].hits;
+			hits.insert(end(hits), begin(word.second), end(word.second));
+		}
+	}
+
+	sort(begin(ret), end(ret), [](Misspelling const& a, Misspelling const& b) {
+		if (a.hits.size() != b.hits.size()) return a.hits.size() > b.hits.size();
+		return a.word < b.word;
+	});
+	return ret;
+}
+
+class DialogSpellCheckReport final : public wxDialog {
+	agi::Context *context; ///< The project context
+	std::unique_ptr<agi::SpellChecker> spellchecker; ///< Spell checker used for suggestions and adding words
+
+	/// Misspelled words found by the last check, in the order they're listed
+	std::vector<Misspelling> misspellings;
+	/// Spell checkers kept from the previous check
+	std::shared_ptr<SpellCheckerPool> checkers;
+	/// Set to cancel the currently running check
+	std::shared_ptr<std::atomic<bool>> cancel_check;
+	/// Set when the dialog is destroyed so that a check which is still running
+	/// doesn't report back to it
+	std::shared_ptr<bool> closed = std::make_shared<bool>(false);
+	/// Is a check running? Only one is run at a time, and a check which has
+	/// been cancelled still has to finish before the next can start
+	bool checking = false;
+
+	agi::signal::Connection commit_connection;
+
+	wxStaticText *status;     ///< Progress of the check and a summary of its results
+	wxListView *word_list;    ///< Misspelled words and their counts
+	wxListBox *hit_list;      ///< Lines containing the selected word
+	wxListBox *suggest_list;  ///< Suggested replacements for the selected word
+	wxTextCtrl *replace_word; ///< Replacement used by "Replace all"
+	wxButton *replace_button;
+	wxButton *ignore_button;
+	wxButton *add_button;
+	wxButton *check_button;
+
+	/// Check all of the lines in the background, discarding the current results
+	void StartCheck();
+	void OnCheckFinished();
+	void OnCheckComplete(std::vector<Misspelling> results);
+
+	void UpdateWordList();
+	void UpdateStatus();
+
+	Misspelling *GetSelectedWord();
+	/// Remove the selected word from the list once it has been dealt with
+	void RemoveSelectedWord();
+
+	/// Replace every occurrence of the selected word
+	void ReplaceAll();
+
+	void OnSelectWord();
+	void OnSelectHit();
+	void OnCommit(int type);
+
+public:
+	DialogSpellCheckReport(agi::Context *context);
+	~DialogSpellCheckReport();
+};
+
+DialogSpellCheckReport::DialogSpellCheckReport(agi::Context *context)
+: wxDialog(context->parent, -1, _("Spell Check Report"), wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+, context(context)
+, spellchecker(SpellCheckerFactory::GetSpellChecker())
+, commit_connection(context->ass->AddCommitListener(&DialogSpellCheckReport::OnCommit, this))
+{
+	if (!spellchecker) {
+		wxMessageBox("No spellchecker available.", "Error", wxOK | wxICON_ERROR | wxCENTER);
+		throw agi::UserCancelException("No spellchecker available");
+	}
+
+	SetIcon(GETICON(spellcheck_toolbutton_16));
+
+	wxSizer *main_sizer = new wxBoxSizer(wxVERTICAL);
+	main_sizer->Add(status = new wxStaticText(this, -1, ""), wxSizerFlags().Expand().Border());
+
+	wxSizer *lists_sizer = new wxBoxSizer(wxHORIZONTAL);
+	main_sizer->Add(lists_sizer, wxSizerFlags(1).Expand().Border(~wxTOP & wxALL, 5));
+
+	word_list = new wxListView(this, -1, wxDefaultPosition, wxSize(250, 300), wxLC_REPORT | wxLC_SINGLE_SEL);
+	word_list->InsertColumn(0, _("Misspelled word"), wxLIST_FORMAT_LEFT, 170);
+	word_list->InsertColumn(1, _("Count"), wxLIST_FORMAT_RIGHT, 60);
+	word_list->Bind(wxEVT_LIST_ITEM_SELECTED, [=](wxListEvent&) { OnSelectWord(); });
+	lists_sizer->Add(word_list, wxSizerFlags().Expand().Border(wxRIGHT, 5));
+
+	hit_list = new wxListBox(this, -1, wxDefaultPosition, wxSize(400, 300));
+	hit_list->Bind(wxEVT_LISTBOX, [=](wxCommandEvent&) { OnSelectHit(); });
+	lists_sizer->Add(hit_list, wxSizerFlags(1).Expand());
+
+	wxSizer *bottom_sizer = new wxBoxSizer(wxHORIZONTAL);
+	main_sizer->Add(bottom_sizer, wxSizerFlags().Expand().Border(~wxTOP & wxALL, 5));
+
+	wxSizer *replace_sizer = new wxBoxSizer(wxVERTICAL);
+	bottom_sizer->Add(replace_sizer, wxSizerFlags(1).Expand().Border(wxRIGHT, 5));
+
+	auto replace_with_sizer = new wxFlexGridSizer(2, 5, 5);
+	replace_with_sizer->AddGrowableCol(1, 1);
+	replace_with_sizer->Add(new wxStaticText(this, -1, _("Replace with:")), 0, wxALIGN_CENTER_VERTICAL);
+	replace_with_sizer->Add(replace_word = new wxTextCtrl(this, -1, ""), wxSizerFlags(1).Expand());
+	replace_sizer->Add(replace_with_sizer, wxSizerFlags().Expand().Border(wxBOTTOM, 5));
+
+	suggest_list = new wxListBox(this, -1, wxDefaultPosition, wxSize(300, 150));
+	suggest_list->Bind(wxEVT_LISTBOX, [=](wxCommandEvent&) {
+		replace_word->SetValue(suggest_list->GetStringSelection());
+	});
+	suggest_list->Bind(wxEVT_LISTBOX_DCLICK, [=](wxCommandEvent&) { ReplaceAll(); });
+	replace_sizer->Add(suggest_list, wxSizerFlags(1).Expand());
+
+	{
+		wxSizer *actions_sizer = new wxBoxSizer(wxVERTICAL);
+		bottom_sizer->Add(actions_sizer, wxSizerFlags().Expand());
+
+		wxSizerFlags button_flags = wxSizerFlags().Expand().Border(wxBOTTOM, 5);
+		wxButton *button;
+
+		actions_sizer->Add(replace_button = new wxButton(this, -1, _("Replace &all")), button_flags);
+		replace_button->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) { ReplaceAll(); });
+
+		actions_sizer->Add(ignore_button = new wxButton(this, -1, _("&Ignore")), button_flags);
+		ignore_button->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) {
+			if (auto word = GetSelectedWord()) {
+				ignored_words.insert(word->word);
+				RemoveSelectedWord();
+			}
+		});
+
+		actions_sizer->Add(add_button = new wxButton(this, -1, _("Add to &dictionary")), button_flags);
+		add_button->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) {
+			if (auto word = GetSelectedWord()) {
+				spellchecker->AddWord(word->word);
+				// The pooled checkers loaded the dictionary before the word was added
+				checkers.reset();
+				RemoveSelectedWord();
+			}
+		});
+
+		actions_sizer->Add(check_button = new wxButton(this, -1, _("&Check again")), button_flags);
+		check_button->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) { StartCheck(); });
+
+		actions_sizer->Add(new HelpButton(this, "Spell Checker"), button_flags);
+
+		actions_sizer->Add(new wxButton(this, wxID_CANCEL, _("Close")), button_flags.Border(0));
+	}
+
+	SetSizerAndFit(main_sizer);
+	CenterOnParent();
+
+	StartCheck();
+	Show();
+}
+
+DialogSpellCheckReport::~DialogSpellCheckReport() {
+	*closed = true;
+	if (cancel_check) *cancel_check = true;
+}
+
+void DialogSpellCheckReport::StartCheck() {
+	if (checking) return;
+	misspellings.clear();
+	UpdateWordList();
+	status->SetLabel(_("Checking spelling..."));
+
+	bool skip_comments = OPT_GET("Tool/Spell Checker/Skip Comments")->GetBool();
+	bool ignore_uppercase = OPT_GET("Tool/Spell Checker/Skip Uppercase")->GetBool();
+
+	// Lines can only be read on the main thread, so the workers check a
+	// snapshot of the text
+	LineSnapshot lines;
+	lines.reserve(context->ass->Events.size());
+	for (auto& line : context->ass->Events) {
+		if (!skip_comments || !line.Comment)
+			lines.emplace_back(&line, line.Text);
+	}
+
+	auto cancel = std::make_shared<std::atomic<bool>>(false);
+	cancel_check = cancel;
+
+	auto const& language = OPT_GET("Tool/Spell Checker/Language")->GetString();
+	if (checkers && checkers->language != language)
+		checkers.reset();
+
+	auto loader = SpellCheckerFactory::GetBackgroundSpellCheckerLoader();
+	if (!loader) {
+		// The platform's spell checker can only be used on the main thread
+		if (!checkers)
+			checkers = std::make_shared<SpellCheckerPool>(&SpellCheckerFactory::GetSpellChecker, language);
+		OnCheckComplete(FindMisspellings(lines, *checkers, ignored_words, ignore_uppercase, lines.size(), *cancel));
+		return;
+	}
+
+	if (!checkers)
+		checkers = std::make_shared<SpellCheckerPool>(loader, language);
+
+	checking = true;
+	check_button->Disable();
+
+	auto pool = checkers;
+	auto closed = this->closed;
+	agi::dispatch::Background().Async([=, ignored = ignored_words] {
+		auto results = FindMisspellings(lines, *pool, ignored, ignore_uppercase, 500, *cancel);
+		agi::dispatch::Main().Async([=, results = std::move(results)]() mutable {
+			if (*closed) return;
+			OnCheckFinished();
+			if (!*cancel)
+				OnCheckComplete(std::move(results));
+		});
+	});
+}
+
+void DialogSpellCheckReport::OnCheckFinished() {
+	checking = false;
+	check_button->Enable();
+}
+
+void DialogSpellCheckReport::OnCheckComplete(std::vector<Misspelling> results) {
+	cancel_check.reset();
+	misspellings = std::move(results);
+	UpdateWordList();
+	UpdateStatus();
+}
+
+void DialogSpellCheckReport::UpdateWordList() {
+	word_list->DeleteAllItems();
+	for (size_t i = 0; i < misspellings.size(); ++i) {
+		word_list->InsertItem(i, to_wx(misspellings[i].word));
+		word_list->SetItem(i, 1, fmt_wx("%d", misspellings[i].hits.size()));
+	}
+
+	if (misspellings.empty())
+		OnSelectWord();
+	else
+		word_list->Select(0);
+}
+
+void DialogSpellCheckReport::UpdateStatus() {
+	if (misspellings.empty()) {
+		status->SetLabel(_("No misspelled words were found."));
+		return;
+	}
+
+	size_t count = 0;
+	for (auto const& word : misspellings)
+		count += word.hits.size();
+	wxString words = fmt_plural(misspellings.size(), "one misspelled word", "%d misspelled words", misspellings.size());
+	status->SetLabel(fmt_plural(count, "Found %s in one place.", "Found %s in %d places.", words, count));
+}
+
+Misspelling *DialogSpellCheckReport::GetSelectedWord() {
+	long sel = word_list->GetFirstSelected();
+	if (sel < 0 || (size_t)sel >= misspellings.size()) return nullptr;
+	return &misspellings[sel];
+}
+
+void DialogSpellCheckReport::RemoveSelectedWord() {
+	long sel = word_list->GetFirstSelected();
+	if (sel < 0 || (size_t)sel >= misspellings.size()) return;
+
+	misspellings.erase(misspellings.begin() + sel);
+	word_list->DeleteItem(sel);
+	UpdateStatus();
+
+	if (misspellings.empty())
+		OnSelectWord();
+	else
+		word_list->Select(std::min<long>(sel, misspellings.size() - 1));
+}
+
+void DialogSpellCheckReport::OnSelectWord() {
+	auto word = GetSelectedWord();
+	replace_button->Enable(!!word);
+	ignore_button->Enable(!!word);
+	add_button->Enable(word && spellchecker->CanAddWord(word->word));
+
+	hit_list->Clear();
+	suggest_list->Clear();
+	replace_word->Clear();
+	if (!word) return;
+
+	if (!word->have_suggestions) {
+		word->suggestions = spellchecker->GetSuggestions(word->word);
+		word->have_suggestions = true;
+	}
+
+	wxArrayString suggestions = to_wx(word->suggestions);
+	replace_word->SetValue(suggestions.size() ? suggestions[0] : to_wx(word->word));
+	suggest_list->Append(suggestions);
+
+	wxArrayString hits;
+	hits.reserve(word->hits.size());
+	for (auto const& hit : word->hits)
+		hits.push_back(fmt_wx("%d: %s", hit.line->Row + 1, hit.text.get()));
+	hit_list->Append(hits);
+}
+
+void DialogSpellCheckReport::OnSelectHit() {
+	auto word = GetSelectedWord();
+	int sel = hit_list->GetSelection();
+	if (!word || sel < 0 || (size_t)sel >= word->hits.size()) return;
+
+	auto const& hit = word->hits[sel];
+	context->selectionController->SetSelectionAndActive({ hit.line }, hit.line);
+
+	// The line may have been edited since it was checked
+	size_t start = hit.line->Text == hit.text ? hit.start : FindWord(hit.line->Text, word->word);
+	if (start != std::string::npos)
+		context->textSelectionController->SetSelection(start, start + word->word.size());
+}
+
+void DialogSpellCheckReport::ReplaceAll() {
+	auto word = GetSelectedWord();
+	if (!word) return;
+
+	std::string replacement = from_wx(replace_word->GetValue());
+	bool changed = false;
+	AssDialogue *last_line = nullptr;
+	for (auto const& hit : word->hits) {
+		if (hit.line == last_line) continue;
+		last_line = hit.line;
+
+		// Retokenize rather than using the saved offsets as the line may have
+		// been edited since it was checked
+		std::string text = hit.line->Text;
+		auto tokens = agi::ass::TokenizeDialogueBody(text);
+		agi::ass::SplitWords(text, tokens);
+
+		std::string new_text;
+		new_text.reserve(text.size());
+		size_t pos = 0;
+		for (auto const& tok : tokens) {
+			if (tok.type == agi::ass::DialogueTokenType::WORD && text.compare(pos, tok.length, word->word) == 0)
+				new_text += replacement;
+			else
+				new_text.append(text, pos, tok.length);
+			pos += tok.length;
+		}
+
+		if (new_text != text) {
+			hit.line->Text = new_text;
+			changed = true;
+		}
+	}
+
+	if (changed)
+		context->ass->Commit(_("spell check replace"), AssFile::COMMIT_DIAG_TEXT);
+	RemoveSelectedWord();
+}
+
+void DialogSpellCheckReport::OnCommit(int type) {
+	// Hits hold pointers to the lines, so they have to be thrown out if any
+	// lines may have been deleted. Rather than checking again after every
+	// edit, the results are left empty until the user asks for a new check.
+	if (type != AssFile::COMMIT_NEW && !(type & AssFile::COMMIT_DIAG_ADDREM))
+		return;
+
+	if (cancel_check) *cancel_check = true;
+	cancel_check.reset();
+	misspellings.clear();
+	UpdateWordList();
+	status->SetLabel(_("Lines have been added or removed since the check. Click \"Check again\" to check the script again."));
+}
 }
 
 void ShowSpellcheckerDialog(agi::Context *c) {
 	c->dialog->Show<DialogSpellChecker>(c);
 }
+
+void ShowSpellCheckReportDialog(agi::Context *c) {
+	c->dialog->Show<DialogSpellCheckReport>(c);
+}
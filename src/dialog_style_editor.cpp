@@ -70,6 +70,8 @@ class StyleRenamer {
 	bool do_replace = false;
 	std::string source_name;
 	std::string new_name;
+	/// Parsed tags of the lines, shared between the search and the replace
+	ParsedTagsCache parsed_tags;
 
 	/// Process a single override parameter to check if it's \r with this style name
 	static void ProcessTag(std::string const& tag, AssOverrideParameter* param, void *userData) {
@@ -84,7 +86,6 @@ class StyleRenamer {
 
 	void Walk(bool replace) {
 		found_any = false;
-		do_replace = replace;
 
 		for (auto& diag : c->ass->Events) {
 			if (diag.Style == source_name) {
@@ -94,13 +95,23 @@ class StyleRenamer {
 					found_any = true;
 			}
 
+			if (found_any) return;
+
+			// Search the shared parsed blocks, and only parse a copy to edit
+			// for the lines which refer to the style
+			do_replace = false;
+			auto parsed = diag.GetParsedTags(parsed_tags);
+			for (auto block : *parsed | agi::of_type<AssDialogueBlockOverride>())
+				block->ProcessParameters(&StyleRenamer::ProcessTag, this);
+			if (!found_any) continue;
+			if (!replace) return;
+
+			found_any = false;
+			do_replace = true;
 			auto blocks = diag.ParseTags();
 			for (auto block : blocks | agi::of_type<AssDialogueBlockOverride>())
 				block->ProcessParameters(&StyleRenamer::ProcessTag, this);
-			if (replace)
-				diag.UpdateText(blocks);
-
-			if (found_any) return;
+			diag.UpdateText(blocks);
 		}
 	}
 
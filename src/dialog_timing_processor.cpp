@@ -38,16 +38,18 @@
 #include "options.h"
 #include "project.h"
 #include "selection_controller.h"
+#include "timing_processor.h"
 #include "utils.h"
 
 #include <libaegisub/address_of_adaptor.h>
 #include <libaegisub/ass/time.h>
+#include <libaegisub/make_unique.h>
 
-#include <algorithm>
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
 #include <functional>
+#include <memory>
 #include <vector>
 #include <wx/button.h>
 #include <wx/checkbox.h>
@@ -59,6 +61,7 @@
 #include <wx/statbox.h>
 #include <wx/stattext.h>
 #include <wx/textctrl.h>
+#include <wx/timer.h>
 #include <wx/valnum.h>
 
 using namespace boost::adaptors;
@@ -87,6 +90,15 @@ struct DialogTimingProcessor {
 	wxSlider *adjacentBias;    ///< Bias between shifting start and end times when snapping adjacent lines
 	wxCheckListBox *StyleList; ///< List of styles to process
 	wxButton *ApplyButton;     ///< Button to apply the processing
+	wxStaticText *preview;     ///< Number of lines which would be changed
+	/// Delays updating the preview until the settings stop changing, as
+	/// every keystroke in a text box or step of the slider changes them
+	wxTimer preview_timer;
+
+	/// Times of the lines which can be processed, built on first use
+	std::unique_ptr<TimingProcessor> processor;
+	/// Was processor built from just the selected lines?
+	bool processor_selection_only = false;
 
 	void OnApply(wxCommandEvent &event);
 
@@ -96,11 +108,22 @@ struct DialogTimingProcessor {
 	/// Enable and disable text boxes based on which checkboxes are checked
 	void UpdateControls();
 
+	/// Show how many lines the current settings would change
+	void UpdatePreview();
+	/// Update the preview once the settings haven't changed for a moment
+	void SchedulePreview();
+
 	/// Process the file
 	void Process();
 
-	/// Get a list of dialogue lines in the file sorted by start time
-	std::vector<AssDialogue*> SortDialogues();
+	/// Get the processor for the lines the current settings apply to
+	TimingProcessor &GetProcessor();
+
+	/// Get which entries of the style list are checked
+	std::vector<bool> GetEnabledStyles() const;
+
+	/// Get the new times for the lines with the current settings
+	std::vector<TimingProcessor::Change> GetChanges();
 
 	DialogTimingProcessor(agi::Context *c);
 };
@@ -219,8 +242,9 @@ DialogTimingProcessor::DialogTimingProcessor(agi::Context *c)
 	keysEnable->SetValue(OPT_GET("Tool/Timing Post Processor/Enable/Keyframe")->GetBool());
 	KeyframesFlexSizer->Add(keysEnable,0,wxRIGHT|wxEXPAND,10);
 
-	// Keyframes are only available if timecodes are loaded
-	bool keysAvailable = !c->project->Keyframes().empty() && c->project->Timecodes().IsLoaded();
+	// Keyframes are only available if timecodes are loaded, but the end of
+	// the video can be snapped to whenever one is open
+	bool keysAvailable = (!c->project->Keyframes().empty() && c->project->Timecodes().IsLoaded()) || c->project->VideoProvider();
 	if (!keysAvailable) {
 		keysEnable->SetValue(false);
 		keysEnable->Enable(false);
@@ -255,6 +279,8 @@ DialogTimingProcessor::DialogTimingProcessor(agi::Context *c)
 	RightSizer->Add(AdjacentSizer,0,wxBOTTOM|wxEXPAND,5);
 	RightSizer->Add(KeyframesSizer,0,wxBOTTOM|wxEXPAND,5);
 	RightSizer->AddStretchSpacer(1);
+	preview = new wxStaticText(&d, -1, "");
+	RightSizer->Add(preview,0,wxBOTTOM|wxEXPAND,5);
 	RightSizer->Add(ButtonSizer,0,wxLEFT|wxRIGHT|wxBOTTOM|wxEXPAND,0);
 
 	// Style buttons sizer
@@ -279,6 +305,9 @@ DialogTimingProcessor::DialogTimingProcessor(agi::Context *c)
 
 	d.Bind(wxEVT_CHECKBOX, bind(&DialogTimingProcessor::UpdateControls, this));
 	d.Bind(wxEVT_CHECKLISTBOX, bind(&DialogTimingProcessor::UpdateControls, this));
+	d.Bind(wxEVT_TEXT, bind(&DialogTimingProcessor::SchedulePreview, this));
+	d.Bind(wxEVT_SLIDER, bind(&DialogTimingProcessor::SchedulePreview, this));
+	preview_timer.Bind(wxEVT_TIMER, bind(&DialogTimingProcessor::UpdatePreview, this));
 	d.Bind(wxEVT_BUTTON, &DialogTimingProcessor::OnApply, this, wxID_OK);
 	all->Bind(wxEVT_BUTTON, bind(&DialogTimingProcessor::CheckAll, this, true));
 	none->Bind(wxEVT_BUTTON, bind(&DialogTimingProcessor::CheckAll, this, false));
@@ -300,9 +329,26 @@ void DialogTimingProcessor::UpdateControls() {
 	for (size_t i = 0; !any_checked && i < len; ++i)
 		any_checked = StyleList->IsChecked(i);
 	ApplyButton->Enable(any_checked && (hasLeadIn->IsChecked() || hasLeadOut->IsChecked() || keysEnable->IsChecked() || adjsEnable->IsChecked()));
+	SchedulePreview();
+}
+
+void DialogTimingProcessor::SchedulePreview() {
+	preview_timer.Start(150, wxTIMER_ONE_SHOT);
+}
+
+void DialogTimingProcessor::UpdatePreview() {
+	// Read each box separately so that an invalid value in one, which is
+	// left at its previous value, doesn't stop the rest from updating
+	for (auto child : d.GetChildren()) {
+		if (auto validator = child->GetValidator())
+			validator->TransferFromWindow();
+	}
+	size_t count = GetChanges().size();
+	preview->SetLabelText(fmt_plural(count, "One line will be changed", "%u lines will be changed", count));
 }
 
 void DialogTimingProcessor::OnApply(wxCommandEvent &) {
+	preview_timer.Stop();
 	d.TransferDataFromWindow();
 	// Save settings
 	OPT_SET("Tool/Timing Post Processor/Lead/IN")->SetInt(leadIn);
@@ -324,122 +370,78 @@ void DialogTimingProcessor::OnApply(wxCommandEvent &) {
 	d.EndModal(0);
 }
 
-std::vector<AssDialogue*> DialogTimingProcessor::SortDialogues() {
-	std::set<boost::flyweight<std::string>> styles;
-	for (size_t i = 0; i < StyleList->GetCount(); ++i) {
-		if (StyleList->IsChecked(i))
-			styles.insert(boost::flyweight<std::string>(from_wx(StyleList->GetString(i))));
-	}
-
-	std::vector<AssDialogue*> sorted;
+TimingProcessor &DialogTimingProcessor::GetProcessor() {
+	bool selection_only = onlySelection->IsChecked();
+	if (processor && processor_selection_only == selection_only)
+		return *processor;
 
-	auto valid_line = [&](const AssDialogue *d) { return !d->Comment && styles.count(d->Style); };
-	if (onlySelection->IsChecked())
+	std::vector<AssDialogue*> lines;
+	auto valid_line = [](const AssDialogue *d) { return !d->Comment; };
+	if (selection_only)
 		boost::copy(c->selectionController->GetSelectedSet() | filtered(valid_line),
-		    back_inserter(sorted));
+		    back_inserter(lines));
 	else {
-		sorted.reserve(c->ass->Events.size());
-		boost::push_back(sorted, c->ass->Events | agi::address_of | filtered(valid_line));
+		lines.reserve(c->ass->Events.size());
+		boost::push_back(lines, c->ass->Events | agi::address_of | filtered(valid_line));
 	}
 
-	// Check if rows are valid
-	for (auto diag : sorted) {
-		if (diag->Start > diag->End) {
-			wxMessageBox(
-				fmt_tl("One of the lines in the file (%i) has negative duration. Aborting.", diag->Row),
-				_("Invalid script"),
-				wxOK | wxICON_ERROR | wxCENTER);
-			sorted.clear();
-			break;
-		}
-	}
+	std::vector<std::string> styles;
+	for (size_t i = 0; i < StyleList->GetCount(); ++i)
+		styles.push_back(from_wx(StyleList->GetString(i)));
 
-	boost::sort(sorted, [](const AssDialogue *a, const AssDialogue *b) {
-		return a->Start < b->Start;
-	});
-	return sorted;
+	processor = agi::make_unique<TimingProcessor>(std::move(lines), styles);
+	processor_selection_only = selection_only;
+	return *processor;
 }
 
-static int get_closest_kf(std::vector<int> const& kf, int frame) {
-	const auto pos = boost::upper_bound(kf, frame);
-	// Return last keyframe if this is after the last one
-	if (pos == end(kf)) return kf.back();
-	// *pos is greater than frame, and *(pos - 1) is less than or equal to frame
-	return (pos == begin(kf) || *pos - frame < frame - *(pos - 1)) ? *pos : *(pos - 1);
+std::vector<bool> DialogTimingProcessor::GetEnabledStyles() const {
+	std::vector<bool> enabled(StyleList->GetCount());
+	for (size_t i = 0; i < enabled.size(); ++i)
+		enabled[i] = StyleList->IsChecked(i);
+	return enabled;
 }
 
-template<class Iter, class Field>
-static int safe_time(Iter begin, Iter end, AssDialogue *comp, int initial, Field field, int const& (*cmp)(int const&, int const&)) {
-	// Compare to every previous line (yay for O(n^2)!) to see if it's OK to add lead-in
-	for (; begin != end; ++begin) {
-		// If the line doesn't already collide with this line, extend it only
-		// to the edge of the line
-		if (!comp->CollidesWith(*begin))
-			initial = cmp(initial, (*begin)->*field);
-	}
-	return initial;
+std::vector<TimingProcessor::Change> DialogTimingProcessor::GetChanges() {
+	TimingProcessor::Settings settings;
+	if (hasLeadIn->IsChecked())
+		settings.lead_in = leadIn;
+	if (hasLeadOut->IsChecked())
+		settings.lead_out = leadOut;
+
+	settings.adjacent = adjsEnable->IsChecked();
+	settings.adjacent_gap = adjGap;
+	settings.adjacent_overlap = adjOverlap;
+	settings.adjacent_bias = adjacentBias->GetValue() / 100.0;
+
+	settings.keyframes = keysEnable->IsChecked();
+	settings.before_start = beforeStart;
+	settings.after_start = afterStart;
+	settings.before_end = beforeEnd;
+	settings.after_end = afterEnd;
+
+	int video_end_frame = -1;
+	if (auto provider = c->project->VideoProvider())
+		video_end_frame = provider->GetFrameCount() - 1;
+
+	return GetProcessor().Run(settings, GetEnabledStyles(),
+		c->project->IndexedKeyframes(), c->project->Timecodes(), video_end_frame);
 }
 
 void DialogTimingProcessor::Process() {
-	std::vector<AssDialogue*> sorted = SortDialogues();
-	if (sorted.empty()) return;
-
-	// Add lead-in/out
-	if (hasLeadIn->IsChecked() && leadIn) {
-		for (size_t i = 0; i < sorted.size(); ++i)
-			sorted[i]->Start = safe_time(sorted.rend() - i, sorted.rend(),
-				sorted[i], sorted[i]->Start - leadIn,
-				&AssDialogue::End, &std::max<int>);
-	}
-
-	if (hasLeadOut->IsChecked() && leadOut) {
-		for (size_t i = 0; i < sorted.size(); ++i)
-			sorted[i]->End = safe_time(sorted.begin() + i + 1, sorted.end(),
-				sorted[i], sorted[i]->End + leadOut,
-				&AssDialogue::Start, &std::min<int>);
+	if (auto line = GetProcessor().FindInvalidLine(GetEnabledStyles())) {
+		wxMessageBox(
+			fmt_tl("One of the lines in the file (%i) has negative duration. Aborting.", line->Row),
+			_("Invalid script"),
+			wxOK | wxICON_ERROR | wxCENTER);
+		return;
 	}
 
-	// Make adjacent
-	if (adjsEnable->IsChecked()) {
-		double bias = adjacentBias->GetValue() / 100.0;
-
-		for (size_t i = 1; i < sorted.size(); ++i) {
-			AssDialogue *prev = sorted[i - 1];
-			AssDialogue *cur = sorted[i];
-
-			int dist = cur->Start - prev->End;
-			if ((dist < 0 && -dist <= adjOverlap) || (dist > 0 && dist <= adjGap)) {
-				int setPos = prev->End + int(dist * bias);
-				cur->Start = setPos;
-				prev->End = setPos;
-			}
-		}
-	}
+	auto changes = GetChanges();
+	if (changes.empty()) return;
 
-	// Keyframe snapping
-	if (keysEnable->IsChecked()) {
-		std::vector<int> kf = c->project->Keyframes();
-		auto fps = c->project->Timecodes();
-		if (auto provider = c->project->VideoProvider())
-			kf.push_back(provider->GetFrameCount() - 1);
-
-		for (AssDialogue *cur : sorted) {
-			// Get start/end frames
-			int startF = fps.FrameAtTime(cur->Start, agi::vfr::START);
-			int endF = fps.FrameAtTime(cur->End, agi::vfr::END);
-
-			// Get closest for start
-			int closest = get_closest_kf(kf, startF);
-			int time = fps.TimeAtFrame(closest, agi::vfr::START);
-			if ((closest > startF && time - cur->Start <= beforeStart) || (closest < startF && cur->Start - time <= afterStart))
-				cur->Start = time;
-
-			// Get closest for end
-			closest = get_closest_kf(kf, endF) - 1;
-			time = fps.TimeAtFrame(closest, agi::vfr::END);
-			if ((closest > endF && time - cur->End <= beforeEnd) || (closest < endF && cur->End - time <= afterEnd))
-				cur->End = time;
-		}
+	for (auto const& change : changes) {
+		change.line->Start = change.start;
+		change.line->End = change.end;
 	}
 
 	c->ass->Commit(_("timing processor"), AssFile::COMMIT_DIAG_TIME);
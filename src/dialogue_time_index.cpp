@@ -0,0 +1,133 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "dialogue_time_index.h"
+
+#include "ass_dialogue.h"
+#include "ass_file.h"
+#include "include/aegisub/context.h"
+
+#include <algorithm>
+#include <limits>
+
+DialogueTimeIndex::DialogueTimeIndex(agi::Context *c)
+: context(c)
+, pre_commit_listener(c->ass->AddPreCommitListener(&DialogueTimeIndex::OnPreCommit, this))
+{
+}
+
+void DialogueTimeIndex::OnPreCommit(int type, const AssDialogue *single_line) {
+	if (dirty) return;
+
+	if (type == AssFile::COMMIT_NEW || (type & AssFile::COMMIT_DIAG_ADDREM))
+		dirty = true;
+	else if (type & AssFile::COMMIT_DIAG_TIME)
+		dirty = !single_line || !tree.Retime(single_line);
+}
+
+std::vector<AssDialogue *> DialogueTimeIndex::LinesOverlapping(int start, int end) {
+	if (dirty) {
+		tree.Assign(context->ass->Events);
+		dirty = false;
+	}
+	return tree.LinesOverlapping(start, end);
+}
+
+void LineTimeTree::Build() {
+	std::stable_sort(begin(entries), end(entries), [](Entry const& a, Entry const& b) {
+		return a.start < b.start;
+	});
+
+	positions.clear();
+	for (size_t i = 0; i < entries.size(); ++i)
+		positions[entries[i].line] = i;
+
+	leaves = 1;
+	while (leaves < entries.size())
+		leaves *= 2;
+
+	max_end.assign(leaves * 2, std::numeric_limits<int>::min());
+	for (size_t i = 0; i < entries.size(); ++i)
+		max_end[leaves + i] = entries[i].end;
+	for (size_t i = leaves - 1; i > 0; --i)
+		max_end[i] = std::max(max_end[i * 2], max_end[i * 2 + 1]);
+}
+
+bool LineTimeTree::Retime(const AssDialogue *line) {
+	auto it = positions.find(line);
+	if (it == positions.end()) return false;
+
+	size_t old_pos = it->second;
+	Entry entry{line->Start, line->End, entries[old_pos].line};
+
+	// Find where the entry goes once it's taken out of the list, after any
+	// other lines with the same start time
+	auto first = begin(entries);
+	auto by_start = [](int time, Entry const& e) { return time < e.start; };
+	size_t new_pos;
+	if (old_pos > 0 && entry.start < entries[old_pos - 1].start)
+		new_pos = std::upper_bound(first, first + old_pos, entry.start, by_start) - first;
+	else
+		new_pos = std::upper_bound(first + old_pos + 1, end(entries), entry.start, by_start) - first - 1;
+
+	entries[old_pos] = entry;
+	if (new_pos < old_pos)
+		std::rotate(first + new_pos, first + old_pos, first + old_pos + 1);
+	else if (new_pos > old_pos)
+		std::rotate(first + old_pos, first + old_pos + 1, first + new_pos + 1);
+
+	// Only the entries which moved and their parents need updating
+	size_t lo = std::min(old_pos, new_pos);
+	size_t hi = std::max(old_pos, new_pos);
+	for (size_t i = lo; i <= hi; ++i) {
+		positions[entries[i].line] = i;
+		max_end[leaves + i] = entries[i].end;
+	}
+	for (lo = (leaves + lo) / 2, hi = (leaves + hi) / 2; lo > 0; lo /= 2, hi /= 2) {
+		for (size_t node = lo; node <= hi; ++node)
+			max_end[node] = std::max(max_end[node * 2], max_end[node * 2 + 1]);
+	}
+	return true;
+}
+
+void LineTimeTree::Query(size_t node, size_t first, size_t last, size_t limit, int start, std::vector<AssDialogue *> &out) const {
+	// Skip subtrees which are entirely past the end of the range or where
+	// every line ends before the start of it
+	if (first >= limit || max_end[node] <= start)
+		return;
+
+	if (node >= leaves) {
+		out.push_back(entries[node - leaves].line);
+		return;
+	}
+
+	size_t mid = (first + last) / 2;
+	Query(node * 2, first, mid, limit, start, out);
+	Query(node * 2 + 1, mid, last, limit, start, out);
+}
+
+std::vector<AssDialogue *> LineTimeTree::LinesOverlapping(int start, int end) const {
+	std::vector<AssDialogue *> ret;
+	if (entries.empty()) return ret;
+
+	// Only lines which start before the end of the range can overlap it
+	size_t limit = std::lower_bound(begin(entries), std::end(entries), end, [](Entry const& e, int time) {
+		return e.start < time;
+	}) - begin(entries);
+
+	Query(1, 0, leaves, limit, start, ret);
+	return ret;
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#pragma once
+
+#include <libaegisub/signal.h>
+
+#include <unordered_map>
+#include <vector>
+
+class AssDialogue;
+namespace agi { struct Context; }
+
+/// @class LineTimeTree
+/// @brief Dialogue lines sorted by start time with the latest end time of
+///        each range of them, for finding the lines which overlap a time
+class LineTimeTree {
+	struct Entry {
+		int start;
+		int end;
+		AssDialogue *line;
+	};
+
+	/// Lines sorted by start time
+	std::vector<Entry> entries;
+	/// Index in entries of each line
+	std::unordered_map<const AssDialogue *, size_t> positions;
+	/// Implicit binary tree over entries where each node holds the latest end
+	/// time of the entries below it
+	std::vector<int> max_end;
+	/// Number of leaves in the tree; entries.size() rounded up to a power of two
+	size_t leaves = 0;
+
+	void Query(size_t node, size_t first, size_t last, size_t limit, int start, std::vector<AssDialogue *> &out) const;
+
+public:
+	/// Replace the contents of the tree with the given lines
+	template<typename Range>
+	void Assign(Range&& lines) {
+		entries.clear();
+		for (auto& line : lines)
+			entries.push_back(Entry{line.Start, line.End, &line});
+		Build();
+	}
+
+	/// Sort the entries and rebuild the tree over them
+	void Build();
+
+	/// Update a line's entry for its current times
+	///
+	/// This only touches the entries between the line's old and new positions
+	/// and their parents in the tree, so retiming a line by a small amount is
+	/// O(log n).
+	/// @return false if the line isn't in the tree
+	bool Retime(const AssDialogue *line);
+
+	/// Get all lines which overlap the time range [start, end), in order of
+	/// start time
+	std::vector<AssDialogue *> LinesOverlapping(int start, int end) const;
+};
+
+/// @class DialogueTimeIndex
+/// @brief Index of the dialogue lines in a file by time
+///
+/// Finding the lines which are visible at a given time otherwise requires
+/// checking every line in the file, which adds up when it's done for every
+/// frame during playback on large scripts. This keeps a LineTimeTree of the
+/// file's lines, so that overlap queries only have to look at the lines
+/// which can actually match.
+///
+/// The index is rebuilt lazily on the first query after a commit which may
+/// have changed the set of lines or their times, and updated in place for
+/// commits which retime only a single line. As with the fold information,
+/// results are only valid directly after a commit.
+class DialogueTimeIndex {
+	agi::Context *context;
+	agi::signal::Connection pre_commit_listener;
+
+	LineTimeTree tree;
+	/// Does the index need to be rebuilt before it can be used?
+	bool dirty = true;
+
+	void OnPreCommit(int type, const AssDialogue *single_line);
+
+public:
+	DialogueTimeIndex(agi::Context *context);
+
+	/// Get all lines which overlap the time range [start, end), in order of
+	/// start time
+	std::vector<AssDialogue *> LinesOverlapping(int start, int end);
+};
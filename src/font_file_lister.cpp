@@ -22,10 +22,12 @@
 #include "compat.h"
 #include "format.h"
 
+#include <libaegisub/dispatch.h>
 #include <libaegisub/format_flyweight.h>
 #include <libaegisub/format_path.h>
 
 #include <algorithm>
+#include <mutex>
 #include <tuple>
 #include <unicode/uchar.h>
 #include <wx/intl.h>
@@ -59,13 +61,12 @@ FontCollector::FontCollector(FontCollectorStatusCallback status_callback)
 {
 }
 
-void FontCollector::ProcessDialogueLine(const AssDialogue *line, int index) {
+void FontCollector::ProcessDialogueLine(const AssDialogue *line, int index, ScanResult &result, ParsedTagsCache &parsed_tags) const {
 	if (line->Comment) return;
 
 	auto style_it = styles.find(line->Style);
 	if (style_it == end(styles)) {
-		status_callback(fmt_tl("Style '%s' does not exist\n", line->Style), 2);
-		++missing;
+		result.missing_styles.push_back(line->Style);
 		return;
 	}
 
@@ -74,12 +75,14 @@ void FontCollector::ProcessDialogueLine(const AssDialogue *line, int index) {
 
 	bool overriden = false;
 
-	for (auto& block : line->ParseTags()) {
+	auto blocks = line->GetParsedTags(parsed_tags);
+	for (auto& block : *blocks) {
 		switch (block->GetType()) {
 		case AssBlockType::OVERRIDE:
 			for (auto const& tag : static_cast<AssDialogueBlockOverride&>(*block).Tags) {
 				if (tag.Name == "\\r") {
-					style = styles[tag.Params[0].Get(line->Style.get())];
+					auto it = styles.find(tag.Params[0].Get(line->Style.get()));
+					style = it == end(styles) ? StyleInfo() : it->second;
 					overriden = false;
 				}
 				else if (tag.Name == "\\b") {
@@ -102,7 +105,7 @@ void FontCollector::ProcessDialogueLine(const AssDialogue *line, int index) {
 			if (text.empty())
 				continue;
 
-			auto& usage = used_styles[style];
+			auto& usage = result.used_styles[style];
 
 			if (overriden) {
 				auto& lines = usage.lines;
@@ -133,13 +136,10 @@ void FontCollector::ProcessDialogueLine(const AssDialogue *line, int index) {
 				U8_NEXT(&text[0], i, size, c);
 				chars.push_back(c);
 			}
-
-			sort(begin(chars), end(chars));
-			chars.erase(unique(chars.begin(), chars.end()), chars.end());
 			break;
 		}
 		case AssBlockType::DRAWING:
-			used_styles[style].drawing = true;
+			result.used_styles[style].drawing = true;
 			break;
 		case AssBlockType::COMMENT:
 			break;
@@ -147,22 +147,33 @@ void FontCollector::ProcessDialogueLine(const AssDialogue *line, int index) {
 	}
 }
 
-void FontCollector::ProcessChunk(std::pair<StyleInfo, UsageData> const& style) {
+void FontCollector::MergeScanResult(ScanResult &result) {
+	for (auto const& name : result.missing_styles)
+		status_callback(fmt_tl("Style '%s' does not exist\n", name), 2);
+	missing += result.missing_styles.size();
+
+	for (auto& style : result.used_styles) {
+		auto& usage = used_styles[style.first];
+		usage.chars.insert(usage.chars.end(), style.second.chars.begin(), style.second.chars.end());
+		usage.lines.insert(usage.lines.end(), style.second.lines.begin(), style.second.lines.end());
+		usage.drawing = usage.drawing || style.second.drawing;
+	}
+}
+
+void FontCollector::ProcessChunk(std::pair<const StyleInfo, UsageData> const& style, CollectionResult const& res) {
 	if (style.second.chars.empty() && !style.second.drawing) return;
 
 	if (style.second.chars.empty() && style.second.drawing) {
 		status_callback(fmt_tl("Font '%s' is used in a drawing, but not in any text.\n", style.first.facename), 3);
 	}
 
-	auto res = lister.GetFontPaths(style.first.facename, style.first.bold, style.first.italic, style.second.chars);
-
 	if (res.paths.empty()) {
 		status_callback(fmt_tl("Could not find font '%s'\n", style.first.facename), 2);
 		PrintUsage(style.second);
 		++missing;
 	}
 	else {
-		for (auto& elem : res.paths) {
+		for (auto elem : res.paths) {
 			elem.make_preferred();
 			if (std::find(begin(results), end(results), elem) == end(results)) {
 				status_callback(fmt_tl("Found '%s' at '%s'\n", style.first.facename, elem), 0);
@@ -204,11 +215,9 @@ void FontCollector::PrintUsage(UsageData const& data) {
 	status_callback("\n", 2);
 }
 
-std::vector<agi::fs::path> FontCollector::GetFontPaths(const AssFile *file) {
-	missing = 0;
-	missing_glyphs = 0;
-
-	status_callback(_("Parsing file\n"), 0);
+void FontCollector::ScanFile(const AssFile *file) {
+	styles.clear();
+	used_styles.clear();
 
 	for (auto const& style : file->Styles) {
 		StyleInfo &info = styles[style.name];
@@ -218,12 +227,124 @@ std::vector<agi::fs::path> FontCollector::GetFontPaths(const AssFile *file) {
 		used_styles[info].styles.push_back(style.name);
 	}
 
-	int index = 0;
+	std::vector<const AssDialogue *> lines;
+	lines.reserve(file->Events.size());
 	for (auto const& diag : file->Events)
-		ProcessDialogueLine(&diag, ++index);
+		lines.push_back(&diag);
+
+	// Scan ranges of lines in parallel, then merge them in order so that the
+	// line numbers and messages come out the same as a serial scan
+	std::mutex scan_mutex;
+	std::vector<std::pair<size_t, ScanResult>> scanned;
+	agi::dispatch::ParallelFor(lines.size(), 1000, [&](size_t begin, size_t end) {
+		ScanResult result;
+		ParsedTagsCache parsed_tags;
+		for (size_t i = begin; i < end; ++i)
+			ProcessDialogueLine(lines[i], i + 1, result, parsed_tags);
+		for (auto& style : result.used_styles) {
+			auto& chars = style.second.chars;
+			sort(chars.begin(), chars.end());
+			chars.erase(unique(chars.begin(), chars.end()), chars.end());
+		}
+
+		std::lock_guard<std::mutex> lock(scan_mutex);
+		scanned.emplace_back(begin, std::move(result));
+	});
+
+	sort(scanned.begin(), scanned.end(), [](std::pair<size_t, ScanResult> const& a, std::pair<size_t, ScanResult> const& b) {
+		return a.first < b.first;
+	});
+	for (auto& chunk : scanned)
+		MergeScanResult(chunk.second);
+
+	for (auto& style : used_styles) {
+		auto& chars = style.second.chars;
+		sort(chars.begin(), chars.end());
+		chars.erase(unique(chars.begin(), chars.end()), chars.end());
+	}
+}
+
+std::vector<agi::fs::path> FontCollector::GetFontPaths(const AssFile *file) {
+	return GetFontPaths({{"", file}});
+}
+
+std::vector<agi::fs::path> FontCollector::GetFontPaths(std::vector<std::pair<std::string, const AssFile *>> const& files) {
+	missing = 0;
+	missing_glyphs = 0;
+
+	std::vector<std::map<StyleInfo, UsageData>> file_styles;
+	file_styles.reserve(files.size());
+	for (auto const& file : files) {
+		if (file.first.empty())
+			status_callback(_("Parsing file\n"), 0);
+		else
+			status_callback(fmt_tl("Parsing %s\n", file.first), 0);
+		ScanFile(file.second);
+		file_styles.push_back(std::move(used_styles));
+	}
+
+	// Look up each font once, checking for all of the glyphs used in any of
+	// the files
+	std::map<StyleInfo, size_t> font_index;
+	std::vector<StyleInfo> to_find;
+	std::vector<std::vector<int>> to_find_chars;
+	for (auto const& styles : file_styles) {
+		for (auto const& style : styles) {
+			if (style.second.chars.empty() && !style.second.drawing) continue;
+
+			auto it = font_index.emplace(style.first, to_find.size());
+			if (it.second) {
+				to_find.push_back(style.first);
+				to_find_chars.push_back(style.second.chars);
+				continue;
+			}
+
+			auto& chars = to_find_chars[it.first->second];
+			if (std::includes(chars.begin(), chars.end(), style.second.chars.begin(), style.second.chars.end()))
+				continue;
+			std::vector<int> merged;
+			merged.reserve(chars.size() + style.second.chars.size());
+			std::set_union(chars.begin(), chars.end(), style.second.chars.begin(), style.second.chars.end(), back_inserter(merged));
+			chars = std::move(merged);
+		}
+	}
 
 	status_callback(_("Searching for font files\n"), 0);
-	for (auto const& style : used_styles) ProcessChunk(style);
+	std::vector<CollectionResult> found(to_find.size());
+	agi::dispatch::ParallelFor(to_find.size(), FontFileLister::thread_safe ? 1 : to_find.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			found[i] = lister.GetFontPaths(to_find[i].facename, to_find[i].bold, to_find[i].italic, to_find_chars[i]);
+	});
+
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (files.size() > 1)
+			status_callback(fmt_tl("Fonts used by %s:\n", files[i].first), 0);
+
+		for (auto const& style : file_styles[i]) {
+			auto it = font_index.find(style.first);
+			if (it == font_index.end()) continue;
+
+			auto const& res = found[it->second];
+			if (files.size() == 1 || res.missing.empty()) {
+				ProcessChunk(style, res);
+				continue;
+			}
+
+			// Only report the missing glyphs which are used in this file
+			CollectionResult file_res = res;
+			file_res.missing.clear();
+			auto const& chars = style.second.chars;
+			std::string missing_chars = from_wx(res.missing);
+			auto size = static_cast<int>(missing_chars.size());
+			for (int j = 0; j < size; ) {
+				UChar32 c;
+				U8_NEXT(&missing_chars[0], j, size, c);
+				if (std::binary_search(chars.begin(), chars.end(), c))
+					file_res.missing += c;
+			}
+			ProcessChunk(style, file_res);
+		}
+	}
 	status_callback(_("Done\n\n"), 0);
 
 	std::vector<agi::fs::path> paths;
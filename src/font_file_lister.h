@@ -28,6 +28,7 @@
 
 class AssDialogue;
 class AssFile;
+class ParsedTagsCache;
 
 typedef std::function<void (wxString, int)> FontCollectorStatusCallback;
 
@@ -49,6 +50,9 @@ class GdiFontFileLister {
 	bool ProcessLogFont(LOGFONTW const& expected, LOGFONTW const& actual, std::vector<int> const& characters);
 
 public:
+	/// All lookups share a single DC, so they have to be done one at a time
+	static const bool thread_safe = false;
+
 	/// Constructor
 	/// @param cb Callback for status logging
 	GdiFontFileLister(FontCollectorStatusCallback &cb);
@@ -67,6 +71,8 @@ using FontFileLister = GdiFontFileLister;
 #elif defined(__APPLE__)
 
 struct CoreTextFontFileLister {
+	static const bool thread_safe = true;
+
 	CoreTextFontFileLister(FontCollectorStatusCallback &) {}
 
 	/// @brief Get the path to the font with the given styles
@@ -84,12 +90,21 @@ using FontFileLister = CoreTextFontFileLister;
 
 typedef struct _FcConfig FcConfig;
 typedef struct _FcFontSet FcFontSet;
+typedef struct _FcPattern FcPattern;
 
 /// @class FontConfigFontFileLister
 /// @brief fontconfig powered font lister
 class FontConfigFontFileLister {
 	agi::scoped_holder<FcConfig*> config;
 
+	/// Lowercase family and full names -> outline fonts with that name, with
+	/// application fonts before system fonts. The patterns are owned by the
+	/// config's font sets.
+	std::unordered_map<std::string, std::vector<FcPattern*>> index;
+
+	/// Add the outline fonts in a font set to the name index
+	void IndexFonts(FcFontSet *set);
+
 	/// @brief Case-insensitive match ASS/SSA font family against full name. (also known as "name for humans")
 	/// @param family font fullname
 	/// @param bold weight attribute
@@ -97,6 +112,10 @@ class FontConfigFontFileLister {
 	/// @return font set
 	FcFontSet *MatchFullname(const char *family, int weight, int slant);
 public:
+	/// The index is not modified after construction and fontconfig is safe
+	/// to query from multiple threads
+	static const bool thread_safe = true;
+
 	/// Constructor
 	/// @param cb Callback for status logging
 	FontConfigFontFileLister(FontCollectorStatusCallback &cb);
@@ -132,6 +151,13 @@ class FontCollector {
 		std::vector<std::string> styles; ///< ASS styles which use this style
 	};
 
+	/// Styles used by a contiguous range of lines
+	struct ScanResult {
+		std::map<StyleInfo, UsageData> used_styles;
+		/// Names of styles used by lines which do not exist
+		std::vector<std::string> missing_styles;
+	};
+
 	/// Message callback provider by caller
 	FontCollectorStatusCallback status_callback;
 
@@ -149,10 +175,19 @@ class FontCollector {
 	int missing_glyphs = 0;
 
 	/// Gather all of the unique styles with text on a line
-	void ProcessDialogueLine(const AssDialogue *line, int index);
+	///
+	/// This only reads the collector's state, so ranges of lines can be
+	/// scanned in parallel and merged afterwards.
+	void ProcessDialogueLine(const AssDialogue *line, int index, ScanResult &result, ParsedTagsCache &parsed_tags) const;
+
+	/// Merge the styles used by a range of lines into used_styles
+	void MergeScanResult(ScanResult &result);
+
+	/// Fill styles and used_styles with the styles used in a file
+	void ScanFile(const AssFile *file);
 
-	/// Get the font for a single style
-	void ProcessChunk(std::pair<StyleInfo, UsageData> const& style);
+	/// Report the font found for a single style
+	void ProcessChunk(std::pair<const StyleInfo, UsageData> const& style, CollectionResult const& res);
 
 	/// Print the lines and styles on which a missing font is used
 	void PrintUsage(UsageData const& data);
@@ -168,4 +203,12 @@ public:
 	/// @param status Callback function for messages
 	/// @return List of paths to fonts
 	std::vector<agi::fs::path> GetFontPaths(const AssFile *file);
+
+	/// @brief Get a list of the locations of all font files used in several files
+	///
+	/// Each font is only looked up once, checking for the glyphs used in any
+	/// of the files, and the results are then reported for each file.
+	/// @param files Display name and contents of each file
+	/// @return List of paths to fonts
+	std::vector<agi::fs::path> GetFontPaths(std::vector<std::pair<std::string, const AssFile *>> const& files);
 };
@@ -19,35 +19,22 @@
 #include <libaegisub/charset_conv_win.h>
 #include <libaegisub/log.h>
 
+#include <algorithm>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/filesystem/path.hpp>
 #include <fontconfig/fontconfig.h>
 #include <wx/intl.h>
 
 namespace {
-bool pattern_matches(FcPattern *pat, const char *field, std::string const& name) {
+void add_names(FcPattern *pat, const char *field, std::vector<std::string>& names) {
 	FcChar8 *str;
 	for (int i = 0; FcPatternGetString(pat, field, i, &str) == FcResultMatch; ++i) {
 		std::string sstr((char *)str);
 		boost::to_lower(sstr);
-		if (sstr == name)
-			return true;
+		if (std::find(names.begin(), names.end(), sstr) == names.end())
+			names.push_back(std::move(sstr));
 	}
-	return false;
 }
-
-void find_font(FcFontSet *src, FcFontSet *dst, std::string const& family) {
-	if (!src) return;
-
-	for (FcPattern *pat : boost::make_iterator_range(&src->fonts[0], &src->fonts[src->nfont])) {
-		int val;
-		if (FcPatternGetBool(pat, FC_OUTLINE, 0, &val) != FcResultMatch || val != FcTrue) continue;
-
-		if (pattern_matches(pat, FC_FULLNAME, family) || pattern_matches(pat, FC_FAMILY, family))
-			FcFontSetAdd(dst, FcPatternDuplicate(pat));
-	}
-}
-
 }
 
 FontConfigFontFileLister::FontConfigFontFileLister(FontCollectorStatusCallback &cb)
@@ -55,6 +42,26 @@ FontConfigFontFileLister::FontConfigFontFileLister(FontCollectorStatusCallback &
 {
 	cb(_("Updating font cache\n"), 0);
 	FcConfigBuildFonts(config);
+
+	cb(_("Indexing fonts\n"), 0);
+	IndexFonts(FcConfigGetFonts(config, FcSetApplication));
+	IndexFonts(FcConfigGetFonts(config, FcSetSystem));
+}
+
+void FontConfigFontFileLister::IndexFonts(FcFontSet *set) {
+	if (!set) return;
+
+	std::vector<std::string> names;
+	for (FcPattern *pat : boost::make_iterator_range(&set->fonts[0], &set->fonts[set->nfont])) {
+		FcBool val;
+		if (FcPatternGetBool(pat, FC_OUTLINE, 0, &val) != FcResultMatch || val != FcTrue) continue;
+
+		names.clear();
+		add_names(pat, FC_FULLNAME, names);
+		add_names(pat, FC_FAMILY, names);
+		for (auto& name : names)
+			index[name].push_back(pat);
+	}
 }
 
 CollectionResult FontConfigFontFileLister::GetFontPaths(std::string const& facename, int bold, bool italic, std::vector<int> const& characters) {
@@ -83,9 +90,15 @@ CollectionResult FontConfigFontFileLister::GetFontPaths(std::string const& facen
 	// This is needed because the patterns returned by font matching only
 	// include the first family and fullname, so we can't always verify that
 	// we got the actual font we were asking for after the fact
+	auto it = index.find(family);
+	if (it == index.end())
+		return ret;
+
 	agi::scoped_holder<FcFontSet*> fset(FcFontSetCreate(), FcFontSetDestroy);
-	find_font(FcConfigGetFonts(config, FcSetApplication), fset, family);
-	find_font(FcConfigGetFonts(config, FcSetSystem), fset, family);
+	for (FcPattern *font : it->second) {
+		FcPatternReference(font);
+		FcFontSetAdd(fset, font);
+	}
 
 	// Get the best match from fontconfig
 	FcResult result;
@@ -87,6 +87,27 @@ void GridColumn::UpdateWidth(const agi::Context *c, WidthHelper &helper) {
 		width = 10 + std::max(width, helper(Header()));
 }
 
+void GridColumn::UpdateWidthForLine(const AssDialogue *d, const agi::Context *c, WidthHelper &helper) {
+	if (!visible) return;
+
+	int line_width = LineWidth(d, c, helper);
+	if (line_width <= 0) return;
+
+	int new_width = 10 + std::max(line_width, helper(Header()));
+	if (new_width > width)
+		width = new_width;
+}
+
+void GridColumn::UpdateWidthForNewLines(std::vector<const AssDialogue *> const& lines, const agi::Context *c, WidthHelper &helper) {
+	if (!SizedByLines()) {
+		UpdateWidth(c, helper);
+		return;
+	}
+
+	for (auto line : lines)
+		UpdateWidthForLine(line, c, helper);
+}
+
 void GridColumn::Paint(wxDC &dc, int x, int y, const AssDialogue *d, const agi::Context *c) const {
 	wxString str = Value(d, c);
 	if (Centered())
@@ -184,6 +205,11 @@ struct GridColumnLayer final : GridColumn {
 		int max_layer = max_value(&AssDialogue::Layer, c->ass->Events);
 		return max_layer == 0 ? 0 : helper(std::to_wstring(max_layer));
 	}
+
+	bool SizedByLines() const override { return true; }
+	int LineWidth(const AssDialogue *d, const agi::Context *, WidthHelper &helper) const override {
+		return d->Layer == 0 ? 0 : helper(std::to_wstring(d->Layer));
+	}
 };
 
 struct GridColumnTime : GridColumn {
@@ -209,6 +235,13 @@ struct GridColumnStartTime final : GridColumnTime {
 		int frame = c->videoController->FrameAtTime(max_value(&AssDialogue::Start, c->ass->Events), agi::vfr::START);
 		return helper(std::to_wstring(frame));
 	}
+
+	bool SizedByLines() const override { return true; }
+	int LineWidth(const AssDialogue *d, const agi::Context *c, WidthHelper &helper) const override {
+		if (!by_frame)
+			return -1;
+		return helper(std::to_wstring(c->videoController->FrameAtTime(d->Start, agi::vfr::START)));
+	}
 };
 
 struct GridColumnEndTime final : GridColumnTime {
@@ -227,6 +260,13 @@ struct GridColumnEndTime final : GridColumnTime {
 		int frame = c->videoController->FrameAtTime(max_value(&AssDialogue::End, c->ass->Events), agi::vfr::END);
 		return helper(std::to_wstring(frame));
 	}
+
+	bool SizedByLines() const override { return true; }
+	int LineWidth(const AssDialogue *d, const agi::Context *c, WidthHelper &helper) const override {
+		if (!by_frame)
+			return -1;
+		return helper(std::to_wstring(c->videoController->FrameAtTime(d->End, agi::vfr::END)));
+	}
 };
 
 template<typename T>
@@ -254,6 +294,11 @@ struct GridColumnStyle final : GridColumn {
 	int Width(const agi::Context *c, WidthHelper &helper) const override {
 		return max_width(&AssDialogue::Style, c->ass->Events, helper);
 	}
+
+	bool SizedByLines() const override { return true; }
+	int LineWidth(const AssDialogue *d, const agi::Context *, WidthHelper &helper) const override {
+		return helper(d->Style);
+	}
 };
 
 struct GridColumnEffect final : GridColumn {
@@ -268,6 +313,11 @@ struct GridColumnEffect final : GridColumn {
 	int Width(const agi::Context *c, WidthHelper &helper) const override {
 		return max_width(&AssDialogue::Effect, c->ass->Events, helper);
 	}
+
+	bool SizedByLines() const override { return true; }
+	int LineWidth(const AssDialogue *d, const agi::Context *, WidthHelper &helper) const override {
+		return helper(d->Effect);
+	}
 };
 
 struct GridColumnActor final : GridColumn {
@@ -282,6 +332,11 @@ struct GridColumnActor final : GridColumn {
 	int Width(const agi::Context *c, WidthHelper &helper) const override {
 		return max_width(&AssDialogue::Actor, c->ass->Events, helper);
 	}
+
+	bool SizedByLines() const override { return true; }
+	int LineWidth(const AssDialogue *d, const agi::Context *, WidthHelper &helper) const override {
+		return helper(d->Actor);
+	}
 };
 
 struct GridColumnMargin : GridColumn {
@@ -302,6 +357,11 @@ struct GridColumnMargin : GridColumn {
 		}
 		return max == 0 ? 0 : helper(std::to_wstring(max));
 	}
+
+	bool SizedByLines() const override { return true; }
+	int LineWidth(const AssDialogue *d, const agi::Context *, WidthHelper &helper) const override {
+		return d->Margin[index] == 0 ? 0 : helper(std::to_wstring(d->Margin[index]));
+	}
 };
 
 struct GridColumnMarginLeft final : GridColumnMargin {
@@ -396,31 +456,21 @@ class GridColumnText final : public GridColumn {
 
 	agi::signal::Connection replace_char_connection;
 
-public:
-	GridColumnText()
-	: override_mode(OPT_GET("Subtitle/Grid/Hide Overrides"))
-	, replace_char(to_wx(OPT_GET("Subtitle/Grid/Hide Overrides Char")->GetString()))
-	, replace_char_connection(OPT_SUB("Subtitle/Grid/Hide Overrides Char",
-		[&](agi::OptionValue const& v) { replace_char = to_wx(v.GetString()); }))
-	{
-	}
-
-	COLUMN_HEADER(_("Text"))
-	COLUMN_DESCRIPTION(_("Text"))
-	bool Centered() const override { return false; }
-	bool CanHide() const override { return false; }
-	bool RefreshOnTextChange() const override { return true; }
+	/// Display strings for recently painted lines. Converting and stripping
+	/// the text is most of the cost of painting a row, and the same lines
+	/// are repainted over and over when scrolling or changing the selection.
+	mutable std::unordered_map<boost::flyweight<std::string>, wxString> cache;
+	/// Override display mode the cached strings were built for
+	mutable int cache_mode = -1;
 
-	wxString Value(const AssDialogue *d, const agi::Context *) const override {
+	wxString FormatText(std::string const& text, int mode) const {
 		wxString str;
-		int mode = override_mode->GetInt();
 
 		// Show overrides
 		if (mode == 0)
-			str = to_wx(d->Text);
+			str = to_wx(text);
 		// Hidden overrides
 		else {
-			auto const& text = d->Text.get();
 			str.reserve(text.size());
 			size_t start = 0, pos;
 			while ((pos = text.find('{', start)) != std::string::npos) {
@@ -440,6 +490,39 @@ public:
 		return str;
 	}
 
+public:
+	GridColumnText()
+	: override_mode(OPT_GET("Subtitle/Grid/Hide Overrides"))
+	, replace_char(to_wx(OPT_GET("Subtitle/Grid/Hide Overrides Char")->GetString()))
+	, replace_char_connection(OPT_SUB("Subtitle/Grid/Hide Overrides Char",
+		[&](agi::OptionValue const& v) { replace_char = to_wx(v.GetString()); cache.clear(); }))
+	{
+	}
+
+	COLUMN_HEADER(_("Text"))
+	COLUMN_DESCRIPTION(_("Text"))
+	bool Centered() const override { return false; }
+	bool CanHide() const override { return false; }
+	bool RefreshOnTextChange() const override { return true; }
+
+	wxString Value(const AssDialogue *d, const agi::Context *) const override {
+		int mode = override_mode->GetInt();
+		if (mode != cache_mode) {
+			cache.clear();
+			cache_mode = mode;
+		}
+
+		auto it = cache.find(d->Text);
+		if (it != cache.end())
+			return it->second;
+
+		// Only a screenful or so of lines are painted at a time, so there's
+		// no need to hold on to much more than that
+		if (cache.size() > 1000)
+			cache.clear();
+		return cache[d->Text] = FormatText(d->Text.get(), mode);
+	}
+
 	int Width(const agi::Context *c, WidthHelper &helper) const override {
 		return 5000;
 	}
@@ -58,6 +58,11 @@ protected:
 
 	virtual int Width(const agi::Context *c, WidthHelper &helper) const = 0;
 	virtual wxString Value(const AssDialogue *d, const agi::Context *c) const = 0;
+	/// Width needed to display just the given line, or -1 if the width of
+	/// the column doesn't depend on the metadata of individual lines
+	virtual int LineWidth(const AssDialogue *d, const agi::Context *c, WidthHelper &helper) const { return -1; }
+	/// Does this column implement LineWidth()?
+	virtual bool SizedByLines() const { return false; }
 
 public:
 	virtual ~GridColumn() = default;
@@ -77,6 +82,14 @@ public:
 	bool Visible() const { return visible; }
 
 	virtual void UpdateWidth(const agi::Context *c, WidthHelper &helper);
+	/// Widen the column if needed to fit a line whose metadata has changed.
+	/// This never shrinks the column; that waits for the next full update.
+	void UpdateWidthForLine(const AssDialogue *d, const agi::Context *c, WidthHelper &helper);
+	/// Update the width after lines were inserted or moved without any being
+	/// removed. Columns sized by their lines only measure the new ones, while
+	/// the rest are recalculated from scratch as they only depend on
+	/// file-wide values such as the number of lines.
+	void UpdateWidthForNewLines(std::vector<const AssDialogue *> const& lines, const agi::Context *c, WidthHelper &helper);
 	virtual void SetByFrame(bool /* by_frame */) { }
 	void SetVisible(bool new_value) { visible = new_value; }
 };
@@ -22,6 +22,7 @@ class AudioController;
 class AssDialogue;
 class AudioKaraoke;
 class DialogManager;
+class DialogueTimeIndex;
 class FrameMain;
 class Project;
 class SearchReplaceEngine;
@@ -49,6 +50,7 @@ struct Context {
 	std::unique_ptr<Automation4::ScriptManager> local_scripts;
 	std::unique_ptr<SelectionController> selectionController;
 	std::unique_ptr<FoldController> foldController;
+	std::unique_ptr<DialogueTimeIndex> timeIndex;
 	std::unique_ptr<VideoController> videoController;
 	std::unique_ptr<AudioController> audioController;
 	std::unique_ptr<InitialLineState> initialLineState;
@@ -19,10 +19,23 @@
 /// @ingroup main_headers spelling
 ///
 
+#include <functional>
 #include <memory>
 
 namespace agi { class SpellChecker; }
 
 struct SpellCheckerFactory {
+	/// Get a spell checker for the language set in the options
+	///
+	/// Results are cached in a cache shared by all of the spell checkers,
+	/// which is cleared when words are added or removed.
 	static std::unique_ptr<agi::SpellChecker> GetSpellChecker();
+
+	/// Get a function which creates spell checkers for the current language
+	/// which can be used on a background thread
+	///
+	/// The spell checkers do not follow changes to the language option and
+	/// words added to them are not saved.
+	/// @return The loader, or an empty function if the platform's spell checker can only be used on the main thread
+	static std::function<std::unique_ptr<agi::SpellChecker>()> GetBackgroundSpellCheckerLoader();
 };
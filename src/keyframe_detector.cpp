@@ -0,0 +1,130 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#include "keyframe_detector.h"
+
+#include "include/aegisub/video_provider.h"
+#include "video_frame.h"
+
+#include <libaegisub/background_runner.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+/// Smallest mean absolute difference between grid cells considered a cut
+const double min_difference = 10.0;
+/// Smallest fraction of the histogram which has to move for a cut
+const double min_histogram_change = 0.25;
+/// How much larger than the recent average difference a cut has to be
+const double difference_ratio = 2.5;
+/// Weight of each frame in the running average difference
+const double average_weight = 0.1;
+/// Minimum number of frames between scene changes
+const int min_scene_length = 5;
+}
+
+void SceneChangeDetector::Downscale(VideoFrame const& frame) {
+	const size_t width = frame.width, height = frame.height;
+	const unsigned char *data = frame.data.data();
+	hist.fill(0);
+
+	for (size_t gy = 0; gy < grid_height; ++gy) {
+		const size_t y0 = gy * height / grid_height;
+		const size_t y1 = std::max((gy + 1) * height / grid_height, y0 + 1);
+		// Only every other row is sampled, as there is far more detail in a
+		// frame than needed to spot a scene change
+		const size_t rows = (y1 - y0 + 1) / 2;
+
+		for (size_t gx = 0; gx < grid_width; ++gx) {
+			const size_t x0 = gx * width / grid_width;
+			const size_t x1 = std::max((gx + 1) * width / grid_width, x0 + 1);
+
+			uint32_t sum = 0;
+			for (size_t y = y0; y < y1; y += 2) {
+				// Frames are BGRX; the weights are BT.601 luma scaled by 256.
+				// Plain loop over a contiguous run so the compiler can
+				// vectorize it.
+				const unsigned char *px = data + y * frame.pitch + x0 * 4;
+				for (size_t x = x0; x < x1; ++x, px += 4)
+					sum += px[0] * 29u + px[1] * 150u + px[2] * 77u;
+			}
+
+			auto luma = static_cast<uint8_t>(sum / (rows * (x1 - x0) * 256));
+			grid[gy * grid_width + gx] = luma;
+			++hist[luma * histogram_bins / 256];
+		}
+	}
+}
+
+bool SceneChangeDetector::AddFrame(VideoFrame const& frame) {
+	Downscale(frame);
+
+	int frame_number = frame_count++;
+	bool scene_change = frame_number == 0;
+	if (frame_number > 0) {
+		unsigned total = 0;
+		for (size_t i = 0; i < grid.size(); ++i)
+			total += std::abs(grid[i] - prev_grid[i]);
+		double difference = double(total) / grid.size();
+
+		int moved = 0;
+		for (size_t i = 0; i < hist.size(); ++i)
+			moved += std::abs(hist[i] - prev_hist[i]);
+		double histogram_change = moved / (2.0 * grid.size());
+
+		if (average_difference < 0)
+			average_difference = difference;
+
+		scene_change = frame_number - last_scene_change >= min_scene_length
+			&& difference >= min_difference
+			&& histogram_change >= min_histogram_change
+			&& difference >= difference_ratio * average_difference;
+
+		// Cuts are left out of the average so that one doesn't raise the
+		// bar for the next
+		if (!scene_change)
+			average_difference += (difference - average_difference) * average_weight;
+	}
+
+	if (scene_change)
+		last_scene_change = frame_number;
+	std::swap(grid, prev_grid);
+	std::swap(hist, prev_hist);
+	return scene_change;
+}
+
+std::vector<int> DetectKeyframes(VideoProvider &provider, agi::ProgressSink *ps) {
+	std::vector<int> keyframes;
+	SceneChangeDetector detector;
+	VideoFrame frame;
+
+	const int frames = provider.GetFrameCount();
+	for (int i = 0; i < frames; ++i) {
+		if (ps->IsCancelled())
+			return {};
+		if (i % 16 == 0)
+			ps->SetProgress(i, frames);
+
+		provider.GetFrame(i, frame);
+		if (detector.AddFrame(frame))
+			keyframes.push_back(i);
+	}
+
+	ps->SetProgress(frames, frames);
+	return keyframes;
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class VideoProvider;
+struct VideoFrame;
+namespace agi { class ProgressSink; }
+
+/// @class SceneChangeDetector
+/// @brief Finds scene changes in a sequence of decoded frames
+///
+/// Each frame is reduced to a small grid of average luma values, which is
+/// compared to the previous frame's both directly (mean absolute difference)
+/// and as a histogram. A frame starts a new scene when both differences are
+/// large and the direct difference also stands out from the recent motion,
+/// so that fast pans don't turn into a keyframe every few frames.
+class SceneChangeDetector {
+public:
+	static const int grid_width = 64;
+	static const int grid_height = 36;
+	static const int histogram_bins = 32;
+
+private:
+	using Grid = std::array<uint8_t, grid_width * grid_height>;
+	using Histogram = std::array<int, histogram_bins>;
+
+	Grid prev_grid, grid;
+	Histogram prev_hist, hist;
+
+	/// Running average of the difference between consecutive frames
+	double average_difference = -1;
+	/// Number of frames added so far
+	int frame_count = 0;
+	int last_scene_change = 0;
+
+	void Downscale(VideoFrame const& frame);
+
+public:
+	/// Add the next frame of the video
+	/// @return Does this frame start a new scene?
+	bool AddFrame(VideoFrame const& frame);
+};
+
+/// Decode every frame of a video and find the scene changes
+/// @param provider Video to read. This is used from the calling thread only,
+///                 so it shouldn't be a provider which is in use elsewhere.
+/// @param ps Sink for progress updates and cancellation
+/// @return Frame numbers of the scene changes, or an empty vector if the
+///         task was cancelled
+std::vector<int> DetectKeyframes(VideoProvider &provider, agi::ProgressSink *ps);
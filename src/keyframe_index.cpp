@@ -0,0 +1,58 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#include "keyframe_index.h"
+
+#include <libaegisub/vfr.h>
+
+#include <algorithm>
+
+KeyframeIndex::KeyframeIndex(std::vector<int> keyframes, agi::vfr::Framerate const& fps)
+: frames(std::move(keyframes))
+{
+	std::sort(frames.begin(), frames.end());
+	frames.erase(std::unique(frames.begin(), frames.end()), frames.end());
+
+	if (frames.empty() || !fps.IsLoaded()) return;
+
+	start_times.resize(frames.size());
+	fps.TimesAtFrames(frames.data(), start_times.data(), frames.size(), agi::vfr::START);
+
+	end_times.resize(frames.size());
+	for (size_t i = 0; i < frames.size(); ++i)
+		end_times[i] = frames[i] - 1;
+	fps.TimesAtFrames(end_times.data(), end_times.data(), end_times.size(), agi::vfr::END);
+}
+
+size_t KeyframeIndex::FirstAtOrAfter(int frame) const {
+	return std::lower_bound(frames.begin(), frames.end(), frame) - frames.begin();
+}
+
+size_t KeyframeIndex::LastAtOrBefore(int frame) const {
+	size_t after = std::upper_bound(frames.begin(), frames.end(), frame) - frames.begin();
+	return after == 0 ? frames.size() : after - 1;
+}
+
+size_t KeyframeIndex::Closest(int frame) const {
+	if (frames.empty()) return 0;
+
+	size_t next = std::upper_bound(frames.begin(), frames.end(), frame) - frames.begin();
+	if (next == frames.size()) return next - 1;
+	if (next == 0) return 0;
+	// frames[next] is after the frame and frames[next - 1] is at or before it
+	return frames[next] - frame < frame - frames[next - 1] ? next : next - 1;
+}
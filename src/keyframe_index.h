@@ -0,0 +1,66 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace agi { namespace vfr { class Framerate; } }
+
+/// @class KeyframeIndex
+/// @brief Keyframes along with the times needed to snap lines to them
+///
+/// Snapping a line to a keyframe needs the keyframes around the line and the
+/// start or end time for each of them, which otherwise means a search of the
+/// keyframes plus several frame/time conversions per line. This precomputes
+/// the times for every keyframe, and is rebuilt by the project only when the
+/// keyframes or timecodes change.
+class KeyframeIndex {
+	/// Keyframe frame numbers, sorted
+	std::vector<int> frames;
+	/// Time a line has to start at to start on each keyframe
+	std::vector<int> start_times;
+	/// Time a line has to end at to end on the frame before each keyframe
+	std::vector<int> end_times;
+
+public:
+	KeyframeIndex() = default;
+
+	/// @param keyframes Keyframe frame numbers
+	/// @param fps Frame rate to calculate the times with. If it isn't loaded,
+	///            only the frame numbers are available.
+	KeyframeIndex(std::vector<int> keyframes, agi::vfr::Framerate const& fps);
+
+	bool empty() const { return frames.empty(); }
+	size_t size() const { return frames.size(); }
+	/// Have the times been calculated?
+	bool HasTimes() const { return !start_times.empty(); }
+
+	int Frame(size_t i) const { return frames[i]; }
+	int StartTime(size_t i) const { return start_times[i]; }
+	int EndTime(size_t i) const { return end_times[i]; }
+	std::vector<int> const& StartTimes() const { return start_times; }
+
+	/// Index of the first keyframe at or after the frame, or size() if there is none
+	size_t FirstAtOrAfter(int frame) const;
+	/// Index of the last keyframe at or before the frame, or size() if there is none
+	size_t LastAtOrBefore(int frame) const;
+	/// Index of the keyframe nearest to the frame, preferring the earlier one
+	/// when two are equally close, or size() if there are no keyframes
+	size_t Closest(int frame) const;
+};
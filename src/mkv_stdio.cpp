@@ -0,0 +1,133 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "mkv_stdio.h"
+
+#include <libaegisub/exception.h>
+
+#include <algorithm>
+#include <boost/lexical_cast.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+MkvStdIO::MkvStdIO(agi::fs::path const& filename) : file(filename) {
+	read = &MkvStdIO::Read;
+	scan = &MkvStdIO::Scan;
+	getcachesize = [](InputStream *) -> unsigned int { return 16 * 1024 * 1024; };
+	geterror = [](InputStream *st) -> const char * { return ((MkvStdIO *)st)->error.c_str(); };
+	memalloc = [](InputStream *, size_t size) { return malloc(size); };
+	memrealloc = [](InputStream *, void *mem, size_t size) { return realloc(mem, size); };
+	memfree = [](InputStream *, void *mem) { free(mem); };
+	progress = [](InputStream *, uint64_t, uint64_t) { return 1; };
+	getfilesize = &MkvStdIO::Size;
+}
+
+int MkvStdIO::Read(InputStream *st, uint64_t pos, void *buffer, int count) {
+	auto *self = static_cast<MkvStdIO*>(st);
+	if (pos >= self->file.size())
+		return 0;
+
+	auto remaining = self->file.size() - pos;
+	if (remaining < INT_MAX)
+		count = std::min(static_cast<int>(remaining), count);
+
+	try {
+		memcpy(buffer, self->file.read(pos, count), count);
+	}
+	catch (agi::Exception const& e) {
+		self->error = e.GetMessage();
+		return -1;
+	}
+
+	return count;
+}
+
+int64_t MkvStdIO::Scan(InputStream *st, uint64_t start, unsigned signature) {
+	auto *self = static_cast<MkvStdIO*>(st);
+	const char sig[4] = {
+		static_cast<char>(signature >> 24), static_cast<char>(signature >> 16),
+		static_cast<char>(signature >> 8), static_cast<char>(signature)
+	};
+	const uint64_t size = self->file.size();
+
+	try {
+		// Search a window at a time with memchr rather than going through
+		// the mapping for every byte. The windows overlap by three bytes so
+		// that signatures which straddle two of them are still found.
+		uint64_t pos = start;
+		while (pos + 4 <= size) {
+			auto window = std::min<uint64_t>(size - pos, 1 << 20);
+			const char *buf = self->file.read(pos, window);
+			const char *end = buf + window - 3;
+			for (const char *p = buf; (p = static_cast<const char *>(memchr(p, sig[0], end - p))); ++p) {
+				if (memcmp(p, sig, 4) == 0)
+					return pos + (p - buf);
+			}
+			pos += window - 3;
+		}
+	}
+	catch (agi::Exception const& e) {
+		self->error = e.GetMessage();
+	}
+
+	return -1;
+}
+
+int64_t MkvStdIO::Size(InputStream *st) {
+	return static_cast<MkvStdIO*>(st)->file.size();
+}
+
+bool MkvSsaBlockToLine(const char *begin, const char *end, agi::Time start, agi::Time end_time, std::string& line, int& read_order) {
+	using str_range = boost::iterator_range<const char *>;
+
+	auto first = std::find(begin, end, ',');
+	if (first == end) return false;
+	auto second = std::find(first + 1, end, ',');
+	if (second == end) return false;
+
+	line.reserve(end - second + 40);
+	line = "Dialogue: ";
+	line += std::to_string(boost::lexical_cast<int>(str_range(first + 1, second)));
+	line += ',';
+	line += start.GetAssFormatted();
+	line += ',';
+	line += end_time.GetAssFormatted();
+	line.append(second, end);
+
+	read_order = boost::lexical_cast<int>(str_range(begin, first));
+	return true;
+}
+
+void MkvSrtBlockToLine(const char *begin, const char *end, agi::Time start, agi::Time end_time, std::string& line) {
+	line = "Dialogue: 0,";
+	line += start.GetAssFormatted();
+	line += ',';
+	line += end_time.GetAssFormatted();
+	line += ",Default,,0,0,0,,";
+	for (auto p = begin; p != end; ++p) {
+		if (*p == '\r') {
+			line += "\\N";
+			if (p + 1 != end && p[1] == '\n')
+				++p;
+		}
+		else if (*p == '\n')
+			line += "\\N";
+		else
+			line += *p;
+	}
+}
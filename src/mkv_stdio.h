@@ -0,0 +1,61 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+/// @file mkv_stdio.h
+/// @brief Reading Matroska files and their subtitle blocks
+/// @ingroup video_input
+///
+/// The parts of mkv_wrap.cpp which don't need the GUI, so that they can be
+/// tested and benchmarked.
+
+#pragma once
+
+#include <cstddef> // MatroskaParser.h uses size_t without including anything for it
+
+#include "MatroskaParser.h"
+
+#include <libaegisub/ass/time.h>
+#include <libaegisub/file_mapping.h>
+#include <libaegisub/fs_fwd.h>
+
+#include <string>
+
+/// @class MkvStdIO
+/// @brief MatroskaParser input stream over a memory mapped file
+struct MkvStdIO final : InputStream {
+	agi::read_file_mapping file;
+	std::string error;
+
+	MkvStdIO(agi::fs::path const& filename);
+
+	static int Read(InputStream *st, uint64_t pos, void *buffer, int count);
+	/// Find the first four byte element ID at or after start, which the
+	/// parser uses to resync to the next cluster after a damaged one
+	/// @return Offset of the first byte of the ID, or -1 if there isn't one
+	static int64_t Scan(InputStream *st, uint64_t start, unsigned signature);
+	static int64_t Size(InputStream *st);
+};
+
+/// Build a dialogue line from an SSA/ASS block, which has every field of the
+/// line other than the times, preceded by the line's read order
+/// @param[out] line Receives the line, reusing its buffer
+/// @param[out] read_order Position of the line in the original file
+/// @return false if the block is malformed
+bool MkvSsaBlockToLine(const char *begin, const char *end, agi::Time start, agi::Time end_time, std::string& line, int& read_order);
+
+/// Build a dialogue line from an SRT block, which is just the line's text
+/// @param[out] line Receives the line, reusing its buffer
+void MkvSrtBlockToLine(const char *begin, const char *end, agi::Time start, agi::Time end_time, std::string& line);
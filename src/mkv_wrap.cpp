@@ -34,88 +34,38 @@
 
 #include "mkv_wrap.h"
 
+#include "ass_dialogue.h"
 #include "ass_file.h"
 #include "ass_parser.h"
 #include "compat.h"
 #include "dialog_progress.h"
 #include "MatroskaParser.h"
+#include "mkv_stdio.h"
 #include "options.h"
 
 #include <libaegisub/ass/time.h>
-#include <libaegisub/file_mapping.h>
+#include <libaegisub/dispatch.h>
 #include <libaegisub/format.h>
 #include <libaegisub/scoped_ptr.h>
 
 #include <algorithm>
-#include <boost/algorithm/string/replace.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/range/irange.hpp>
 #include <boost/tokenizer.hpp>
+#include <chrono>
 #include <iterator>
+#include <string>
 
 #include <wx/choicdlg.h> // Keep this last so wxUSE_CHOICEDLG is set.
 
-struct MkvStdIO final : InputStream {
-	agi::read_file_mapping file;
-	std::string error;
+typedef std::vector<std::pair<int, std::string>> SubtitleLines;
 
-	static int Read(InputStream *st, uint64_t pos, void *buffer, int count) {
-		auto *self = static_cast<MkvStdIO*>(st);
-		if (pos >= self->file.size())
-			return 0;
-
-		auto remaining = self->file.size() - pos;
-		if (remaining < INT_MAX)
-			count = std::min(static_cast<int>(remaining), count);
-
-		try {
-			memcpy(buffer, self->file.read(pos, count), count);
-		}
-		catch (agi::Exception const& e) {
-			self->error = e.GetMessage();
-			return -1;
-		}
-
-		return count;
-	}
-
-	static int64_t Scan(InputStream *st, uint64_t start, unsigned signature) {
-		auto *self = static_cast<MkvStdIO*>(st);
-		try {
-			unsigned cmp = 0;
-			for (auto i : boost::irange(start, self->file.size())) {
-				int c = *self->file.read(i, 1);
-				cmp = ((cmp << 8) | c) & 0xffffffff;
-				if (cmp == signature)
-					return i - 4;
-			}
-		}
-		catch (agi::Exception const& e) {
-			self->error = e.GetMessage();
-		}
-
-		return -1;
-	}
-
-	static int64_t Size(InputStream *st) {
-		return static_cast<MkvStdIO*>(st)->file.size();
-	}
-
-	MkvStdIO(agi::fs::path const& filename) : file(filename) {
-		read = &MkvStdIO::Read;
-		scan = &MkvStdIO::Scan;
-		getcachesize = [](InputStream *) -> unsigned int { return 16 * 1024 * 1024; };
-		geterror = [](InputStream *st) -> const char * { return ((MkvStdIO *)st)->error.c_str(); };
-		memalloc = [](InputStream *, size_t size) { return malloc(size); };
-		memrealloc = [](InputStream *, void *mem, size_t size) { return realloc(mem, size); };
-		memfree = [](InputStream *, void *mem) { free(mem); };
-		progress = [](InputStream *, uint64_t, uint64_t) { return 1; };
-		getfilesize = &MkvStdIO::Size;
-	}
-};
-
-static bool read_subtitles(agi::ProgressSink *ps, MatroskaFile *file, MkvStdIO *input, bool srt, double totalTime, AssParser *parser, CompressedStream *cs) {
-	std::vector<std::pair<int, std::string>> subList;
+/// Read the blocks of the selected track, passing each line to add_line along
+/// with its read order. SSA/ASS blocks carry their position in the original
+/// file, while SRT blocks are numbered in the order they were muxed. add_line
+/// may move from the line.
+static bool read_subtitles(agi::ProgressSink *ps, MatroskaFile *file, MkvStdIO *input, bool srt, double totalTime, CompressedStream *cs, std::function<void (int, std::string&)> const& add_line) {
+	std::string line;
+	int srt_order = 0;
 
 	// Load blocks
 	uint64_t startTime, endTime, filePos;
@@ -163,47 +113,85 @@ static bool read_subtitles(agi::ProgressSink *ps, MatroskaFile *file, MkvStdIO *
 		agi::Time subStart = startTime / timecodeScaleLow;
 		agi::Time subEnd = endTime / timecodeScaleLow;
 
-		using str_range = boost::iterator_range<const char *>;
-
 		// Process SSA/ASS
 		if (!srt) {
-			auto first = std::find(readBuf, readBufEnd, ',');
-			if (first == readBufEnd) continue;
-			auto second = std::find(first + 1, readBufEnd, ',');
-			if (second == readBufEnd) continue;
-
-			subList.emplace_back(
-				boost::lexical_cast<int>(str_range(readBuf, first)),
-				agi::format("Dialogue: %d,%s,%s,%s"
-					, boost::lexical_cast<int>(str_range(first + 1, second))
-					, subStart.GetAssFormatted()
-					, subEnd.GetAssFormatted()
-					, str_range(second + 1, readBufEnd)));
+			int order;
+			if (!MkvSsaBlockToLine(readBuf, readBufEnd, subStart, subEnd, line, order)) continue;
+			add_line(order, line);
+			line.clear();
 		}
 		// Process SRT
 		else {
-			auto line = agi::format("Dialogue: 0,%s,%s,Default,,0,0,0,,%s"
-				, subStart.GetAssFormatted()
-				, subEnd.GetAssFormatted()
-				, str_range(readBuf, readBufEnd));
-			boost::replace_all(line, "\r\n", "\\N");
-			boost::replace_all(line, "\r", "\\N");
-			boost::replace_all(line, "\n", "\\N");
-
-			subList.emplace_back(subList.size(), std::move(line));
+			MkvSrtBlockToLine(readBuf, readBufEnd, subStart, subEnd, line);
+			add_line(srt_order++, line);
 		}
 
 		ps->SetProgress(startTime / timecodeScaleLow, totalTime);
 	}
 
-	// Insert into file
-	sort(begin(subList), end(subList));
-	for (auto order_value_pair : subList)
-		parser->AddLine(order_value_pair.second);
 	return true;
 }
 
-void MatroskaWrapper::GetSubtitles(agi::fs::path const& filename, AssFile *target) {
+/// Sort lines by their read order if the blocks were muxed out of order
+/// @return Did the lines need sorting?
+template<typename T>
+static bool sort_by_read_order(std::vector<std::pair<int, T>>& lines) {
+	auto by_read_order = [](std::pair<int, T> const& a, std::pair<int, T> const& b) {
+		return a.first < b.first;
+	};
+	if (std::is_sorted(begin(lines), end(lines), by_read_order))
+		return false;
+	std::stable_sort(begin(lines), end(lines), by_read_order);
+	return true;
+}
+
+/// Read the whole track before adding any of it to the file
+static bool read_all_subtitles(agi::ProgressSink *ps, MatroskaFile *file, MkvStdIO *input, bool srt, double totalTime, CompressedStream *cs, AssParser *parser) {
+	SubtitleLines subList;
+	bool result = read_subtitles(ps, file, input, srt, totalTime, cs, [&](int order, std::string& line) {
+		// SRT blocks are always in order and can go straight to the parser
+		if (srt)
+			parser->AddLine(line);
+		else
+			subList.emplace_back(order, std::move(line));
+	});
+
+	sort_by_read_order(subList);
+	for (auto const& order_value_pair : subList)
+		parser->AddLine(order_value_pair.second);
+	return result;
+}
+
+/// Read the track, handing the lines to the main thread to be added to the
+/// file in batches as they are read
+static bool stream_subtitles(agi::ProgressSink *ps, MatroskaFile *file, MkvStdIO *input, bool srt, double totalTime, CompressedStream *cs, std::function<void (SubtitleLines)> const& add_lines) {
+	using namespace std::chrono;
+	SubtitleLines batch;
+	size_t handed_over = 0;
+	auto last_batch = steady_clock::now();
+
+	bool result = read_subtitles(ps, file, input, srt, totalTime, cs, [&](int order, std::string& line) {
+		batch.emplace_back(order, std::move(line));
+		// Hand over lines often enough that the grid fills in smoothly, but
+		// not so often that the main thread spends all its time committing.
+		// Each batch's commit does work proportional to the whole file so
+		// far, so batches grow along with it to keep the total linear.
+		if (batch.size() < handed_over / 4) return;
+		auto now = steady_clock::now();
+		if (now - last_batch > milliseconds(100)) {
+			handed_over += batch.size();
+			add_lines(std::move(batch));
+			batch.clear();
+			last_batch = now;
+		}
+	});
+
+	if (!batch.empty())
+		add_lines(std::move(batch));
+	return result;
+}
+
+void MatroskaWrapper::GetSubtitles(agi::fs::path const& filename, AssFile *target, std::function<void ()> const& on_lines) {
 	MkvStdIO input(filename);
 	char err[2048];
 	agi::scoped_holder<MatroskaFile*, decltype(&mkv_Close)> file(mkv_Open(&input, err, sizeof(err)), mkv_Close);
@@ -287,11 +275,41 @@ void MatroskaWrapper::GetSubtitles(agi::fs::path const& filename, AssFile *targe
 	// Progress bar
 	auto totalTime = double(segInfo->Duration) / timecodeScale;
 	DialogProgress progress(nullptr, _("Parsing Matroska"), _("Reading subtitles from Matroska file."));
-	bool result;
-	progress.Run([&](agi::ProgressSink *ps) { result = read_subtitles(ps, file, &input, srt, totalTime, &parser, cs); });
+	bool result = false;
+	if (!on_lines) {
+		progress.Run([&](agi::ProgressSink *ps) { result = read_all_subtitles(ps, file, &input, srt, totalTime, cs, &parser); });
+		if (!result)
+			throw MatroskaException("Failed to read subtitles");
+		return;
+	}
+
+	// target may be the open file, so lines are only added to it on the main
+	// thread. The dialog closes from a call queued after the last batch, so
+	// all of the batches have been added by the time Run returns.
+	std::vector<std::pair<int, AssDialogue *>> read_order;
+	progress.Run([&](agi::ProgressSink *ps) {
+		result = stream_subtitles(ps, file, &input, srt, totalTime, cs, [&](SubtitleLines batch) {
+			agi::dispatch::Main().Async([&, batch = std::move(batch)] {
+				for (auto const& line : batch) {
+					auto diag = new AssDialogue(line.second);
+					target->Events.push_back(*diag);
+					read_order.emplace_back(line.first, diag);
+				}
+				on_lines();
+			});
+		});
+	});
 
 	if (!result)
 		throw MatroskaException("Failed to read subtitles");
+
+	// Lines were added in the order they were muxed, which may not be the
+	// order of the original file
+	if (sort_by_read_order(read_order)) {
+		target->Events.clear();
+		for (auto const& line : read_order)
+			target->Events.push_back(*line.second);
+	}
 }
 
 bool MatroskaWrapper::HasSubtitles(agi::fs::path const& filename) {
@@ -22,6 +22,8 @@
 #include <libaegisub/exception.h>
 #include <libaegisub/fs_fwd.h>
 
+#include <functional>
+
 DEFINE_EXCEPTION(MatroskaException, agi::Exception);
 
 class AssFile;
@@ -31,5 +33,9 @@ public:
 	/// Check if the file is a matroska file with at least one subtitle track
 	static bool HasSubtitles(agi::fs::path const& filename);
 	/// Load subtitles from a matroska file
-	static void GetSubtitles(agi::fs::path const& filename, AssFile *target);
+	/// @param on_lines If set, the events are appended to target on the main
+	///                 thread in batches while the track is read and this is
+	///                 called after each batch. The lines may be reordered
+	///                 once the whole track has been read.
+	static void GetSubtitles(agi::fs::path const& filename, AssFile *target, std::function<void ()> const& on_lines = nullptr);
 };
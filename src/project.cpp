@@ -270,6 +270,7 @@ void Project::DoLoadAudio(agi::fs::path const& path, bool quiet) {
 	}
 
 	SetPath(audio_file, "?audio", "Audio", path);
+	++version;
 	AnnounceAudioProviderModified(audio_provider.get());
 }
 
@@ -278,6 +279,7 @@ void Project::LoadAudio(agi::fs::path path) {
 }
 
 void Project::CloseAudio() {
+	++version;
 	AnnounceAudioProviderModified(nullptr);
 	audio_provider.reset();
 	SetPath(audio_file, "?audio", "", "");
@@ -322,6 +324,7 @@ bool Project::DoLoadVideo(agi::fs::path const& path) {
 	if (agi::fs::HasExtension(path, "mkv"))
 		video_has_subtitles = MatroskaWrapper::HasSubtitles(path);
 
+	UpdateKeyframeIndex();
 	AnnounceKeyframesModified(keyframes);
 	AnnounceTimecodesModified(timecodes);
 	return true;
@@ -342,6 +345,7 @@ void Project::LoadVideo(agi::fs::path path) {
 }
 
 void Project::CloseVideo() {
+	++version;
 	AnnounceVideoProviderModified(nullptr);
 	video_provider.reset();
 	SetPath(video_file, "?video", "", "");
@@ -354,6 +358,7 @@ void Project::CloseVideo() {
 void Project::DoLoadTimecodes(agi::fs::path const& path) {
 	timecodes = agi::vfr::Framerate(path);
 	SetPath(timecodes_file, "", "Timecodes", path);
+	UpdateKeyframeIndex();
 	AnnounceTimecodesModified(timecodes);
 }
 
@@ -374,12 +379,14 @@ void Project::LoadTimecodes(agi::fs::path path) {
 void Project::CloseTimecodes() {
 	timecodes = video_provider ? video_provider->GetFPS() : agi::vfr::Framerate{};
 	SetPath(timecodes_file, "", "", "");
+	UpdateKeyframeIndex();
 	AnnounceTimecodesModified(timecodes);
 }
 
 void Project::DoLoadKeyframes(agi::fs::path const& path) {
 	keyframes = agi::keyframe::Load(path);
 	SetPath(keyframes_file, "", "Keyframes", path);
+	UpdateKeyframeIndex();
 	AnnounceKeyframesModified(keyframes);
 }
 
@@ -404,9 +411,16 @@ void Project::LoadKeyframes(agi::fs::path path) {
 void Project::CloseKeyframes() {
 	keyframes = video_provider ? video_provider->GetKeyFrames() : std::vector<int>{};
 	SetPath(keyframes_file, "", "", "");
+	UpdateKeyframeIndex();
 	AnnounceKeyframesModified(keyframes);
 }
 
+void Project::UpdateKeyframeIndex() {
+	// Called whenever the timecodes or keyframes change
+	++version;
+	keyframe_index = KeyframeIndex(keyframes, timecodes);
+}
+
 void Project::LoadList(std::vector<agi::fs::path> const& files) {
 	// Keep these lists sorted
 
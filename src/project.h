@@ -14,6 +14,8 @@
 //
 // Aegisub Project http://www.aegisub.org/
 
+#include "keyframe_index.h"
+
 #include <libaegisub/fs_fwd.h>
 #include <libaegisub/signal.h>
 #include <libaegisub/vfr.h>
@@ -34,6 +36,7 @@ class Project {
 	std::unique_ptr<AsyncVideoProvider> video_provider;
 	agi::vfr::Framerate timecodes;
 	std::vector<int> keyframes;
+	KeyframeIndex keyframe_index;
 
 	agi::fs::path audio_file;
 	agi::fs::path video_file;
@@ -46,6 +49,7 @@ class Project {
 	agi::signal::Signal<std::vector<int> const&> AnnounceKeyframesModified;
 
 	bool video_has_subtitles = false;
+	int version = 0; ///< Incremented whenever the loaded audio, video, timecodes or keyframes change
 	DialogProgress *progress = nullptr;
 	agi::Context *context = nullptr;
 
@@ -63,6 +67,9 @@ class Project {
 
 	void SetPath(agi::fs::path& var, const char *token, const char *mru, agi::fs::path const& value);
 
+	/// Rebuild the keyframe index after the keyframes or timecodes change
+	void UpdateKeyframeIndex();
+
 public:
 	Project(agi::Context *context);
 	~Project();
@@ -92,6 +99,12 @@ public:
 	void CloseKeyframes();
 	bool CanCloseKeyframes() const { return !keyframes_file.empty(); }
 	std::vector<int> const& Keyframes() const { return keyframes; }
+	/// Keyframes with their times under the current timecodes
+	KeyframeIndex const& IndexedKeyframes() const { return keyframe_index; }
+
+	/// Get a counter which changes whenever the audio, video, timecodes or
+	/// keyframes are loaded or closed
+	int GetVersion() const { return version; }
 
 	void LoadList(std::vector<agi::fs::path> const& files);
 
@@ -19,6 +19,7 @@
 #include "ass_dialogue.h"
 #include "ass_file.h"
 #include "ass_style.h"
+#include "flyweight_hash.h"
 #include "utils.h"
 
 #include <libaegisub/exception.h>
@@ -30,6 +31,7 @@
 #include <algorithm>
 #include <boost/algorithm/string/predicate.hpp>
 #include <cmath>
+#include <unordered_map>
 #include <wx/intl.h>
 
 enum {
@@ -156,24 +158,37 @@ namespace {
 			cur->Set<int>((cur->Get<int>() + shift) * resizer + 0.5);
 	}
 
-	void resample_line(resample_state *state, AssDialogue &diag) {
+	/// Resampled texts of the lines done so far, keyed on the original text
+	typedef std::unordered_map<boost::flyweight<std::string>, boost::flyweight<std::string>> resampled_texts;
+
+	void resample_line(resample_state *state, AssDialogue &diag, resampled_texts &done) {
 		if (diag.Comment && (boost::starts_with(diag.Effect.get(), "template") || boost::starts_with(diag.Effect.get(), "code")))
 			return;
 
-		auto blocks = diag.ParseTags();
+		// The blocks are edited in place, so each line needs its own copy
+		// rather than shared parsed blocks, but the result depends only on
+		// the text and can be reused for every line with the same text
+		auto it = done.find(diag.Text);
+		if (it != done.end())
+			diag.Text = it->second;
+		else {
+			auto original = diag.Text;
+			auto blocks = diag.ParseTags();
+
+			for (auto block : blocks | agi::of_type<AssDialogueBlockOverride>())
+				block->ProcessParameters(resample_tags, state);
 
-		for (auto block : blocks | agi::of_type<AssDialogueBlockOverride>())
-			block->ProcessParameters(resample_tags, state);
+			for (auto drawing : blocks | agi::of_type<AssDialogueBlockDrawing>())
+				drawing->text = transform_drawing(drawing->text, 0, 0, state->rx / state->ar, state->ry);
 
-		for (auto drawing : blocks | agi::of_type<AssDialogueBlockDrawing>())
-			drawing->text = transform_drawing(drawing->text, 0, 0, state->rx / state->ar, state->ry);
+			diag.UpdateText(blocks);
+			done.emplace(original, diag.Text);
+		}
 
 		for (size_t i = 0; i < 3; ++i) {
 			if (diag.Margin[i])
 				diag.Margin[i] = int((diag.Margin[i] + state->margin[i]) * (i < 2 ? state->rx : state->ry) + 0.5);
 		}
-
-		diag.UpdateText(blocks);
 	}
 
 	void resample_style(resample_state *state, AssStyle &style) {
@@ -278,8 +293,9 @@ void ResampleResolution(AssFile *ass, ResampleSettings settings) {
 
 	for (auto& line : ass->Styles)
 		resample_style(&state, line);
+	resampled_texts done;
 	for (auto& line : ass->Events)
-		resample_line(&state, line);
+		resample_line(&state, line, done);
 
 	ass->SetScriptInfo("PlayResX", std::to_string(settings.dest_x));
 	ass->SetScriptInfo("PlayResY", std::to_string(settings.dest_y));
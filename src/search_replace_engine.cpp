@@ -18,15 +18,21 @@
 
 #include "ass_dialogue.h"
 #include "ass_file.h"
+#include "flyweight_hash.h"
 #include "format.h"
 #include "include/aegisub/context.h"
 #include "selection_controller.h"
 #include "text_selection_controller.h"
 
+#include <libaegisub/dispatch.h>
 #include <libaegisub/exception.h>
+#include <libaegisub/make_unique.h>
 #include <libaegisub/util.h>
 
+#include <algorithm>
 #include <boost/locale/conversion.hpp>
+#include <numeric>
+#include <unordered_map>
 
 #include <wx/msgdlg.h>
 
@@ -44,26 +50,46 @@ auto get_dialogue_field(SearchReplaceSettings::Field field) -> decltype(&AssDial
 	throw agi::InternalError("Bad field for search");
 }
 
-std::string const& get_normalized(const AssDialogue *diag, decltype(&AssDialogueBase::Text) field) {
+/// Get the normalized value of a field, optionally storing it back into the
+/// line. Matching on other threads must not modify the lines.
+std::string get_normalized(const AssDialogue *diag, decltype(&AssDialogueBase::Text) field, bool update_line) {
 	auto& value = const_cast<AssDialogue*>(diag)->*field;
 	auto normalized = boost::locale::normalize(value.get());
-	if (normalized != value)
+	if (update_line && normalized != value)
 		value = normalized;
-	return value.get();
+	return normalized;
+}
+
+/// Normalize a field of each of the lines
+void normalize_lines(std::vector<AssDialogue *> const& lines, SearchReplaceSettings::Field f) {
+	auto field = get_dialogue_field(f);
+	std::vector<std::string> normalized(lines.size());
+	agi::dispatch::ParallelFor(lines.size(), 500, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			normalized[i] = boost::locale::normalize((lines[i]->*field).get());
+	});
+
+	for (size_t i = 0; i < lines.size(); ++i) {
+		auto& value = lines[i]->*field;
+		if (normalized[i] != value.get())
+			value = normalized[i];
+	}
 }
 
 typedef std::function<MatchState (const AssDialogue*, size_t)> matcher;
 
 class noop_accessor {
 	boost::flyweight<std::string> AssDialogueBase::*field;
+	bool update_lines;
 	size_t start = 0;
 
 public:
-	noop_accessor(SearchReplaceSettings::Field f) : field(get_dialogue_field(f)) { }
+	noop_accessor(SearchReplaceSettings::Field f, bool update_lines)
+	: field(get_dialogue_field(f)), update_lines(update_lines) { }
 
 	std::string get(const AssDialogue *d, size_t s) {
 		start = s;
-		return get_normalized(d, field).substr(s);
+		return get_normalized(d, field, update_lines).substr(s);
 	}
 
 	MatchState make_match_state(size_t s, size_t e, boost::u32regex *r = nullptr) {
@@ -73,13 +99,15 @@ public:
 
 class skip_tags_accessor {
 	boost::flyweight<std::string> AssDialogueBase::*field;
+	bool update_lines;
 	agi::util::tagless_find_helper helper;
 
 public:
-	skip_tags_accessor(SearchReplaceSettings::Field f) : field(get_dialogue_field(f)) { }
+	skip_tags_accessor(SearchReplaceSettings::Field f, bool update_lines)
+	: field(get_dialogue_field(f)), update_lines(update_lines) { }
 
 	std::string get(const AssDialogue *d, size_t s) {
-		return helper.strip_tags(get_normalized(d, field), s);
+		return helper.strip_tags(get_normalized(d, field, update_lines), s);
 	}
 
 	MatchState make_match_state(size_t s, size_t e, boost::u32regex *r = nullptr) {
@@ -128,6 +156,12 @@ matcher get_matcher(SearchReplaceSettings const& settings, Accessor&& a) {
 	};
 }
 
+matcher get_matcher(SearchReplaceSettings const& settings, bool update_lines) {
+	if (settings.skip_tags)
+		return get_matcher(settings, skip_tags_accessor(settings.field, update_lines));
+	return get_matcher(settings, noop_accessor(settings.field, update_lines));
+}
+
 template<typename Iterator, typename Container>
 Iterator circular_next(Iterator it, Container& c) {
 	++it;
@@ -136,19 +170,245 @@ Iterator circular_next(Iterator it, Container& c) {
 	return it;
 }
 
+/// Get the sorted, unique byte trigrams of a string
+std::vector<uint32_t> get_trigrams(std::string const& str) {
+	std::vector<uint32_t> trigrams;
+	if (str.size() < 3) return trigrams;
+
+	trigrams.reserve(str.size() - 2);
+	for (size_t i = 0; i + 2 < str.size(); ++i)
+		trigrams.push_back(
+			(uint32_t)(unsigned char)str[i] << 16 |
+			(uint32_t)(unsigned char)str[i + 1] << 8 |
+			(uint32_t)(unsigned char)str[i + 2]);
+	std::sort(begin(trigrams), end(trigrams));
+	trigrams.erase(std::unique(begin(trigrams), end(trigrams)), end(trigrams));
+	return trigrams;
+}
+
 }
 
+/// Index from trigrams of the case-folded text of a field to the distinct
+/// values of that field which contain them.
+///
+/// Values rather than lines are indexed, as a flyweight's value never changes
+/// and many lines share values for the non-text fields. This means entries
+/// are never wrong, and only newly seen values have to be added. Values which
+/// are no longer used by any line are pruned once the file has been edited.
+class SearchIndex {
+	boost::flyweight<std::string> AssDialogueBase::*field;
+	bool skip_tags;
+	/// Have lines been edited since the last call to Prune?
+	bool may_have_unused = false;
+
+	/// Value -> index in postings lists
+	std::unordered_map<boost::flyweight<std::string>, uint32_t> value_ids;
+	/// Trigram -> sorted ids of the values containing it
+	std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+
+public:
+	static const uint32_t bad_id = -1;
+
+	SearchIndex(SearchReplaceSettings::Field f, bool skip_tags)
+	: field(get_dialogue_field(f)), skip_tags(skip_tags) { }
+
+	/// Add any values from the lines which are not yet indexed
+	void Update(std::vector<AssDialogue *> const& lines) {
+		std::vector<const std::string *> new_values;
+		for (auto line : lines) {
+			auto const& value = line->*field;
+			if (value_ids.emplace(value, (uint32_t)value_ids.size()).second)
+				new_values.push_back(&value.get());
+		}
+		if (new_values.empty()) return;
+
+		// Normalizing and folding is the expensive part, so do that in parallel
+		std::vector<std::vector<uint32_t>> trigrams(new_values.size());
+		agi::dispatch::ParallelFor(new_values.size(), 500, [&](size_t begin, size_t end) {
+			agi::util::tagless_find_helper helper;
+			for (size_t i = begin; i < end; ++i) {
+				auto text = boost::locale::normalize(*new_values[i]);
+				if (skip_tags)
+					text = helper.strip_tags(text, 0);
+				trigrams[i] = get_trigrams(boost::locale::fold_case(text));
+			}
+		});
+
+		// Ids are handed out in increasing order, so appending keeps the
+		// postings lists sorted
+		uint32_t first_id = value_ids.size() - new_values.size();
+		for (size_t i = 0; i < trigrams.size(); ++i) {
+			for (auto trigram : trigrams[i])
+				postings[trigram].push_back(first_id + i);
+		}
+	}
+
+	/// Note that lines have been changed, so some values may no longer be used
+	void MarkEdited() { may_have_unused = true; }
+
+	/// Drop the values which aren't used by any of the lines, if the file has
+	/// been edited since the last prune
+	void Prune(EntryList<AssDialogue> const& events) {
+		if (!may_have_unused) return;
+		may_have_unused = false;
+
+		std::vector<bool> used(value_ids.size());
+		size_t used_count = 0;
+		for (auto const& line : events) {
+			auto it = value_ids.find(line.*field);
+			if (it != value_ids.end() && !used[it->second]) {
+				used[it->second] = true;
+				++used_count;
+			}
+		}
+
+		// Rewriting the postings lists costs about as much as building them,
+		// so wait until a good part of the index is unused
+		if (value_ids.size() - used_count <= used_count / 4) return;
+
+		// Renumber the remaining values in their existing order, which keeps
+		// the postings lists sorted and the ids contiguous
+		std::vector<uint32_t> new_ids(value_ids.size(), bad_id);
+		uint32_t next_id = 0;
+		for (size_t id = 0; id < new_ids.size(); ++id) {
+			if (used[id])
+				new_ids[id] = next_id++;
+		}
+
+		for (auto it = begin(value_ids); it != end(value_ids); ) {
+			if (used[it->second]) {
+				it->second = new_ids[it->second];
+				++it;
+			}
+			else
+				it = value_ids.erase(it);
+		}
+
+		for (auto it = begin(postings); it != end(postings); ) {
+			auto& ids = it->second;
+			size_t kept = 0;
+			for (auto id : ids) {
+				if (used[id])
+					ids[kept++] = new_ids[id];
+			}
+			ids.resize(kept);
+			if (ids.empty())
+				it = postings.erase(it);
+			else
+				++it;
+		}
+	}
+
+	/// Get the id of a line's value, or bad_id if it hasn't been indexed
+	uint32_t GetId(const AssDialogue *line) const {
+		auto it = value_ids.find(line->*field);
+		return it == value_ids.end() ? bad_id : it->second;
+	}
+
+	/// Flag each value which contains all of the trigrams in the folded
+	/// string to search for. Values without a flag can't match.
+	std::vector<bool> GetCandidates(std::string const& folded) const {
+		std::vector<bool> candidates(value_ids.size());
+
+		std::vector<std::vector<uint32_t> const*> lists;
+		for (auto trigram : get_trigrams(folded)) {
+			auto it = postings.find(trigram);
+			if (it == postings.end()) return candidates;
+			lists.push_back(&it->second);
+		}
+
+		// Intersect starting from the shortest list to keep the working set small
+		std::sort(begin(lists), end(lists), [](std::vector<uint32_t> const* a, std::vector<uint32_t> const* b) {
+			return a->size() < b->size();
+		});
+		std::vector<uint32_t> ids = *lists[0], scratch;
+		for (size_t i = 1; i < lists.size() && !ids.empty(); ++i) {
+			scratch.clear();
+			std::set_intersection(begin(ids), end(ids), begin(*lists[i]), end(*lists[i]), back_inserter(scratch));
+			ids.swap(scratch);
+		}
+
+		for (auto id : ids)
+			candidates[id] = true;
+		return candidates;
+	}
+};
+
 std::function<MatchState (const AssDialogue*, size_t)> SearchReplaceEngine::GetMatcher(SearchReplaceSettings const& settings) {
-	if (settings.skip_tags)
-		return get_matcher(settings, skip_tags_accessor(settings.field));
-	return get_matcher(settings, noop_accessor(settings.field));
+	return get_matcher(settings, true);
 }
 
 SearchReplaceEngine::SearchReplaceEngine(agi::Context *c)
 : context(c)
+, file_changed_connection(c->ass->AddCommitListener(&SearchReplaceEngine::OnCommit, this))
 {
 }
 
+SearchReplaceEngine::~SearchReplaceEngine() { }
+
+void SearchReplaceEngine::OnCommit(int type) {
+	// A different file (or undo state) may share almost nothing with the
+	// indexed values, so start over rather than pruning
+	if (type == AssFile::COMMIT_NEW) {
+		for (auto& field_indexes : indexes) {
+			for (auto& index : field_indexes)
+				index.reset();
+		}
+	}
+	// Pruning is left until the next search, so that it isn't done on
+	// every keystroke in the edit box
+	else if (type & (AssFile::COMMIT_DIAG_ADDREM | AssFile::COMMIT_DIAG_FULL)) {
+		for (auto& field_indexes : indexes) {
+			for (auto& index : field_indexes) {
+				if (index)
+					index->MarkEdited();
+			}
+		}
+	}
+}
+
+std::vector<AssDialogue *> SearchReplaceEngine::FilterMatches(SearchReplaceSettings const& settings, std::vector<AssDialogue *> const& lines, bool invert) {
+	std::vector<char> matched(lines.size(), false);
+	std::vector<size_t> to_check;
+
+	// A plain text match needs every trigram of the folded search string to
+	// be in the folded field, whether or not the search is case-sensitive, so
+	// the index can rule out most lines without running the matcher on them
+	auto folded = boost::locale::fold_case(settings.find);
+	if (!settings.use_regex && folded.size() >= 3) {
+		auto& index = indexes[(int)settings.field][settings.skip_tags];
+		if (!index)
+			index = agi::make_unique<SearchIndex>(settings.field, settings.skip_tags);
+		index->Prune(context->ass->Events);
+		index->Update(lines);
+
+		auto candidates = index->GetCandidates(folded);
+		for (size_t i = 0; i < lines.size(); ++i) {
+			auto id = index->GetId(lines[i]);
+			if (id == SearchIndex::bad_id || candidates[id])
+				to_check.push_back(i);
+		}
+	}
+	else {
+		to_check.resize(lines.size());
+		std::iota(begin(to_check), end(to_check), 0);
+	}
+
+	// Each chunk gets its own matcher as they carry per-call state
+	agi::dispatch::ParallelFor(to_check.size(), 1000, [&](size_t begin, size_t end) {
+		auto matches = get_matcher(settings, false);
+		for (size_t i = begin; i < end; ++i)
+			matched[to_check[i]] = !!matches(lines[to_check[i]], 0);
+	});
+
+	std::vector<AssDialogue *> result;
+	for (size_t i = 0; i < lines.size(); ++i) {
+		if (!!matched[i] != invert)
+			result.push_back(lines[i]);
+	}
+	return result;
+}
+
 void SearchReplaceEngine::Replace(AssDialogue *diag, MatchState &ms) {
 	auto& diag_field = diag->*get_dialogue_field(settings.field);
 	auto text = diag_field.get();
@@ -240,18 +500,29 @@ bool SearchReplaceEngine::ReplaceAll() {
 
 	size_t count = 0;
 
-	auto matches = GetMatcher(settings);
-
 	auto const& sel = context->selectionController->GetSelectedSet();
 	bool selection_only = settings.limit_to == SearchReplaceSettings::Limit::SELECTED;
 
+	std::vector<AssDialogue *> lines;
 	for (auto& diag : context->ass->Events) {
 		if (selection_only && !sel.count(&diag)) continue;
 		if (settings.ignore_comments && diag.Comment) continue;
+		lines.push_back(&diag);
+	}
+
+	// Searching the lines one at a time normalized the searched field of
+	// each of them whether or not it matched, so keep doing that
+	normalize_lines(lines, settings.field);
 
+	// Find the matching lines in parallel, then do the actual replacing
+	// (which modifies the lines) on just those
+	lines = FilterMatches(settings, lines);
+
+	auto matches = GetMatcher(settings);
+	for (auto diag : lines) {
 		if (settings.use_regex) {
-			if (MatchState ms = matches(&diag, 0)) {
-				auto& diag_field = diag.*get_dialogue_field(settings.field);
+			if (MatchState ms = matches(diag, 0)) {
+				auto& diag_field = diag->*get_dialogue_field(settings.field);
 				std::string const& text = diag_field.get();
 				count += std::distance(
 					boost::u32regex_iterator<std::string::const_iterator>(begin(text), end(text), *ms.re),
@@ -262,9 +533,9 @@ bool SearchReplaceEngine::ReplaceAll() {
 		}
 
 		size_t pos = 0;
-		while (MatchState ms = matches(&diag, pos)) {
+		while (MatchState ms = matches(diag, pos)) {
 			++count;
-			Replace(&diag, ms);
+			Replace(diag, ms);
 			pos = ms.end;
 		}
 	}
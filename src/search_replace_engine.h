@@ -14,12 +14,17 @@
 //
 // Aegisub Project http://www.aegisub.org/
 
+#include <libaegisub/signal.h>
+
 #include <functional>
 #include <boost/regex/icu.hpp>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace agi { struct Context; }
 class AssDialogue;
+class SearchIndex;
 
 struct MatchState {
 	boost::u32regex *re;
@@ -59,8 +64,14 @@ class SearchReplaceEngine {
 	bool initialized = false;
 	SearchReplaceSettings settings;
 
+	/// Trigram indexes of the values of each field, with and without
+	/// override tags, built on first use
+	std::unique_ptr<SearchIndex> indexes[4][2];
+	agi::signal::Connection file_changed_connection;
+
 	bool FindReplace(bool replace);
 	void Replace(AssDialogue *line, MatchState &ms);
+	void OnCommit(int type);
 
 public:
 	bool FindNext() { return FindReplace(false); }
@@ -69,7 +80,19 @@ public:
 
 	void Configure(SearchReplaceSettings const& new_settings);
 
+	/// Get the lines which match the search, in the order they were given
+	///
+	/// Lines are matched in parallel, and plain text searches only check the
+	/// lines which a trigram index of the field says could match. Unlike the
+	/// find/replace functions this does not write normalized text back to
+	/// the lines.
+	/// @param settings Search to run. limit_to and ignore_comments are not used.
+	/// @param lines Lines to search
+	/// @param invert Return the lines which don't match instead
+	std::vector<AssDialogue *> FilterMatches(SearchReplaceSettings const& settings, std::vector<AssDialogue *> const& lines, bool invert = false);
+
 	static std::function<MatchState (const AssDialogue*, size_t)> GetMatcher(SearchReplaceSettings const& settings);
 
 	SearchReplaceEngine(agi::Context *c);
+	~SearchReplaceEngine();
 };
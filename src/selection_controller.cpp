@@ -27,6 +27,7 @@ SelectionController::SelectionController(agi::Context *c) : context(c) { }
 
 void SelectionController::SetSelectedSet(Selection new_selection) {
 	selection = std::move(new_selection);
+	++version;
 	AnnounceSelectedSetChanged();
 }
 
@@ -35,6 +36,7 @@ void SelectionController::SetActiveLine(AssDialogue *new_line) {
 		active_line = new_line;
 		if (active_line)
 			context->ass->Properties.active_row = active_line->Row;
+		++version;
 		AnnounceActiveLineChanged(new_line);
 	}
 }
@@ -45,6 +47,7 @@ void SelectionController::SetSelectionAndActive(Selection new_selection, AssDial
 	active_line = new_line;
 	if (active_line)
 		context->ass->Properties.active_row = active_line->Row;
+	++version;
 
 	AnnounceSelectedSetChanged();
 	if (active_line_changed)
@@ -45,6 +45,7 @@ class SelectionController {
 
 	Selection selection; ///< Currently selected lines
 	AssDialogue *active_line = nullptr; ///< The currently active line or 0 if none
+	int version = 0; ///< Incremented whenever the selection or active line changes
 
 public:
 	SelectionController(agi::Context *context);
@@ -84,6 +85,12 @@ public:
 	/// Get the selection sorted by row number
 	std::vector<AssDialogue *> GetSortedSelection() const;
 
+	/// @brief Get a counter which changes whenever the selected set or active line does
+	///
+	/// This can be used to check if information derived from the selection
+	/// is still up to date without having to compare the selection itself.
+	int GetVersion() const { return version; }
+
 	/// @brief Set both the selected set and active line
 	/// @param new_line Subtitle line to become the new active line
 	/// @param new_selection The set of subtitle lines to become the new selected set
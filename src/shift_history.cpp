@@ -0,0 +1,238 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#include "shift_history.h"
+
+#include <libaegisub/ass/time.h>
+#include <libaegisub/cajun/elements.h>
+#include <libaegisub/cajun/reader.h>
+#include <libaegisub/fs.h>
+#include <libaegisub/io.h>
+#include <libaegisub/log.h>
+
+#include <algorithm>
+#include <boost/lexical_cast.hpp>
+#include <cstring>
+#include <iterator>
+
+// File format, with all integers little-endian:
+//   "AGSH", uint32 version, uint32 entry count
+//   per entry: uint32 offset from the start of the file, uint32 size
+//   entries: uint8 flags (1: by time, 2: backward), uint8 fields, uint8 mode,
+//            int32 amount, uint32 filename length, filename,
+//            uint32 block count, per block: int32 start, int32 end
+
+namespace {
+const char magic[4] = {'A', 'G', 'S', 'H'};
+const uint32_t version = 1;
+const size_t header_size = 12;
+
+void put_u32(std::string &out, uint32_t value) {
+	for (int i = 0; i < 4; ++i)
+		out += static_cast<char>((value >> (i * 8)) & 0xFF);
+}
+
+/// Reads from an entry, throwing if it runs past the end
+class reader {
+	const char *pos;
+	const char *end;
+
+public:
+	reader(const char *begin, const char *end) : pos(begin), end(end) { }
+
+	const char *read(size_t len) {
+		if (static_cast<size_t>(end - pos) < len)
+			throw agi::InvalidInputException("Truncated shift history entry");
+		auto ret = pos;
+		pos += len;
+		return ret;
+	}
+
+	uint8_t u8() { return static_cast<uint8_t>(*read(1)); }
+
+	uint32_t u32() {
+		auto p = reinterpret_cast<const unsigned char *>(read(4));
+		return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+	}
+
+	int32_t i32() { return static_cast<int32_t>(u32()); }
+};
+
+std::string encode(ShiftHistoryEntry const& entry) {
+	std::string out;
+	out.reserve(15 + entry.filename.size() + entry.blocks.size() * 8);
+	out += static_cast<char>((entry.by_time ? 1 : 0) | (entry.backward ? 2 : 0));
+	out += static_cast<char>(entry.fields);
+	out += static_cast<char>(entry.mode);
+	put_u32(out, static_cast<uint32_t>(entry.amount));
+	put_u32(out, entry.filename.size());
+	out += entry.filename;
+	put_u32(out, entry.blocks.size());
+	for (auto const& block : entry.blocks) {
+		put_u32(out, static_cast<uint32_t>(block.first));
+		put_u32(out, static_cast<uint32_t>(block.second));
+	}
+	return out;
+}
+}
+
+const size_t ShiftHistory::max_entries;
+
+ShiftHistory::ShiftHistory(agi::fs::path filename, agi::fs::path const& legacy_filename)
+: filename(std::move(filename))
+{
+	try {
+		if (!agi::fs::FileExists(this->filename)) {
+			if (agi::fs::FileExists(legacy_filename))
+				ImportJson(legacy_filename);
+			return;
+		}
+
+		auto stream = agi::io::Open(this->filename, true);
+		data.assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+		Parse();
+	}
+	catch (agi::Exception const& e) {
+		LOG_D("shift_history/load") << "Cannot load shift times history: " << e.GetMessage();
+		data.clear();
+		entries.clear();
+	}
+}
+
+void ShiftHistory::Parse() {
+	reader r(data.data(), data.data() + data.size());
+	if (memcmp(r.read(4), magic, 4) != 0 || r.u32() != version)
+		throw agi::InvalidInputException("Not a shift history file");
+
+	uint32_t count = r.u32();
+	for (uint32_t i = 0; i < count; ++i) {
+		uint32_t offset = r.u32();
+		uint32_t size = r.u32();
+		if (offset > data.size() || size > data.size() - offset)
+			throw agi::InvalidInputException("Shift history entry out of range");
+		entries.emplace_back(offset, size);
+	}
+}
+
+void ShiftHistory::ImportJson(agi::fs::path const& json_filename) {
+	std::vector<std::string> imported;
+	try {
+		json::UnknownElement root;
+		json::Reader::Read(root, *agi::io::Open(json_filename));
+
+		for (json::Object& obj : static_cast<json::Array&>(root)) {
+			ShiftHistoryEntry entry;
+			entry.filename = static_cast<std::string&>(obj["filename"]);
+			entry.by_time = obj["is by time"];
+			entry.backward = obj["is backward"];
+			std::string const& amount = obj["amount"];
+			try {
+				entry.amount = entry.by_time ? int(agi::Time(amount)) : boost::lexical_cast<int>(amount);
+			}
+			catch (boost::bad_lexical_cast const&) {
+				continue;
+			}
+			entry.fields = (int64_t)obj["fields"];
+			entry.mode = (int64_t)obj["mode"];
+			for (json::Object& range : static_cast<json::Array&>(obj["selection"]))
+				entry.blocks.emplace_back((int64_t)range["start"], (int64_t)range["end"]);
+
+			imported.push_back(encode(entry));
+			if (imported.size() == max_entries) break;
+		}
+	}
+	catch (json::Exception const& e) {
+		LOG_D("shift_history/import") << "Cannot import shift times history: " << e.what();
+	}
+
+	Save(imported);
+}
+
+ShiftHistoryEntry ShiftHistory::Get(size_t i) const {
+	auto const& location = entries.at(i);
+	reader r(data.data() + location.first, data.data() + location.first + location.second);
+
+	ShiftHistoryEntry entry;
+	uint8_t flags = r.u8();
+	entry.by_time = !!(flags & 1);
+	entry.backward = !!(flags & 2);
+	entry.fields = r.u8();
+	entry.mode = r.u8();
+	entry.amount = r.i32();
+	uint32_t filename_len = r.u32();
+	entry.filename.assign(r.read(filename_len), filename_len);
+	uint32_t block_count = r.u32();
+	// Each block is eight bytes, so this rejects garbage counts before
+	// trying to allocate for them
+	if (block_count > location.second / 8)
+		throw agi::InvalidInputException("Truncated shift history entry");
+	entry.blocks.reserve(block_count);
+	for (uint32_t j = 0; j < block_count; ++j) {
+		int start = r.i32();
+		entry.blocks.emplace_back(start, r.i32());
+	}
+	return entry;
+}
+
+void ShiftHistory::Save(std::vector<std::string> const& new_entries) {
+	size_t count = std::min(new_entries.size() + entries.size(), max_entries);
+
+	std::string out(magic, sizeof magic);
+	out.reserve(data.size() + header_size + count * 8);
+	put_u32(out, version);
+	put_u32(out, count);
+
+	auto entry_size = [&](size_t i) {
+		return i < new_entries.size() ? new_entries[i].size() : entries[i - new_entries.size()].second;
+	};
+	uint32_t offset = header_size + count * 8;
+	for (size_t i = 0; i < count; ++i) {
+		put_u32(out, offset);
+		put_u32(out, entry_size(i));
+		offset += entry_size(i);
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		if (i < new_entries.size())
+			out += new_entries[i];
+		else {
+			auto const& location = entries[i - new_entries.size()];
+			out.append(data, location.first, location.second);
+		}
+	}
+
+	data = std::move(out);
+	entries.clear();
+	Parse();
+
+	agi::io::Save(filename, true).Get().write(data.data(), data.size());
+}
+
+void ShiftHistory::Add(ShiftHistoryEntry const& entry) {
+	try {
+		Save({encode(entry)});
+	}
+	catch (agi::Exception const& e) {
+		LOG_E("shift_history/save") << "Cannot save shift times history: " << e.GetMessage();
+	}
+}
+
+void ShiftHistory::Clear() {
+	agi::fs::Remove(filename);
+	data.clear();
+	entries.clear();
+}
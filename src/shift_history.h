@@ -0,0 +1,86 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#pragma once
+
+#include <libaegisub/fs_fwd.h>
+
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// A shift done with the Shift Times dialog
+struct ShiftHistoryEntry {
+	/// Name of the file which was shifted, or empty if it was unsaved
+	std::string filename;
+	bool by_time = true;
+	bool backward = false;
+	/// Milliseconds if by_time is set, otherwise frames
+	int amount = 0;
+	/// 0 for start and end times, 1 for start times and 2 for end times
+	int fields = 0;
+	/// 0 for all lines, 1 for the selected lines and 2 for the selection onward
+	int mode = 0;
+	/// Ranges of selected rows, one-based and inclusive
+	std::vector<std::pair<int, int>> blocks;
+
+	/// Signed shift amount
+	int Shift() const { return backward ? -amount : amount; }
+};
+
+/// @class ShiftHistory
+/// @brief The most recent shifts, stored in a binary file
+///
+/// The file starts with a table of where each entry is, so only the table is
+/// read up front and entries are decoded when they're asked for. Adding an
+/// entry copies the existing entries' bytes as-is rather than decoding and
+/// re-encoding them.
+class ShiftHistory {
+	agi::fs::path filename;
+	/// Contents of the history file
+	std::string data;
+	/// Offset and size of each entry in data, most recent first
+	std::vector<std::pair<uint32_t, uint32_t>> entries;
+
+	/// Read the table of entries from data
+	void Parse();
+	void ImportJson(agi::fs::path const& json_filename);
+	/// Write the file with the given encoded entries followed by the existing ones
+	void Save(std::vector<std::string> const& new_entries);
+
+public:
+	/// Maximum number of entries kept
+	static const size_t max_entries = 50;
+
+	/// @param filename Binary history file
+	/// @param legacy_filename JSON history file written by older versions,
+	///                        which is imported if the binary file doesn't exist
+	ShiftHistory(agi::fs::path filename, agi::fs::path const& legacy_filename);
+
+	size_t size() const { return entries.size(); }
+
+	/// Decode an entry, with 0 being the most recent
+	ShiftHistoryEntry Get(size_t i) const;
+
+	/// Add an entry as the most recent and save the history
+	void Add(ShiftHistoryEntry const& entry);
+
+	/// Remove all entries and delete the file
+	void Clear();
+};
@@ -20,8 +20,12 @@
 #include "options.h"
 
 #include <libaegisub/make_unique.h>
+#include <libaegisub/signal.h>
 #include <libaegisub/spellchecker.h>
 
+#include <mutex>
+#include <unordered_map>
+
 #ifdef __APPLE__
 namespace agi {
 class OptionValue;
@@ -29,11 +33,164 @@ std::unique_ptr<agi::SpellChecker> CreateCocoaSpellChecker(OptionValue *opt);
 }
 #endif
 
+namespace {
+/// Results of checking words, shared by all of the spell checkers so that
+/// each word only has to be checked once for each language
+class WordCache {
+	std::mutex mutex;
+	/// Language which the cached results are for
+	std::string language;
+	std::unordered_map<std::string, bool> results;
+	/// Incremented whenever the results are cleared, so that results from a
+	/// check which started before the dictionary changed aren't added
+	uint64_t generation = 0;
+
+	/// Cap on the number of cached words to bound the memory used
+	static const size_t max_size = 200000;
+
+public:
+	/// Look up the result for a word
+	/// @param[out] correct Whether the word is spelled correctly, if it's cached
+	/// @param[out] gen Generation to pass to Set() if the word isn't cached
+	/// @return Was the word in the cache?
+	bool Get(std::string const& lang, std::string const& word, bool &correct, uint64_t &gen) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (lang != language) {
+			language = lang;
+			results.clear();
+			++generation;
+		}
+
+		gen = generation;
+		auto it = results.find(word);
+		if (it == results.end()) return false;
+		correct = it->second;
+		return true;
+	}
+
+	/// Look up the result for a word without changing which language the
+	/// cache is for
+	bool Find(std::string const& lang, std::string const& word, bool &correct) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (lang != language) return false;
+
+		auto it = results.find(word);
+		if (it == results.end()) return false;
+		correct = it->second;
+		return true;
+	}
+
+	void Set(std::string const& lang, std::string const& word, bool correct, uint64_t gen) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (lang != language || gen != generation) return;
+		if (results.size() >= max_size)
+			results.clear();
+		results[word] = correct;
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		results.clear();
+		++generation;
+	}
+
+	static WordCache &Instance() {
+		static WordCache cache;
+		return cache;
+	}
+};
+
+/// Spell checker which caches the results of another spell checker in the
+/// shared word cache
+///
+/// Spell checkers for a fixed language only read from the cache, as words
+/// added by the user after they were created are not in their dictionary.
+class CachingSpellChecker final : public agi::SpellChecker {
+	std::unique_ptr<agi::SpellChecker> checker;
+	/// Language of the spell checker, or empty if it uses the language option
+	std::string language;
+	/// The language option, if the spell checker uses it
+	const agi::OptionValue *language_opt = nullptr;
+
+	agi::signal::Connection dict_path_listener;
+	void OnPathChanged() { WordCache::Instance().Clear(); }
+
+public:
+	CachingSpellChecker(std::unique_ptr<agi::SpellChecker> checker, std::string language = "")
+	: checker(std::move(checker))
+	, language(std::move(language))
+	{
+		if (this->language.empty()) {
+			language_opt = OPT_GET("Tool/Spell Checker/Language");
+			dict_path_listener = OPT_SUB("Path/Dictionary", &CachingSpellChecker::OnPathChanged, this);
+		}
+	}
+
+	void AddWord(std::string const& word) override {
+		// Clear first, as this fires the language change signal and anything
+		// listening to it will check words again
+		WordCache::Instance().Clear();
+		checker->AddWord(word);
+	}
+
+	void RemoveWord(std::string const& word) override {
+		WordCache::Instance().Clear();
+		checker->RemoveWord(word);
+	}
+
+	bool CanAddWord(std::string const& word) override { return checker->CanAddWord(word); }
+	bool CanRemoveWord(std::string const& word) override { return checker->CanRemoveWord(word); }
+
+	bool CheckWord(std::string const& word) override {
+		auto& cache = WordCache::Instance();
+		bool correct;
+
+		if (!language.empty()) {
+			if (cache.Find(language, word, correct))
+				return correct;
+			return checker->CheckWord(word);
+		}
+
+		auto const& lang = language_opt->GetString();
+		uint64_t generation;
+		if (cache.Get(lang, word, correct, generation))
+			return correct;
+
+		correct = checker->CheckWord(word);
+		cache.Set(lang, word, correct, generation);
+		return correct;
+	}
+
+	std::vector<std::string> GetSuggestions(std::string const& word) override {
+		return checker->GetSuggestions(word);
+	}
+
+	std::vector<std::string> GetLanguageList() override {
+		return checker->GetLanguageList();
+	}
+};
+}
+
 std::unique_ptr<agi::SpellChecker> SpellCheckerFactory::GetSpellChecker() {
 #ifdef __APPLE__
-	return agi::CreateCocoaSpellChecker(OPT_SET("Tool/Spell Checker/Language"));
+	return agi::make_unique<CachingSpellChecker>(agi::CreateCocoaSpellChecker(OPT_SET("Tool/Spell Checker/Language")));
 #elif defined(WITH_HUNSPELL)
-	return agi::make_unique<HunspellSpellChecker>();
+	return agi::make_unique<CachingSpellChecker>(agi::make_unique<HunspellSpellChecker>());
+#else
+	return {};
+#endif
+}
+
+std::function<std::unique_ptr<agi::SpellChecker>()> SpellCheckerFactory::GetBackgroundSpellCheckerLoader() {
+#if !defined(__APPLE__) && defined(WITH_HUNSPELL)
+	auto language = OPT_GET("Tool/Spell Checker/Language")->GetString();
+	HunspellDictionary dictionary;
+	if (!HunspellSpellChecker::FindDictionary(language, dictionary))
+		return {};
+
+	return [=]() -> std::unique_ptr<agi::SpellChecker> {
+		return agi::make_unique<CachingSpellChecker>(agi::make_unique<HunspellSpellChecker>(dictionary), language);
+	};
 #else
 	return {};
 #endif
@@ -39,6 +39,12 @@ HunspellSpellChecker::HunspellSpellChecker()
 	OnLanguageChanged();
 }
 
+HunspellSpellChecker::HunspellSpellChecker(HunspellDictionary const& dictionary)
+: follow_option(false)
+{
+	Load(dictionary);
+}
+
 HunspellSpellChecker::~HunspellSpellChecker() {
 }
 
@@ -64,7 +70,7 @@ void HunspellSpellChecker::AddWord(std::string const& word) {
 	hunspell->add(conv->Convert(word).c_str());
 
 	// Add the word
-	if (customWords.insert(word).second)
+	if (customWords.insert(word).second && follow_option)
 		WriteUserDictionary();
 }
 
@@ -78,7 +84,8 @@ void HunspellSpellChecker::RemoveWord(std::string const& word) {
 	if (word_iter != customWords.end()) {
 		customWords.erase(word_iter);
 
-		WriteUserDictionary();
+		if (follow_option)
+			WriteUserDictionary();
 	}
 }
 
@@ -179,20 +186,32 @@ static bool check_path(agi::fs::path const& path, std::string const& language, a
 	return agi::fs::FileExists(aff) && agi::fs::FileExists(dic);
 }
 
-void HunspellSpellChecker::OnLanguageChanged() {
-	hunspell.reset();
+bool HunspellSpellChecker::FindDictionary(std::string const& language, HunspellDictionary &dictionary) {
+	if (language.empty()) return false;
 
-	auto language = OPT_GET("Tool/Spell Checker/Language")->GetString();
-	if (language.empty()) return;
-
-	agi::fs::path aff, dic;
 	auto path = config::path->Decode(OPT_GET("Path/Dictionary")->GetString() + "/");
-	if (!check_path(path, language, aff, dic)) {
+	if (!check_path(path, language, dictionary.aff, dictionary.dic)) {
 		path = config::path->Decode("?dictionary/");
-		if (!check_path(path, language, aff, dic))
-			return;
+		if (!check_path(path, language, dictionary.aff, dictionary.dic))
+			return false;
 	}
 
+	dictionary.user_dic = config::path->Decode("?user/dictionaries")/agi::format("user_%s.dic", language);
+	return true;
+}
+
+void HunspellSpellChecker::OnLanguageChanged() {
+	hunspell.reset();
+
+	HunspellDictionary dictionary;
+	if (FindDictionary(OPT_GET("Tool/Spell Checker/Language")->GetString(), dictionary))
+		Load(dictionary);
+}
+
+void HunspellSpellChecker::Load(HunspellDictionary const& dictionary) {
+	auto const& aff = dictionary.aff;
+	auto const& dic = dictionary.dic;
+
 	LOG_I("dictionary/file") << dic;
 
 #ifdef _WIN32
@@ -206,7 +225,7 @@ void HunspellSpellChecker::OnLanguageChanged() {
 	conv = agi::make_unique<agi::charset::IconvWrapper>("utf-8", hunspell->get_dic_encoding());
 	rconv = agi::make_unique<agi::charset::IconvWrapper>(hunspell->get_dic_encoding(), "utf-8");
 
-	userDicPath = config::path->Decode("?user/dictionaries")/agi::format("user_%s.dic", language);
+	userDicPath = dictionary.user_dic;
 	ReadUserDictionary();
 
 	for (auto const& word : customWords) {
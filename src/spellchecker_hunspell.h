@@ -32,6 +32,14 @@
 namespace agi { namespace charset { class IconvWrapper; } }
 class Hunspell;
 
+/// Paths to the files which make up the dictionary for a language
+struct HunspellDictionary {
+	agi::fs::path aff;
+	agi::fs::path dic;
+	/// Words added by the user
+	agi::fs::path user_dic;
+};
+
 /// @brief Hunspell-based spell checker implementation
 class HunspellSpellChecker final : public agi::SpellChecker {
 	/// Hunspell instance
@@ -50,6 +58,10 @@ class HunspellSpellChecker final : public agi::SpellChecker {
 	/// Words in the custom user dictionary
 	std::set<std::string> customWords;
 
+	/// Does this spell checker follow the language option? If not, added
+	/// words are only added to this checker's in-memory dictionary.
+	bool follow_option = true;
+
 	/// Dictionary language change connection
 	agi::signal::Connection lang_listener;
 	/// Dictionary language change handler
@@ -65,8 +77,22 @@ class HunspellSpellChecker final : public agi::SpellChecker {
 	/// Save words to custom dictionary
 	void WriteUserDictionary();
 
+	/// Load the given dictionary
+	void Load(HunspellDictionary const& dictionary);
+
 public:
+	/// Find the dictionary for a language
+	/// @return Were both the .aff and .dic files found?
+	static bool FindDictionary(std::string const& language, HunspellDictionary &dictionary);
+
+	/// Create a spell checker which uses the language set in the options
 	HunspellSpellChecker();
+
+	/// Create a spell checker for a specific dictionary
+	///
+	/// As this does not look at the options, it can be created and used on
+	/// a background thread.
+	HunspellSpellChecker(HunspellDictionary const& dictionary);
 	~HunspellSpellChecker();
 
 	void AddWord(std::string const& word) override;
@@ -38,6 +38,8 @@
 #include <libaegisub/path.h>
 #include <libaegisub/util.h>
 
+#include <boost/scope_exit.hpp>
+
 #include <wx/msgdlg.h>
 
 namespace {
@@ -168,9 +170,54 @@ void SubsController::SetSelectionController(SelectionController *selection_contr
 ProjectProperties SubsController::Load(agi::fs::path const& filename, std::string charset) {
 	AssFile temp;
 
-	SubtitleFormat::GetReader(filename, charset)->ReadFile(&temp, filename, context->project->Timecodes(), charset);
+	auto reader = SubtitleFormat::GetReader(filename, charset);
+	if (reader->CanReadIncrementally()) {
+		// Read straight into the open file so that the lines show up in the
+		// grid as they arrive, with the old file kept in temp in case reading
+		// fails. Commits without a message aren't added to the undo stack, so
+		// the old file's history is left alone until the read completes.
+		//
+		// Nothing keyed on the commit id may see the partly read file: the
+		// autosave would write it out under the old file's name, and
+		// anything cached against the old file's commit id would match it.
+		// The autosave timer is stopped and the partial file gets an id of
+		// its own until the read either completes or is abandoned.
+		int old_commit_id = commit_id;
+		bool loaded = false;
+		autosave_timer.Stop();
+		commit_id = next_commit_id++;
+		BOOST_SCOPE_EXIT_ALL(&) {
+			if (!loaded)
+				commit_id = old_commit_id;
+			autosave_timer_changed(&autosave_timer);
+		};
+
+		context->ass->swap(temp);
+		bool have_lines = false;
+		try {
+			reader->ReadFileIncremental(context->ass.get(), filename, context->project->Timecodes(), charset, [&] {
+				// These commits bypass OnCommit, so make sure there's a style
+				// here like it does. The reader only calls this once at least
+				// one line has been added.
+				if (context->ass->Styles.empty())
+					context->ass->Styles.push_back(*new AssStyle);
+				context->ass->Commit("", have_lines ? AssFile::COMMIT_DIAG_ADDREM : AssFile::COMMIT_NEW);
+				have_lines = true;
+			});
+		}
+		catch (...) {
+			context->ass->swap(temp);
+			if (have_lines)
+				context->ass->Commit("", AssFile::COMMIT_NEW);
+			throw;
+		}
+		loaded = true;
+	}
+	else {
+		reader->ReadFile(&temp, filename, context->project->Timecodes(), charset);
+		context->ass->swap(temp);
+	}
 
-	context->ass->swap(temp);
 	auto props = context->ass->Properties;
 
 	SetFileName(filename);
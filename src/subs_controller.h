@@ -94,6 +94,10 @@ public:
 	/// Does the file have unsaved changes?
 	bool IsModified() const { return commit_id != saved_commit_id; };
 
+	/// Get the revision of the current state of the file. Undoing a change
+	/// returns to the revision from before the change.
+	int GetCommitId() const { return commit_id; }
+
 	/// @brief Load from a file
 	/// @param file File name
 	/// @param charset Character set of file
@@ -32,6 +32,7 @@
 #include <libaegisub/exception.h>
 #include <libaegisub/fs_fwd.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -100,6 +101,22 @@ public:
 	/// @param encoding Encoding to use. May be ignored by the reader.
 	virtual void ReadFile(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const { }
 
+	/// Can this format hand over lines before the whole file has been read?
+	virtual bool CanReadIncrementally() const { return false; }
+
+	/// Load a subtitle file, handing over the lines while it is still being read
+	///
+	/// The header is loaded into target first, and then the events are
+	/// appended to it in batches on the main thread as they're read, calling
+	/// on_lines after each batch so that they can be displayed while the rest
+	/// of the file loads. target may be the open file, so it is never touched
+	/// from any other thread. Only used if CanReadIncrementally() is true.
+	/// @param[out] target Destination to read lines into
+	/// @param filename File to load
+	/// @param encoding Encoding to use. May be ignored by the reader.
+	/// @param on_lines Called after each batch of lines is added to target
+	virtual void ReadFileIncremental(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding, std::function<void ()> const& on_lines) const { }
+
 	/// Save a subtitle file
 	/// @param src Data to write
 	/// @param filename File to write to
@@ -52,3 +52,7 @@ std::vector<std::string> MKVSubtitleFormat::GetReadWildcards() const {
 void MKVSubtitleFormat::ReadFile(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const&) const {
 	MatroskaWrapper::GetSubtitles(filename, target);
 }
+
+void MKVSubtitleFormat::ReadFileIncremental(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const&, std::function<void ()> const& on_lines) const {
+	MatroskaWrapper::GetSubtitles(filename, target, on_lines);
+}
@@ -40,4 +40,7 @@ public:
 	std::vector<std::string> GetReadWildcards() const override;
 
 	void ReadFile(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& forceEncoding) const override;
+
+	bool CanReadIncrementally() const override { return true; }
+	void ReadFileIncremental(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& forceEncoding, std::function<void ()> const& on_lines) const override;
 };
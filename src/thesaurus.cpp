@@ -98,12 +98,23 @@ void Thesaurus::OnLanguageChanged() {
 
 	LOG_I("thesaurus/file") << "Using thesaurus: " << dat;
 
+	// The binary index is cached with the user dictionaries even if the
+	// thesaurus is one of the bundled ones, as that folder may not be writable
+	auto cache_dir = config::path->Decode(OPT_GET("Path/Dictionary")->GetString() + "/");
+	auto cache = cache_dir/agi::format("th_%s.idx.cache", language);
+
 	if (cancel_load) *cancel_load = true;
 	cancel_load = new bool{false};
 	auto cancel = cancel_load; // Needed to avoid capturing via `this`
 	agi::dispatch::Background().Async([=]{
 		try {
-			auto thes = agi::make_unique<agi::Thesaurus>(dat, idx);
+			try {
+				agi::fs::CreateDirectory(cache_dir);
+			}
+			catch (agi::fs::FileSystemError const&) {
+				// Just load the index without caching it
+			}
+			auto thes = agi::make_unique<agi::Thesaurus>(dat, idx, cache);
 			agi::dispatch::Main().Sync([&thes, cancel, this]{
 				if (!*cancel) {
 					impl = std::move(thes);
@@ -0,0 +1,220 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#include "timing_processor.h"
+
+#include "ass_dialogue.h"
+#include "flyweight_hash.h"
+#include "keyframe_index.h"
+
+#include <libaegisub/vfr.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+namespace {
+/// Largest time an agi::Time can hold
+const int max_time = 10 * 60 * 60 * 1000 - 6;
+
+/// Clamp and round a time the same way as storing it in an agi::Time and
+/// reading it back does, which each pass used to do before the next one read
+/// the times
+inline int clamp_time(int time) {
+	time = std::min(std::max(time, 0), max_time);
+	return (time + 5) - (time + 5) % 10;
+}
+
+/// A frame lines can be snapped to
+struct SnapPoint {
+	int frame;
+	int start_time; ///< Time to start a line on the frame
+	int end_time;   ///< Time to end a line on the frame before it
+};
+
+SnapPoint get_closest_kf(KeyframeIndex const& kf, SnapPoint const& video_end, int frame) {
+	// Without keyframe times the end of the video is all there is to snap to
+	if (!kf.HasTimes())
+		return video_end;
+
+	size_t i = kf.Closest(frame);
+	SnapPoint closest{kf.Frame(i), kf.StartTime(i), kf.EndTime(i)};
+	// The last frame of the video is also snapped to. It comes after all of
+	// the keyframes, so it only wins if it's strictly closer.
+	if (video_end.frame >= 0 && std::abs(video_end.frame - frame) < std::abs(closest.frame - frame))
+		return video_end;
+	return closest;
+}
+
+// Lines which don't already collide with a line limit how far it can be
+// extended, while ones which do collide are ignored. Lead-in looks at the
+// lines before each line in the sorted order and lead-out at the ones after
+// it, so both can be done with a single sweep which keeps the relevant
+// times of the lines seen so far sorted.
+
+void add_lead_in(std::vector<int> &starts, std::vector<int> const& ends, int lead_in) {
+	// An earlier line doesn't collide with this one only if it ends no later
+	// than this one starts
+	std::multiset<int> seen_ends;
+	for (size_t i = 0; i < starts.size(); ++i) {
+		int start = starts[i] - lead_in;
+		auto it = seen_ends.upper_bound(starts[i]);
+		if (it != seen_ends.begin())
+			start = std::max(start, *std::prev(it));
+		seen_ends.insert(ends[i]);
+		starts[i] = clamp_time(start);
+	}
+}
+
+void add_lead_out(std::vector<int> const& starts, std::vector<int> &ends, int lead_out) {
+	// A later line doesn't collide with this one if it starts after this one
+	// starts and no earlier than it ends, or if it ends no later than this
+	// one starts. Given the sort order, the latter can only happen for
+	// zero-length lines starting at the same time as this one, so those are
+	// looked up by their end time.
+	std::multiset<int> seen_starts;
+	std::map<int, int> min_start_by_end;
+	for (size_t i = starts.size(); i > 0; --i) {
+		int start = starts[i - 1];
+		int end = ends[i - 1] + lead_out;
+		auto it = seen_starts.lower_bound(std::max(ends[i - 1], start + 1));
+		if (it != seen_starts.end())
+			end = std::min(end, *it);
+		auto zero_length = min_start_by_end.find(start);
+		if (zero_length != min_start_by_end.end())
+			end = std::min(end, zero_length->second);
+
+		seen_starts.insert(start);
+		auto inserted = min_start_by_end.emplace(ends[i - 1], start);
+		if (!inserted.second)
+			inserted.first->second = std::min(inserted.first->second, start);
+		ends[i - 1] = clamp_time(end);
+	}
+}
+
+void make_adjacent(std::vector<int> &starts, std::vector<int> &ends, TimingProcessor::Settings const& s) {
+	// Each pair of neighbouring lines reads the end of the first and the
+	// start of the second, and no other pair writes either of those, so the
+	// pairs are independent and can all be done from the old times at once
+	std::vector<int> new_starts(starts), new_ends(ends);
+	const int gap = s.adjacent_gap, overlap = s.adjacent_overlap;
+	const double bias = s.adjacent_bias;
+	for (size_t i = 1; i < starts.size(); ++i) {
+		int dist = starts[i] - ends[i - 1];
+		bool link = (dist < 0 && -dist <= overlap) || (dist > 0 && dist <= gap);
+		int pos = clamp_time(ends[i - 1] + int(dist * bias));
+		new_starts[i] = link ? pos : starts[i];
+		new_ends[i - 1] = link ? pos : ends[i - 1];
+	}
+	starts.swap(new_starts);
+	ends.swap(new_ends);
+}
+
+void snap_to_keyframes(std::vector<int> &starts, std::vector<int> &ends, TimingProcessor::Settings const& s,
+	KeyframeIndex const& kf, agi::vfr::Framerate const& fps, int video_end_frame)
+{
+	SnapPoint video_end{-1, 0, 0};
+	if (video_end_frame >= 0)
+		video_end = {video_end_frame, fps.TimeAtFrame(video_end_frame, agi::vfr::START), fps.TimeAtFrame(video_end_frame - 1, agi::vfr::END)};
+
+	// The lines are mostly still sorted by start time, so converting all of
+	// the times at once is close to a linear walk over the timecodes
+	std::vector<int> start_frames(starts.size()), end_frames(ends.size());
+	fps.FramesAtTimes(starts.data(), start_frames.data(), starts.size(), agi::vfr::START);
+	fps.FramesAtTimes(ends.data(), end_frames.data(), ends.size(), agi::vfr::END);
+
+	for (size_t i = 0; i < starts.size(); ++i) {
+		int start = starts[i], startF = start_frames[i];
+		auto snap = get_closest_kf(kf, video_end, startF);
+		int closest = snap.frame;
+		int time = snap.start_time;
+		if ((closest > startF && time - start <= s.before_start) || (closest < startF && start - time <= s.after_start))
+			starts[i] = clamp_time(time);
+
+		int end = ends[i], endF = end_frames[i];
+		snap = get_closest_kf(kf, video_end, endF);
+		closest = snap.frame - 1;
+		time = snap.end_time;
+		if ((closest > endF && time - end <= s.before_end) || (closest < endF && end - time <= s.after_end))
+			ends[i] = clamp_time(time);
+	}
+}
+}
+
+TimingProcessor::TimingProcessor(std::vector<AssDialogue *> input, std::vector<std::string> const& style_names) {
+	std::stable_sort(input.begin(), input.end(), [](const AssDialogue *a, const AssDialogue *b) {
+		return a->Start < b->Start;
+	});
+
+	std::unordered_map<boost::flyweight<std::string>, int> style_indices;
+	for (size_t i = 0; i < style_names.size(); ++i)
+		style_indices.emplace(boost::flyweight<std::string>(style_names[i]), i);
+
+	lines = std::move(input);
+	styles.reserve(lines.size());
+	starts.reserve(lines.size());
+	ends.reserve(lines.size());
+	for (auto line : lines) {
+		auto it = style_indices.find(line->Style);
+		styles.push_back(it == style_indices.end() ? -1 : it->second);
+		starts.push_back(line->Start);
+		ends.push_back(line->End);
+	}
+}
+
+AssDialogue *TimingProcessor::FindInvalidLine(std::vector<bool> const& style_enabled) const {
+	for (size_t i = 0; i < lines.size(); ++i) {
+		if (styles[i] >= 0 && style_enabled[styles[i]] && starts[i] > ends[i])
+			return lines[i];
+	}
+	return nullptr;
+}
+
+std::vector<TimingProcessor::Change> TimingProcessor::Run(Settings const& settings, std::vector<bool> const& style_enabled,
+	KeyframeIndex const& kf, agi::vfr::Framerate const& fps, int video_end_frame) const
+{
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < lines.size(); ++i) {
+		if (styles[i] >= 0 && style_enabled[styles[i]])
+			indices.push_back(i);
+	}
+
+	std::vector<int> new_starts(indices.size()), new_ends(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		new_starts[i] = starts[indices[i]];
+		new_ends[i] = ends[indices[i]];
+	}
+
+	if (settings.lead_in)
+		add_lead_in(new_starts, new_ends, settings.lead_in);
+	if (settings.lead_out)
+		add_lead_out(new_starts, new_ends, settings.lead_out);
+	if (settings.adjacent)
+		make_adjacent(new_starts, new_ends, settings);
+	if (settings.keyframes && (kf.HasTimes() || video_end_frame >= 0))
+		snap_to_keyframes(new_starts, new_ends, settings, kf, fps, video_end_frame);
+
+	std::vector<Change> changes;
+	for (size_t i = 0; i < indices.size(); ++i) {
+		size_t j = indices[i];
+		if (new_starts[i] != starts[j] || new_ends[i] != ends[j])
+			changes.push_back(Change{lines[j], new_starts[i], new_ends[i]});
+	}
+	return changes;
+}
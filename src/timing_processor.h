@@ -0,0 +1,84 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class AssDialogue;
+class KeyframeIndex;
+namespace agi { namespace vfr { class Framerate; } }
+
+/// @class TimingProcessor
+/// @brief The passes of the timing post-processor
+///
+/// The times of the lines being processed are copied into flat arrays sorted
+/// by start time, and each pass works on the arrays rather than the lines.
+/// Nothing is written to the lines, so the processor can be rerun with
+/// different settings for a preview of what would change, and only the
+/// lines which actually change need to be touched when applying it.
+class TimingProcessor {
+	/// The lines being processed
+	std::vector<AssDialogue *> lines;
+	/// Index of each line's style in the style list, or -1 if it isn't in it
+	std::vector<int> styles;
+	std::vector<int> starts;
+	std::vector<int> ends;
+
+public:
+	struct Settings {
+		int lead_in = 0;  ///< Lead-in to add in milliseconds, or 0 for none
+		int lead_out = 0; ///< Lead-out to add in milliseconds, or 0 for none
+
+		bool adjacent = false;     ///< Make adjacent lines continuous
+		int adjacent_gap = 0;      ///< Maximum gap in milliseconds to close
+		int adjacent_overlap = 0;  ///< Maximum overlap in milliseconds to remove
+		double adjacent_bias = 0;  ///< 0 moves the next line's start, 1 the previous line's end
+
+		bool keyframes = false;    ///< Snap to keyframes
+		int before_start = 0;      ///< Maximum distance to move a start time backwards
+		int after_start = 0;       ///< Maximum distance to move a start time forwards
+		int before_end = 0;        ///< Maximum distance to move an end time backwards
+		int after_end = 0;         ///< Maximum distance to move an end time forwards
+	};
+
+	/// New times for a line
+	struct Change {
+		AssDialogue *line;
+		int start;
+		int end;
+	};
+
+	/// @param lines Lines which may be processed
+	/// @param style_names Styles which can be enabled, in the order used for
+	///                    the enabled flags passed to the other functions
+	TimingProcessor(std::vector<AssDialogue *> lines, std::vector<std::string> const& style_names);
+
+	/// Get a line in one of the enabled styles whose end is before its start,
+	/// which the processor can't handle
+	AssDialogue *FindInvalidLine(std::vector<bool> const& style_enabled) const;
+
+	/// Work out the new times for the lines in the enabled styles
+	/// @param kf Keyframes to snap to, which are skipped if their times aren't available
+	/// @param fps Timecodes used to convert between times and frames for snapping
+	/// @param video_end_frame Last frame of the video, which is snapped to as
+	///                        if it was a keyframe, or -1 if there isn't one
+	/// @return The lines whose times would change
+	std::vector<Change> Run(Settings const& settings, std::vector<bool> const& style_enabled,
+		KeyframeIndex const& kf, agi::vfr::Framerate const& fps, int video_end_frame) const;
+};
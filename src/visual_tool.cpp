@@ -25,6 +25,7 @@
 #include "ass_style.h"
 #include "auto4_base.h"
 #include "compat.h"
+#include "dialogue_time_index.h"
 #include "include/aegisub/context.h"
 #include "options.h"
 #include "selection_controller.h"
@@ -69,6 +70,7 @@ VisualToolBase::VisualToolBase(VideoDisplay *parent, agi::Context *context)
 void VisualToolBase::OnCommit(int type) {
 	holding = false;
 	dragging = false;
+	parsed_tags.Clear();
 
 	if (type == AssFile::COMMIT_NEW || type & AssFile::COMMIT_SCRIPTINFO) {
 		int script_w, script_h;
@@ -123,6 +125,22 @@ bool VisualToolBase::IsDisplayed(AssDialogue *line) const {
 		&& c->videoController->FrameAtTime(line->End, agi::vfr::END) >= frame;
 }
 
+std::vector<AssDialogue *> VisualToolBase::GetDisplayedLines() const {
+	// Every line displayed on the frame overlaps the frame's time, so look up
+	// the lines near it and then filter them down to the exact set
+	int frame = c->videoController->GetFrameN();
+	auto lines = c->timeIndex->LinesOverlapping(
+		c->videoController->TimeAtFrame(frame - 1),
+		c->videoController->TimeAtFrame(frame + 1) + 1);
+	lines.erase(std::remove_if(begin(lines), end(lines), [&](AssDialogue *line) {
+		return !IsDisplayed(line);
+	}), end(lines));
+	std::sort(begin(lines), end(lines), [](const AssDialogue *a, const AssDialogue *b) {
+		return a->Row < b->Row;
+	});
+	return lines;
+}
+
 void VisualToolBase::Commit(wxString message) {
 	file_changed_connection.Block();
 	if (message.empty())
@@ -130,6 +148,7 @@ void VisualToolBase::Commit(wxString message) {
 
 	commit_id = c->ass->Commit(message, AssFile::COMMIT_DIAG_TEXT, commit_id);
 	file_changed_connection.Unblock();
+	parsed_tags.Clear();
 }
 
 AssDialogue* VisualToolBase::GetActiveDialogueLine() {
@@ -345,7 +364,7 @@ void VisualTool<FeatureType>::RemoveSelection(FeatureType *feat) {
 typedef const std::vector<AssOverrideParameter> * param_vec;
 
 // Find a tag's parameters in a line or return nullptr if it's not found
-static param_vec find_tag(std::vector<std::unique_ptr<AssDialogueBlock>>& blocks, std::string const& tag_name) {
+static param_vec find_tag(std::vector<std::unique_ptr<AssDialogueBlock>> const& blocks, std::string const& tag_name) {
 	for (auto ovr : blocks | agi::of_type<AssDialogueBlockOverride>()) {
 		for (auto const& tag : ovr->Tags) {
 			if (tag.Name == tag_name)
@@ -368,10 +387,10 @@ static Vector2D vec_or_bad(param_vec tag, size_t x_idx, size_t y_idx) {
 }
 
 Vector2D VisualToolBase::GetLinePosition(AssDialogue *diag) {
-	auto blocks = diag->ParseTags();
+	auto blocks = diag->GetParsedTags(parsed_tags);
 
-	if (Vector2D ret = vec_or_bad(find_tag(blocks, "\\pos"), 0, 1)) return ret;
-	if (Vector2D ret = vec_or_bad(find_tag(blocks, "\\move"), 0, 1)) return ret;
+	if (Vector2D ret = vec_or_bad(find_tag(*blocks, "\\pos"), 0, 1)) return ret;
+	if (Vector2D ret = vec_or_bad(find_tag(*blocks, "\\move"), 0, 1)) return ret;
 
 	// Get default position
 	auto margin = diag->Margin;
@@ -387,9 +406,9 @@ Vector2D VisualToolBase::GetLinePosition(AssDialogue *diag) {
 
 	param_vec align_tag;
 	int ovr_align = 0;
-	if ((align_tag = find_tag(blocks, "\\an")))
+	if ((align_tag = find_tag(*blocks, "\\an")))
 		ovr_align = (*align_tag)[0].Get<int>(ovr_align);
-	else if ((align_tag = find_tag(blocks, "\\a")))
+	else if ((align_tag = find_tag(*blocks, "\\a")))
 		ovr_align = AssStyle::SsaToAss((*align_tag)[0].Get<int>(2));
 
 	if (ovr_align > 0 && ovr_align <= 9)
@@ -419,14 +438,14 @@ Vector2D VisualToolBase::GetLinePosition(AssDialogue *diag) {
 }
 
 Vector2D VisualToolBase::GetLineOrigin(AssDialogue *diag) {
-	auto blocks = diag->ParseTags();
-	return vec_or_bad(find_tag(blocks, "\\org"), 0, 1);
+	auto blocks = diag->GetParsedTags(parsed_tags);
+	return vec_or_bad(find_tag(*blocks, "\\org"), 0, 1);
 }
 
 bool VisualToolBase::GetLineMove(AssDialogue *diag, Vector2D &p1, Vector2D &p2, int &t1, int &t2) {
-	auto blocks = diag->ParseTags();
+	auto blocks = diag->GetParsedTags(parsed_tags);
 
-	param_vec tag = find_tag(blocks, "\\move");
+	param_vec tag = find_tag(*blocks, "\\move");
 	if (!tag)
 		return false;
 
@@ -445,26 +464,26 @@ void VisualToolBase::GetLineRotation(AssDialogue *diag, float &rx, float &ry, fl
 	if (AssStyle *style = c->ass->GetStyle(diag->Style))
 		rz = style->angle;
 
-	auto blocks = diag->ParseTags();
+	auto blocks = diag->GetParsedTags(parsed_tags);
 
-	if (param_vec tag = find_tag(blocks, "\\frx"))
+	if (param_vec tag = find_tag(*blocks, "\\frx"))
 		rx = tag->front().Get(rx);
-	if (param_vec tag = find_tag(blocks, "\\fry"))
+	if (param_vec tag = find_tag(*blocks, "\\fry"))
 		ry = tag->front().Get(ry);
-	if (param_vec tag = find_tag(blocks, "\\frz"))
+	if (param_vec tag = find_tag(*blocks, "\\frz"))
 		rz = tag->front().Get(rz);
-	else if ((tag = find_tag(blocks, "\\fr")))
+	else if ((tag = find_tag(*blocks, "\\fr")))
 		rz = tag->front().Get(rz);
 }
 
 void VisualToolBase::GetLineShear(AssDialogue *diag, float& fax, float& fay) {
 	fax = fay = 0.f;
 
-	auto blocks = diag->ParseTags();
+	auto blocks = diag->GetParsedTags(parsed_tags);
 
-	if (param_vec tag = find_tag(blocks, "\\fax"))
+	if (param_vec tag = find_tag(*blocks, "\\fax"))
 		fax = tag->front().Get(fax);
-	if (param_vec tag = find_tag(blocks, "\\fay"))
+	if (param_vec tag = find_tag(*blocks, "\\fay"))
 		fay = tag->front().Get(fay);
 }
 
@@ -476,11 +495,11 @@ void VisualToolBase::GetLineScale(AssDialogue *diag, Vector2D &scale) {
 		y = style->scaley;
 	}
 
-	auto blocks = diag->ParseTags();
+	auto blocks = diag->GetParsedTags(parsed_tags);
 
-	if (param_vec tag = find_tag(blocks, "\\fscx"))
+	if (param_vec tag = find_tag(*blocks, "\\fscx"))
 		x = tag->front().Get(x);
-	if (param_vec tag = find_tag(blocks, "\\fscy"))
+	if (param_vec tag = find_tag(*blocks, "\\fscy"))
 		y = tag->front().Get(y);
 
 	scale = Vector2D(x, y);
@@ -494,15 +513,15 @@ void VisualToolBase::GetLineOutline(AssDialogue *diag, Vector2D &outline) {
 		y = style->outline_w;
 	}
 
-	auto blocks = diag->ParseTags();
+	auto blocks = diag->GetParsedTags(parsed_tags);
 
-	if (param_vec tag = find_tag(blocks, "\\bord")) {
+	if (param_vec tag = find_tag(*blocks, "\\bord")) {
 		x = tag->front().Get(x);
 		y = tag->front().Get(y);
 	}
-	if (param_vec tag = find_tag(blocks, "\\xbord"))
+	if (param_vec tag = find_tag(*blocks, "\\xbord"))
 		x = tag->front().Get(x);
-	if (param_vec tag = find_tag(blocks, "\\ybord"))
+	if (param_vec tag = find_tag(*blocks, "\\ybord"))
 		y = tag->front().Get(y);
 
 	outline = Vector2D(x, y);
@@ -516,15 +535,15 @@ void VisualToolBase::GetLineShadow(AssDialogue *diag, Vector2D &shadow) {
 		y = style->shadow_w;
 	}
 
-	auto blocks = diag->ParseTags();
+	auto blocks = diag->GetParsedTags(parsed_tags);
 
-	if (param_vec tag = find_tag(blocks, "\\shad")) {
+	if (param_vec tag = find_tag(*blocks, "\\shad")) {
 		x = tag->front().Get(x);
 		y = tag->front().Get(y);
 	}
-	if (param_vec tag = find_tag(blocks, "\\xshad"))
+	if (param_vec tag = find_tag(*blocks, "\\xshad"))
 		x = tag->front().Get(x);
-	if (param_vec tag = find_tag(blocks, "\\yshad"))
+	if (param_vec tag = find_tag(*blocks, "\\yshad"))
 		y = tag->front().Get(y);
 
 	shadow = Vector2D(x, y);
@@ -535,8 +554,8 @@ int VisualToolBase::GetLineAlignment(AssDialogue *diag) {
 
 	if (AssStyle *style = c->ass->GetStyle(diag->Style))
 		an = style->alignment;
-	auto blocks = diag->ParseTags();
-	if (param_vec tag = find_tag(blocks, "\\an"))
+	auto blocks = diag->GetParsedTags(parsed_tags);
+	if (param_vec tag = find_tag(*blocks, "\\an"))
 		an = tag->front().Get(an);
 
 	return an;
@@ -553,13 +572,13 @@ std::pair<Vector2D, Vector2D> VisualToolBase::GetLineBaseExtents(AssDialogue *di
 		style.scaley = 100.;
 	}
 
-	auto blocks = diag->ParseTags();
-	param_vec ptag = find_tag(blocks, "\\p");
+	auto blocks = diag->GetParsedTags(parsed_tags);
+	param_vec ptag = find_tag(*blocks, "\\p");
 
 	if (ptag && ptag->front().Get(0)) {		// A drawing
 		Spline spline;
 		spline.SetScale(ptag->front().Get(1));
-		std::string drawing_text = join(blocks | agi::of_type<AssDialogueBlockDrawing>() | boost::adaptors::transformed([&](AssDialogueBlock *d) { return d->GetText(); }), "");
+		std::string drawing_text = join(*blocks | agi::of_type<AssDialogueBlockDrawing>() | boost::adaptors::transformed([&](const AssDialogueBlockDrawing *d) { return d->text; }), "");
 		spline.DecodeFromAss(drawing_text);
 
 		if (!spline.size())
@@ -581,9 +600,9 @@ std::pair<Vector2D, Vector2D> VisualToolBase::GetLineBaseExtents(AssDialogue *di
 
 		return std::make_pair(Vector2D(left, top), Vector2D(right, bot));
 	} else {
-		if (param_vec tag = find_tag(blocks, "\\fs"))
+		if (param_vec tag = find_tag(*blocks, "\\fs"))
 			style.fontsize = tag->front().Get(style.fontsize);
-		if (param_vec tag = find_tag(blocks, "\\fn"))
+		if (param_vec tag = find_tag(*blocks, "\\fn"))
 			style.font = tag->front().Get(style.font);
 
 		std::string text = diag->GetStrippedText();
@@ -611,12 +630,12 @@ std::pair<Vector2D, Vector2D> VisualToolBase::GetLineBaseExtents(AssDialogue *di
 void VisualToolBase::GetLineClip(AssDialogue *diag, Vector2D &p1, Vector2D &p2, bool &inverse) {
 	inverse = false;
 
-	auto blocks = diag->ParseTags();
-	param_vec tag = find_tag(blocks, "\\iclip");
+	auto blocks = diag->GetParsedTags(parsed_tags);
+	param_vec tag = find_tag(*blocks, "\\iclip");
 	if (tag)
 		inverse = true;
 	else
-		tag = find_tag(blocks, "\\clip");
+		tag = find_tag(*blocks, "\\clip");
 
 	if (tag && tag->size() == 4) {
 		p1 = vec_or_bad(tag, 0, 1);
@@ -629,16 +648,16 @@ void VisualToolBase::GetLineClip(AssDialogue *diag, Vector2D &p1, Vector2D &p2,
 }
 
 std::string VisualToolBase::GetLineVectorClip(AssDialogue *diag, int &scale, bool &inverse) {
-	auto blocks = diag->ParseTags();
+	auto blocks = diag->GetParsedTags(parsed_tags);
 
 	scale = 1;
 	inverse = false;
 
-	param_vec tag = find_tag(blocks, "\\iclip");
+	param_vec tag = find_tag(*blocks, "\\iclip");
 	if (tag)
 		inverse = true;
 	else
-		tag = find_tag(blocks, "\\clip");
+		tag = find_tag(*blocks, "\\clip");
 
 	if (tag && tag->size() == 4) {
 		return agi::format("m %.2f %.2f l %.2f %.2f %.2f %.2f %.2f %.2f"
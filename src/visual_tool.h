@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include "ass_dialogue.h"
 #include "gl_wrap.h"
 #include "vector2d.h"
 #include "options.h"
@@ -29,7 +30,6 @@
 
 #include <set>
 
-class AssDialogue;
 class VideoDisplay;
 class wxMouseCaptureLostEvent;
 class wxMouseEvent;
@@ -115,10 +115,15 @@ protected:
 	agi::signal::Connection file_changed_connection;
 	int commit_id = -1; ///< Last used commit id for coalescing
 
+	/// Parsed tags of the lines the tool has looked at since the last commit
+	ParsedTagsCache parsed_tags;
+
 	/// @brief Commit the current file state
 	/// @param message Description of changes for undo
 	virtual void Commit(wxString message = wxString());
 	bool IsDisplayed(AssDialogue *line) const;
+	/// Get all of the lines displayed on the current frame, in file order
+	std::vector<AssDialogue *> GetDisplayedLines() const;
 
 	/// Get the line's position if it's set, or it's default based on style if not
 	Vector2D GetLinePosition(AssDialogue *diag);
@@ -35,6 +35,7 @@
 
 #include <algorithm>
 #include <boost/range/algorithm/binary_search.hpp>
+#include <limits>
 
 #include <wx/toolbar.h>
 
@@ -119,10 +120,8 @@ void VisualToolDrag::OnFileChanged() {
 	primary = nullptr;
 	active_feature = nullptr;
 
-	for (auto& diag : c->ass->Events) {
-		if (IsDisplayed(&diag))
-			MakeFeatures(&diag);
-	}
+	for (auto diag : GetDisplayedLines())
+		MakeFeatures(diag);
 
 	UpdateToggleButtons();
 }
@@ -134,25 +133,27 @@ void VisualToolDrag::OnFrameChanged() {
 	auto feat = features.begin();
 	auto end = features.end();
 
-	for (auto& diag : c->ass->Events) {
-		if (IsDisplayed(&diag)) {
-			// Features don't exist and should
-			if (feat == end || feat->line != &diag)
-				MakeFeatures(&diag, feat);
-			// Move past already existing features for the line
-			else
-				while (feat != end && feat->line == &diag) ++feat;
-		}
-		else {
-			// Remove all features for this line (if any)
-			while (feat != end && feat->line == &diag) {
-				if (&*feat == active_feature) active_feature = nullptr;
-				feat->line = nullptr;
-				RemoveSelection(&*feat);
-				feat = features.erase(feat);
-			}
+	// Features are kept in file order, so any features before the next
+	// displayed line are for lines which are no longer displayed
+	auto remove_features_before = [&](int row) {
+		while (feat != end && feat->line->Row < row) {
+			if (&*feat == active_feature) active_feature = nullptr;
+			feat->line = nullptr;
+			RemoveSelection(&*feat);
+			feat = features.erase(feat);
 		}
+	};
+
+	for (auto diag : GetDisplayedLines()) {
+		remove_features_before(diag->Row);
+		// Features don't exist and should
+		if (feat == end || feat->line != diag)
+			MakeFeatures(diag, feat);
+		// Move past already existing features for the line
+		else
+			while (feat != end && feat->line == diag) ++feat;
 	}
+	remove_features_before(std::numeric_limits<int>::max());
 }
 
 template<class C, class T> static bool line_not_present(C const& set, T const& it) {
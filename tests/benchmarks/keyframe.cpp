@@ -0,0 +1,108 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file keyframe.cpp
+/// @brief agi::keyframe loading and saving throughput
+/// @ingroup video_input
+///
+/// Run with `meson test --benchmark`. This isn't part of the unit tests as
+/// the stats file it generates is over 100 MB.
+
+#include <libaegisub/dispatch.h>
+#include <libaegisub/fs.h>
+#include <libaegisub/keyframe.h>
+#include <libaegisub/log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+/// Number of times each operation is timed, with the fastest run reported
+const int runs = 5;
+
+/// Time the fastest of several runs of a function, in seconds
+double best_time(std::function<void ()> const& func) {
+	double best = 0;
+	for (int i = 0; i < runs; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (i == 0 || elapsed.count() < best)
+			best = elapsed.count();
+	}
+	return best;
+}
+
+void report(const char *name, double seconds, uintmax_t bytes, size_t lines) {
+	printf("%-12s %8.1f ms %8.1f MB/s %8.2f M lines/s\n", name, seconds * 1000,
+		bytes / seconds / (1024 * 1024), lines / seconds / 1000000);
+}
+}
+
+int main(int argc, char **argv) {
+	agi::dispatch::Init([](agi::dispatch::Thunk) { });
+	agi::log::log = new agi::log::LogSink;
+
+	// A synthetic stats file for a roughly 11 hour 24 fps encode
+	int frames = argc > 1 ? std::stoi(argv[1]) : 1000000;
+	agi::fs::path stats = "keyframe_bench.log";
+	agi::fs::path aegi = "keyframe_bench_out.txt";
+
+	std::vector<int> expected;
+	{
+		std::ofstream of(stats.string());
+		of << "#options: 1920x1080 fps=24000/1001 timebase=1/1000000000 cabac=1\n";
+		for (int i = 0; i < frames; ++i) {
+			char type = i % 250 == 0 ? 'I' : i % 3 ? 'P' : 'B';
+			if (type == 'I') expected.push_back(i);
+			of << "in:" << i << " out:" << i << " type:" << type
+			   << " dur:41708333 cpbdur:41708333 q:20.09 tex:3977 mv:5546"
+			   << " misc:4901 imb:1350 pmb:0 smb:0 d:- ref:0 ;\n";
+		}
+	}
+
+	int ret = 0;
+	try {
+		std::vector<int> res;
+		double time = best_time([&] { res = agi::keyframe::Load(stats); });
+		report("x264 load", time, agi::fs::Size(stats), frames);
+		if (res != expected) {
+			fprintf(stderr, "Wrong keyframes loaded from the x264 stats file\n");
+			ret = 1;
+		}
+
+		time = best_time([&] { agi::keyframe::Save(aegi, res); });
+		report("aegi save", time, agi::fs::Size(aegi), res.size());
+		time = best_time([&] { res = agi::keyframe::Load(aegi); });
+		report("aegi load", time, agi::fs::Size(aegi), res.size());
+		if (res != expected) {
+			fprintf(stderr, "Wrong keyframes loaded from the saved file\n");
+			ret = 1;
+		}
+	}
+	catch (agi::Exception const& e) {
+		fprintf(stderr, "%s\n", e.GetMessage().c_str());
+		ret = 1;
+	}
+
+	agi::fs::Remove(stats);
+	agi::fs::Remove(aegi);
+	delete agi::log::log;
+	return ret;
+}
@@ -0,0 +1,264 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file mkv.cpp
+/// @brief Matroska scanning and subtitle extraction throughput
+/// @ingroup video_input
+///
+/// Run with `meson test --benchmark`. This isn't part of the unit tests as
+/// the Matroska file it generates is a few hundred MB.
+
+#include <mkv_stdio.h>
+
+#include <libaegisub/fs.h>
+#include <libaegisub/scoped_ptr.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+
+namespace {
+/// Number of times each operation is timed, with the fastest run reported
+const int runs = 5;
+
+/// Time the fastest of several runs of a function, in seconds
+double best_time(std::function<void ()> const& func) {
+	double best = 0;
+	for (int i = 0; i < runs; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (i == 0 || elapsed.count() < best)
+			best = elapsed.count();
+	}
+	return best;
+}
+
+void report(const char *name, double seconds, uint64_t bytes, size_t items) {
+	printf("%-12s %8.1f ms %8.1f MB/s %8.2f M items/s\n", name, seconds * 1000,
+		bytes / seconds / (1024 * 1024), items / seconds / 1000000);
+}
+
+/// Append a big-endian integer of the given width
+void put_uint(std::string& out, uint64_t value, int bytes) {
+	for (int i = bytes - 1; i >= 0; --i)
+		out += static_cast<char>(value >> (i * 8));
+}
+
+/// Append an EBML element. Sizes are always written with eight bytes, so
+/// that the size of an element doesn't depend on the offsets it contains.
+void element(std::string& out, uint32_t id, std::string const& data) {
+	put_uint(out, id, id > 0xFFFFFF ? 4 : id > 0xFFFF ? 3 : id > 0xFF ? 2 : 1);
+	out += '\x01';
+	put_uint(out, data.size(), 7);
+	out += data;
+}
+
+void uint_element(std::string& out, uint32_t id, uint64_t value) {
+	std::string data;
+	put_uint(data, value, 8);
+	element(out, id, data);
+}
+
+void float_element(std::string& out, uint32_t id, double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof bits);
+	std::string data;
+	put_uint(data, bits, 8);
+	element(out, id, data);
+}
+
+/// A Block for a track with no lacing
+std::string block(int track, int relative_time, std::string const& payload) {
+	std::string data;
+	data += static_cast<char>(0x80 | track);
+	put_uint(data, static_cast<uint16_t>(relative_time), 2);
+	data += '\0';
+	data += payload;
+	return data;
+}
+
+struct File {
+	std::string data;
+	size_t subtitles = 0;
+	size_t clusters = 0;
+};
+
+/// Build a file with a video track of filler frames and an ASS subtitle
+/// track, with one cluster per second and a cue point for every cluster
+File build(size_t seconds, size_t video_frame_size) {
+	File file;
+
+	std::string ebml;
+	uint_element(ebml, 0x4286, 1); // EBMLVersion
+	uint_element(ebml, 0x42F7, 1); // EBMLReadVersion
+	uint_element(ebml, 0x42F2, 4); // EBMLMaxIDLength
+	uint_element(ebml, 0x42F3, 8); // EBMLMaxSizeLength
+	element(ebml, 0x4282, "matroska"); // DocType
+	uint_element(ebml, 0x4287, 2); // DocTypeVersion
+	uint_element(ebml, 0x4285, 2); // DocTypeReadVersion
+	element(file.data, 0x1A45DFA3, ebml);
+
+	std::string info;
+	uint_element(info, 0x2AD7B1, 1000000); // TimecodeScale
+	float_element(info, 0x4489, seconds * 1000.0); // Duration
+	element(info, 0x4D80, "aegisub benchmark"); // MuxingApp
+	element(info, 0x5741, "aegisub benchmark"); // WritingApp
+
+	std::string video, subs, tracks;
+	uint_element(video, 0xD7, 1); // TrackNumber
+	uint_element(video, 0x73C5, 1); // TrackUID
+	uint_element(video, 0x83, 1); // TrackType
+	element(video, 0x86, "V_UNCOMPRESSED"); // CodecID
+	element(tracks, 0xAE, video);
+	uint_element(subs, 0xD7, 2);
+	uint_element(subs, 0x73C5, 2);
+	uint_element(subs, 0x83, 0x11);
+	element(subs, 0x86, "S_TEXT/ASS");
+	element(subs, 0x63A2, "[Script Info]\r\nScriptType: v4.00+\r\n\r\n[V4+ Styles]\r\n"
+		"Format: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, Italic, Underline, StrikeOut, ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\r\n"
+		"Style: Default,Arial,20,&H00FFFFFF,&H000000FF,&H00000000,&H00000000,0,0,0,0,100,100,0,0,1,2,2,2,10,10,10,1\r\n"); // CodecPrivate
+	element(tracks, 0xAE, subs);
+
+	// Clusters start after the SeekHead, Info and Tracks. The SeekHead's
+	// size doesn't depend on the position of the cues in it, as every size
+	// and value is written with eight bytes.
+	auto make_seek_head = [](uint64_t cues_pos) {
+		std::string seek, id, out;
+		put_uint(id, 0x1C53BB6B, 4);
+		element(seek, 0x53AB, id); // SeekID
+		uint_element(seek, 0x53AC, cues_pos); // SeekPosition
+		element(out, 0x4DBB, seek); // Seek
+		return out;
+	};
+	std::string seek_head;
+	element(seek_head, 0x114D9B74, make_seek_head(0));
+
+	std::string segment_head;
+	element(segment_head, 0x1549A966, info);
+	element(segment_head, 0x1654AE6B, tracks);
+	uint64_t pos = seek_head.size() + segment_head.size();
+
+	std::string video_payload(video_frame_size, '\x10');
+	std::string clusters, cues;
+	for (size_t s = 0; s < seconds; ++s) {
+		std::string cue, cue_pos;
+		uint_element(cue, 0xB3, s * 1000); // CueTime
+		uint_element(cue_pos, 0xF7, 1); // CueTrack
+		uint_element(cue_pos, 0xF1, pos); // CueClusterPosition
+		element(cue, 0xB7, cue_pos); // CueTrackPositions
+		element(cues, 0xBB, cue); // CuePoint
+
+		std::string cluster;
+		uint_element(cluster, 0xE7, s * 1000); // Timecode
+		element(cluster, 0xA3, block(1, 0, video_payload)); // SimpleBlock
+
+		// Two overlapping lines a second, as in typical dialogue
+		for (int i = 0; i < 2; ++i) {
+			std::string line = std::to_string(file.subtitles) + ",0,Default,,0,0,0,,"
+				"{\\i1}Line " + std::to_string(file.subtitles) + " of the benchmark script{\\i0}";
+			std::string group;
+			element(group, 0xA1, block(2, i * 500, line)); // Block
+			uint_element(group, 0x9B, 1500); // BlockDuration
+			element(cluster, 0xA0, group); // BlockGroup
+			++file.subtitles;
+		}
+
+		std::string tmp;
+		element(tmp, 0x1F43B675, cluster);
+		pos += tmp.size();
+		clusters += tmp;
+		++file.clusters;
+	}
+
+	std::string segment;
+	element(segment, 0x114D9B74, make_seek_head(pos));
+	segment += segment_head;
+	segment += clusters;
+	element(segment, 0x1C53BB6B, cues);
+	element(file.data, 0x18538067, segment);
+	return file;
+}
+}
+
+int main(int argc, char **argv) {
+	// A bit under six hours at one cluster per second
+	size_t seconds = argc > 1 ? std::stoul(argv[1]) : 20000;
+	const char *path = "mkv_bench.mkv";
+
+	File expected = build(seconds, 16 * 1024);
+	{
+		std::ofstream of(path, std::ios::binary);
+		of.write(expected.data.data(), expected.data.size());
+	}
+	uint64_t size = expected.data.size();
+
+	int ret = 0;
+	MkvStdIO input(path);
+	char err[2048];
+
+	// Opening reads the cues and scans backwards from the end for the last
+	// cluster to find the real duration
+	double time = best_time([&] {
+		agi::scoped_holder<MatroskaFile*, decltype(&mkv_Close)> file(mkv_Open(&input, err, sizeof(err)), mkv_Close);
+		if (!file) {
+			fprintf(stderr, "Opening the file failed: %s\n", err);
+			ret = 1;
+		}
+	});
+	report("open", time, size, expected.clusters);
+	if (ret) return ret;
+
+	// Resyncing after every cluster, which is the worst case for damaged files
+	size_t clusters = 0;
+	time = best_time([&] {
+		clusters = 0;
+		for (int64_t pos = input.scan(&input, 0, 0x1F43B675); pos >= 0; pos = input.scan(&input, pos + 1, 0x1F43B675))
+			++clusters;
+	});
+	report("scan", time, size, clusters);
+	if (clusters != expected.clusters) {
+		fprintf(stderr, "Scanning found %zu clusters, expected %zu\n", clusters, expected.clusters);
+		ret = 1;
+	}
+
+	size_t lines = 0;
+	time = best_time([&] {
+		agi::scoped_holder<MatroskaFile*, decltype(&mkv_Close)> file(mkv_Open(&input, err, sizeof(err)), mkv_Close);
+		mkv_SetTrackMask(file, ~(1 << 1));
+
+		uint64_t startTime, endTime, filePos;
+		unsigned int rt, frameSize, frameFlags;
+		std::string line;
+		int order;
+		lines = 0;
+		while (mkv_ReadFrame(file, 0, &rt, &startTime, &endTime, &filePos, &frameSize, &frameFlags) == 0) {
+			const char *buf = input.file.read(filePos, frameSize);
+			if (MkvSsaBlockToLine(buf, buf + frameSize, startTime / 1000000, endTime / 1000000, line, order))
+				++lines;
+		}
+	});
+	report("extract", time, size, lines);
+	if (lines != expected.subtitles) {
+		fprintf(stderr, "Extracted %zu lines, expected %zu\n", lines, expected.subtitles);
+		ret = 1;
+	}
+
+	remove(path);
+	return ret;
+}
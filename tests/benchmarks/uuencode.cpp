@@ -0,0 +1,90 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file uuencode.cpp
+/// @brief agi::ass::UUEncode and UUDecode throughput
+/// @ingroup subs_storage
+///
+/// Run with `meson test --benchmark`. This isn't part of the unit tests as
+/// timings on shared machines are too noisy to fail a build on.
+
+#include <libaegisub/ass/uuencode.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+/// Number of times each operation is timed, with the fastest run reported
+const int runs = 5;
+
+/// Time the fastest of several runs of a function, in seconds
+double best_time(std::function<void ()> const& func) {
+	double best = 0;
+	for (int i = 0; i < runs; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (i == 0 || elapsed.count() < best)
+			best = elapsed.count();
+	}
+	return best;
+}
+
+/// Report throughput in terms of the size of the unencoded data
+void report(const char *name, double seconds, size_t bytes) {
+	printf("%-20s %8.1f ms %8.1f MB/s\n", name, seconds * 1000,
+		bytes / seconds / (1024 * 1024));
+}
+}
+
+int main(int argc, char **argv) {
+	// Roughly the size of a large CJK font attachment
+	size_t size = argc > 1 ? std::stoul(argv[1]) : 32 * 1024 * 1024;
+
+	std::vector<char> data(size);
+	std::mt19937 rng(0);
+	std::uniform_int_distribution<int> byte(0, 255);
+	for (auto& c : data)
+		c = static_cast<char>(byte(rng));
+
+	int ret = 0;
+	std::string encoded;
+	double time = best_time([&] { encoded = agi::ass::UUEncode(data.data(), data.data() + data.size()); });
+	report("encode", time, size);
+
+	std::string unbroken;
+	time = best_time([&] { unbroken = agi::ass::UUEncode(data.data(), data.data() + data.size(), false); });
+	report("encode (no breaks)", time, size);
+
+	std::vector<char> decoded;
+	time = best_time([&] { decoded = agi::ass::UUDecode(&encoded[0], &encoded[0] + encoded.size()); });
+	report("decode", time, size);
+	if (decoded != data) {
+		fprintf(stderr, "Decoding the encoded data did not give the original data\n");
+		ret = 1;
+	}
+
+	time = best_time([&] { decoded = agi::ass::UUDecode(&unbroken[0], &unbroken[0] + unbroken.size()); });
+	report("decode (no breaks)", time, size);
+	if (decoded != data) {
+		fprintf(stderr, "Decoding the unbroken data did not give the original data\n");
+		ret = 1;
+	}
+
+	return ret;
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file ass_dialogue.cpp
+/// @brief AssDialogue tests
+/// @ingroup subs_storage
+
+#include <ass_dialogue.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <main.h>
+
+namespace {
+const char *line_data = "Dialogue: 0,0:00:01.00,0:00:02.50,Default,Actor,0,0,0,Effect,Some {\\i1}text";
+}
+
+TEST(ass_dialogue, entry_data_round_trip) {
+	AssDialogue line(line_data);
+	EXPECT_EQ(line_data, line.GetEntryData());
+	EXPECT_EQ(line_data, line.GetEntryData());
+}
+
+TEST(ass_dialogue, entry_data_tracks_edits) {
+	AssDialogue line(line_data);
+	std::string before = line.GetEntryData();
+
+	line.Text = "Other text";
+	EXPECT_EQ("Dialogue: 0,0:00:01.00,0:00:02.50,Default,Actor,0,0,0,Effect,Other text", line.GetEntryData());
+
+	line.Start = 500;
+	line.Style = "Sign";
+	EXPECT_EQ("Dialogue: 0,0:00:00.50,0:00:02.50,Sign,Actor,0,0,0,Effect,Other text", line.GetEntryData());
+
+	line.Comment = true;
+	line.Layer = 3;
+	line.Margin[1] = 20;
+	EXPECT_EQ("Comment: 3,0:00:00.50,0:00:02.50,Sign,Actor,0,20,0,Effect,Other text", line.GetEntryData());
+
+	// Going back to the original values gives the original string
+	line.Text = "Some {\\i1}text";
+	line.Start = 1000;
+	line.Style = "Default";
+	line.Comment = false;
+	line.Layer = 0;
+	line.Margin[1] = 0;
+	EXPECT_EQ(before, line.GetEntryData());
+}
+
+TEST(ass_dialogue, entry_data_returned_string_outlives_edits) {
+	AssDialogue line(line_data);
+	std::string before = line.GetEntryData();
+	line.Actor = "Someone else";
+	std::string after = line.GetEntryData();
+	EXPECT_EQ(line_data, before);
+	EXPECT_NE(before, after);
+}
+
+TEST(ass_dialogue, entry_data_copies_are_independent) {
+	AssDialogue line(line_data);
+	line.GetEntryData();
+
+	AssDialogue copy(line);
+	copy.Effect = "";
+	EXPECT_EQ("Dialogue: 0,0:00:01.00,0:00:02.50,Default,Actor,0,0,0,,Some {\\i1}text", copy.GetEntryData());
+	EXPECT_EQ(line_data, line.GetEntryData());
+}
+
+TEST(ass_dialogue, entry_data_concurrent_readers) {
+	AssDialogue line(line_data);
+	std::vector<std::thread> threads;
+	std::vector<int> mismatches(4);
+	for (size_t i = 0; i < mismatches.size(); ++i) {
+		threads.emplace_back([&, i] {
+			for (int j = 0; j < 1000; ++j) {
+				if (line.GetEntryData() != line_data)
+					++mismatches[i];
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	for (int count : mismatches)
+		EXPECT_EQ(0, count);
+}
+
+namespace {
+/// Get the text of the plain blocks of some parsed tags
+std::string plain_text(std::vector<std::unique_ptr<AssDialogueBlock>> const& blocks) {
+	std::string text;
+	for (auto const& block : blocks) {
+		if (block->GetType() == AssBlockType::PLAIN)
+			text += block->GetText();
+	}
+	return text;
+}
+}
+
+TEST(ass_dialogue, parsed_tags_cache_hit) {
+	ParsedTagsCache cache;
+	AssDialogue a, b;
+	a.Text = "{\\i1}same";
+	b.Text = "{\\i1}same";
+
+	auto blocks = a.GetParsedTags(cache);
+	EXPECT_EQ(blocks, a.GetParsedTags(cache));
+	EXPECT_EQ(blocks, b.GetParsedTags(cache));
+	EXPECT_EQ(1u, cache.Size());
+}
+
+TEST(ass_dialogue, parsed_tags_cache_miss) {
+	ParsedTagsCache cache;
+	AssDialogue a, b;
+	a.Text = "{\\i1}one";
+	b.Text = "{\\i1}two";
+
+	auto blocks_a = a.GetParsedTags(cache);
+	auto blocks_b = b.GetParsedTags(cache);
+	EXPECT_NE(blocks_a, blocks_b);
+	EXPECT_EQ("one", plain_text(*blocks_a));
+	EXPECT_EQ("two", plain_text(*blocks_b));
+	EXPECT_EQ(2u, cache.Size());
+}
+
+TEST(ass_dialogue, parsed_tags_cache_follows_edits) {
+	ParsedTagsCache cache;
+	AssDialogue line;
+	line.Text = "{\\pos(1,2)}before";
+	auto before = line.GetParsedTags(cache);
+
+	// The entry for the old text must not be returned for the new one, even
+	// though nothing but the cache uses the old text any more
+	line.Text = "{\\pos(3,4)}after";
+	auto after = line.GetParsedTags(cache);
+	EXPECT_NE(before, after);
+	EXPECT_EQ("before", plain_text(*before));
+	EXPECT_EQ("after", plain_text(*after));
+
+	line.Text = "{\\pos(1,2)}before";
+	EXPECT_EQ(before, line.GetParsedTags(cache));
+}
+
+TEST(ass_dialogue, parsed_tags_cache_clear) {
+	ParsedTagsCache cache;
+	AssDialogue line;
+	line.Text = "{\\b1}text";
+	auto blocks = line.GetParsedTags(cache);
+	cache.Clear();
+	EXPECT_EQ(0u, cache.Size());
+
+	// Blocks handed out before clearing stay valid
+	EXPECT_EQ("text", plain_text(*blocks));
+	auto reparsed = line.GetParsedTags(cache);
+	EXPECT_NE(blocks, reparsed);
+	EXPECT_EQ("text", plain_text(*reparsed));
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file ass_karaoke.cpp
+/// @brief AssKaraoke tests
+/// @ingroup subs_storage
+
+#include <ass_karaoke.h>
+
+#include <ass_dialogue.h>
+
+#include <string>
+#include <vector>
+
+#include <main.h>
+
+namespace {
+std::vector<std::string> tag_types(AssKaraoke const& kara) {
+	std::vector<std::string> ret;
+	for (auto const& syl : kara)
+		ret.push_back(syl.tag_type);
+	return ret;
+}
+}
+
+TEST(ass_karaoke, syllables) {
+	AssDialogue line("Dialogue: 0,0:00:01.00,0:00:02.00,Default,,0,0,0,,{\\k20}a{\\kf30\\i1}b{\\ko50}c");
+	AssKaraoke kara(&line, false, false);
+	ASSERT_EQ(3u, kara.size());
+	EXPECT_EQ((std::vector<std::string>{"\\k", "\\kf", "\\ko"}), tag_types(kara));
+
+	auto it = kara.begin();
+	EXPECT_EQ(1000, it->start_time);
+	EXPECT_EQ(200, it->duration);
+	EXPECT_EQ("a", it->text);
+	++it;
+	EXPECT_EQ(1200, it->start_time);
+	EXPECT_EQ(300, it->duration);
+	EXPECT_EQ("b", it->text);
+	EXPECT_EQ("{\\i1}b", it->GetText(false));
+	++it;
+	EXPECT_EQ(1500, it->start_time);
+	EXPECT_EQ(500, it->duration);
+}
+
+TEST(ass_karaoke, upper_case_k_is_kf) {
+	AssDialogue line("Dialogue: 0,0:00:00.00,0:00:01.00,Default,,0,0,0,,{\\K10}a{\\k10}b");
+	AssKaraoke kara(&line, false, false);
+	EXPECT_EQ((std::vector<std::string>{"\\kf", "\\k"}), tag_types(kara));
+}
+
+TEST(ass_karaoke, shared_parsed_tags_are_not_modified) {
+	ParsedTagsCache cache;
+	AssDialogue line("Dialogue: 0,0:00:00.00,0:00:01.00,Default,,0,0,0,,{\\K10}a{\\k10}b");
+	auto blocks = line.GetParsedTags(cache);
+
+	AssKaraoke kara;
+	kara.SetLine(&line, false, false, &cache);
+	EXPECT_EQ((std::vector<std::string>{"\\kf", "\\k"}), tag_types(kara));
+	EXPECT_EQ(1u, cache.Size());
+
+	// Converting \K to \kf mustn't leak into the blocks other users see
+	EXPECT_EQ("{\\K10}", (*blocks)[0]->GetText());
+
+	kara.SetLine(&line, false, false, &cache);
+	EXPECT_EQ((std::vector<std::string>{"\\kf", "\\k"}), tag_types(kara));
+}
@@ -0,0 +1,211 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file dialogue_time_index.cpp
+/// @brief LineTimeTree tests
+/// @ingroup subs_storage
+
+#include <ass_dialogue.h>
+#include <dialogue_time_index.h>
+
+#include <algorithm>
+#include <list>
+#include <random>
+#include <vector>
+
+#include <main.h>
+
+namespace {
+AssDialogue &add_line(std::list<AssDialogue> &lines, int start, int end) {
+	lines.emplace_back();
+	lines.back().Start = start;
+	lines.back().End = end;
+	return lines.back();
+}
+
+/// Check the tree against testing every line
+void check_overlapping(LineTimeTree const& tree, std::list<AssDialogue> &lines, int start, int end) {
+	std::vector<AssDialogue *> expected;
+	for (auto& line : lines) {
+		if (line.Start < end && line.End > start)
+			expected.push_back(&line);
+	}
+
+	auto actual = tree.LinesOverlapping(start, end);
+	EXPECT_TRUE(std::is_sorted(begin(actual), std::end(actual), [](AssDialogue *a, AssDialogue *b) {
+		return a->Start < b->Start;
+	}));
+
+	std::sort(begin(expected), std::end(expected));
+	std::sort(begin(actual), std::end(actual));
+	EXPECT_EQ(expected, actual) << "range [" << start << ", " << end << ")";
+}
+
+void check_all(LineTimeTree const& tree, std::list<AssDialogue> &lines) {
+	for (int start = 0; start < 1100; start += 50) {
+		for (int len : {1, 10, 100, 500})
+			check_overlapping(tree, lines, start, start + len);
+	}
+}
+}
+
+TEST(dialogue_time_index, empty) {
+	LineTimeTree tree;
+	tree.Assign(std::list<AssDialogue>());
+	EXPECT_TRUE(tree.LinesOverlapping(0, 1000).empty());
+}
+
+TEST(dialogue_time_index, overlapping) {
+	std::list<AssDialogue> lines;
+	auto &a = add_line(lines, 0, 100);
+	auto &b = add_line(lines, 50, 150);
+	auto &c = add_line(lines, 200, 300);
+	auto &d = add_line(lines, 10, 1000);
+
+	LineTimeTree tree;
+	tree.Assign(lines);
+
+	EXPECT_EQ((std::vector<AssDialogue *>{&a}), tree.LinesOverlapping(0, 10));
+	EXPECT_EQ((std::vector<AssDialogue *>{&a, &d}), tree.LinesOverlapping(0, 11));
+	EXPECT_EQ((std::vector<AssDialogue *>{&a, &d, &b}), tree.LinesOverlapping(60, 70));
+	// Ranges are half-open
+	EXPECT_EQ((std::vector<AssDialogue *>{&d, &b}), tree.LinesOverlapping(100, 200));
+	EXPECT_EQ((std::vector<AssDialogue *>{&d}), tree.LinesOverlapping(150, 200));
+	EXPECT_EQ((std::vector<AssDialogue *>{&d, &c}), tree.LinesOverlapping(250, 251));
+	EXPECT_TRUE(tree.LinesOverlapping(1000, 2000).empty());
+	check_all(tree, lines);
+}
+
+TEST(dialogue_time_index, retime_end_only) {
+	std::list<AssDialogue> lines;
+	for (int i = 0; i < 10; ++i)
+		add_line(lines, i * 100, i * 100 + 50);
+	LineTimeTree tree;
+	tree.Assign(lines);
+
+	auto &line = *std::next(begin(lines), 3);
+	line.End = 1050;
+	EXPECT_TRUE(tree.Retime(&line));
+	check_all(tree, lines);
+
+	line.End = 310;
+	EXPECT_TRUE(tree.Retime(&line));
+	check_all(tree, lines);
+}
+
+TEST(dialogue_time_index, retime_moves_line) {
+	std::list<AssDialogue> lines;
+	for (int i = 0; i < 10; ++i)
+		add_line(lines, i * 100, i * 100 + 50);
+	LineTimeTree tree;
+	tree.Assign(lines);
+
+	auto &line = *std::next(begin(lines), 3);
+
+	// Past the end
+	line.Start = 1000;
+	line.End = 1080;
+	EXPECT_TRUE(tree.Retime(&line));
+	EXPECT_EQ((std::vector<AssDialogue *>{&line}), tree.LinesOverlapping(1000, 1001));
+	check_all(tree, lines);
+
+	// To the start, after the line which was already there
+	line.Start = 0;
+	line.End = 20;
+	EXPECT_TRUE(tree.Retime(&line));
+	EXPECT_EQ((std::vector<AssDialogue *>{&lines.front(), &line}), tree.LinesOverlapping(0, 1));
+	check_all(tree, lines);
+
+	// Onto the same start time as another line
+	line.Start = 500;
+	line.End = 700;
+	EXPECT_TRUE(tree.Retime(&line));
+	check_all(tree, lines);
+}
+
+TEST(dialogue_time_index, retime_unknown_line) {
+	std::list<AssDialogue> lines;
+	add_line(lines, 0, 100);
+	LineTimeTree tree;
+	tree.Assign(lines);
+
+	AssDialogue other;
+	EXPECT_FALSE(tree.Retime(&other));
+	check_all(tree, lines);
+}
+
+TEST(dialogue_time_index, random_retimes) {
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> time(0, 1000);
+	std::uniform_int_distribution<int> length(0, 200);
+
+	std::list<AssDialogue> lines;
+	for (int i = 0; i < 37; ++i) {
+		int start = time(rng);
+		add_line(lines, start, start + length(rng));
+	}
+	LineTimeTree tree;
+	tree.Assign(lines);
+
+	std::uniform_int_distribution<size_t> pick(0, lines.size() - 1);
+	for (int i = 0; i < 200; ++i) {
+		auto &line = *std::next(begin(lines), pick(rng));
+		// Mostly small nudges, as from dragging a line in the audio display
+		if (i % 4) {
+			line.Start = line.Start + length(rng) / 10 - 10;
+			line.End = line.End + length(rng) / 10 - 10;
+		}
+		else {
+			line.Start = time(rng);
+			line.End = line.Start + length(rng);
+		}
+		ASSERT_TRUE(tree.Retime(&line));
+		check_all(tree, lines);
+	}
+}
+
+TEST(dialogue_time_index, add_remove) {
+	std::list<AssDialogue> lines;
+	for (int i = 0; i < 5; ++i)
+		add_line(lines, i * 100, i * 100 + 150);
+	LineTimeTree tree;
+	tree.Assign(lines);
+	check_all(tree, lines);
+
+	// Growing past a power of two adds a level to the tree
+	for (int i = 0; i < 10; ++i)
+		add_line(lines, 1000 - i * 70, 1050 - i * 30);
+	tree.Assign(lines);
+	check_all(tree, lines);
+
+	auto &line = *std::next(begin(lines), 7);
+	line.Start = 20;
+	EXPECT_TRUE(tree.Retime(&line));
+	check_all(tree, lines);
+
+	lines.erase(begin(lines), std::next(begin(lines), 9));
+	tree.Assign(lines);
+	check_all(tree, lines);
+
+	// Removed lines are no longer in the tree
+	std::list<AssDialogue> removed;
+	removed.splice(begin(removed), lines, begin(lines));
+	tree.Assign(lines);
+	EXPECT_FALSE(tree.Retime(&removed.front()));
+	check_all(tree, lines);
+
+	lines.clear();
+	tree.Assign(lines);
+	EXPECT_TRUE(tree.LinesOverlapping(0, 2000).empty());
+}
@@ -0,0 +1,179 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file keyframe_detector.cpp
+/// @brief SceneChangeDetector tests
+/// @ingroup video_input
+
+#include <keyframe_detector.h>
+#include <video_frame.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <main.h>
+
+namespace {
+/// Build a grey BGRX frame, with luma(x, y) giving each pixel's value
+VideoFrame make_frame(size_t width, size_t height, std::function<int (size_t, size_t)> const& luma, size_t padding = 0) {
+	VideoFrame frame;
+	frame.width = width;
+	frame.height = height;
+	frame.pitch = width * 4 + padding;
+	frame.flipped = false;
+	// Sized exactly, so that reading past the end shows up under a
+	// memory checker
+	frame.data.resize(frame.pitch * height);
+	for (size_t y = 0; y < height; ++y) {
+		for (size_t x = 0; x < width; ++x) {
+			auto px = &frame.data[y * frame.pitch + x * 4];
+			px[0] = px[1] = px[2] = static_cast<unsigned char>(luma(x, y));
+			px[3] = 255;
+		}
+	}
+	return frame;
+}
+
+/// A dark scene: a horizontal gradient over the darker half of the range
+VideoFrame dark(size_t width = 320, size_t height = 180) {
+	return make_frame(width, height, [=](size_t x, size_t) { return int(x * 128 / width); });
+}
+
+/// A bright scene: a vertical gradient over the brighter half of the range
+VideoFrame bright(size_t width = 320, size_t height = 180) {
+	return make_frame(width, height, [=](size_t, size_t y) { return int(128 + y * 127 / height); });
+}
+
+/// Feed the frames to a detector
+/// @return Indices of the frames which started a new scene
+std::vector<int> detect(std::vector<VideoFrame> const& frames) {
+	SceneChangeDetector detector;
+	std::vector<int> cuts;
+	for (size_t i = 0; i < frames.size(); ++i) {
+		if (detector.AddFrame(frames[i]))
+			cuts.push_back(int(i));
+	}
+	return cuts;
+}
+}
+
+TEST(keyframe_detector, first_frame_starts_a_scene) {
+	EXPECT_EQ(std::vector<int>{0}, detect({dark()}));
+}
+
+TEST(keyframe_detector, static_video) {
+	EXPECT_EQ(std::vector<int>{0}, detect(std::vector<VideoFrame>(20, dark())));
+}
+
+TEST(keyframe_detector, hard_cut) {
+	std::vector<VideoFrame> frames(10, dark());
+	frames.resize(20, bright());
+	EXPECT_EQ((std::vector<int>{0, 10}), detect(frames));
+}
+
+TEST(keyframe_detector, fade) {
+	// A fade to white over two seconds changes every frame by far less than
+	// a cut, even though the histogram moves completely over its course
+	std::vector<VideoFrame> frames;
+	for (int i = 0; i < 48; ++i)
+		frames.push_back(make_frame(320, 180, [=](size_t x, size_t) { return std::min(255, int(x * 128 / 320) + i * 3); }));
+	EXPECT_EQ(std::vector<int>{0}, detect(frames));
+}
+
+TEST(keyframe_detector, slow_pan) {
+	// Vertical stripes moving a few pixels a frame
+	std::vector<VideoFrame> frames;
+	for (int i = 0; i < 48; ++i)
+		frames.push_back(make_frame(320, 180, [=](size_t x, size_t) { return (x + i * 3) % 64 < 32 ? 40 : 200; }));
+	EXPECT_EQ(std::vector<int>{0}, detect(frames));
+}
+
+TEST(keyframe_detector, fast_pan) {
+	// Wide stripes moving far enough each frame that the grid changes a lot,
+	// but the histogram stays the same
+	std::vector<VideoFrame> frames;
+	for (int i = 0; i < 48; ++i)
+		frames.push_back(make_frame(320, 180, [=](size_t x, size_t) { return (x + i * 37) % 80 < 40 ? 40 : 200; }));
+	EXPECT_EQ(std::vector<int>{0}, detect(frames));
+}
+
+TEST(keyframe_detector, small_brightness_step) {
+	// Every cell and the whole histogram change, but only slightly
+	std::vector<VideoFrame> frames(10, make_frame(320, 180, [](size_t, size_t) { return 100; }));
+	frames.resize(20, make_frame(320, 180, [](size_t, size_t) { return 108; }));
+	EXPECT_EQ(std::vector<int>{0}, detect(frames));
+
+	frames.resize(10);
+	frames.resize(20, make_frame(320, 180, [](size_t, size_t) { return 120; }));
+	EXPECT_EQ((std::vector<int>{0, 10}), detect(frames));
+}
+
+TEST(keyframe_detector, pattern_shift) {
+	// Still stripes which suddenly move by half a period: each cell changes
+	// a lot, but the histogram stays the same
+	std::vector<VideoFrame> frames(10, make_frame(320, 180, [](size_t x, size_t) { return x % 80 < 40 ? 40 : 200; }));
+	frames.resize(20, make_frame(320, 180, [](size_t x, size_t) { return (x + 40) % 80 < 40 ? 40 : 200; }));
+	EXPECT_EQ(std::vector<int>{0}, detect(frames));
+}
+
+TEST(keyframe_detector, flashing) {
+	// Alternating between two very different frames is a single scene, as
+	// each change is no larger than the ones before it
+	std::vector<VideoFrame> frames;
+	for (int i = 0; i < 40; ++i)
+		frames.push_back(i % 2 ? bright() : dark());
+	EXPECT_EQ(std::vector<int>{0}, detect(frames));
+}
+
+TEST(keyframe_detector, cut_after_motion) {
+	// A cut still stands out after a stretch of motion which has raised the
+	// average difference
+	std::vector<VideoFrame> frames;
+	for (int i = 0; i < 24; ++i)
+		frames.push_back(make_frame(320, 180, [=](size_t x, size_t) { return int(((x + i * 3) % 64) * 2); }));
+	frames.resize(34, bright());
+	EXPECT_EQ((std::vector<int>{0, 24}), detect(frames));
+}
+
+TEST(keyframe_detector, cuts_closer_than_min_scene_length) {
+	// Cuts at 10 and 12: the second is within five frames of the first so
+	// it's dropped, while the one at 20 is far enough from both
+	std::vector<VideoFrame> frames(10, dark());
+	frames.resize(12, bright());
+	frames.resize(20, dark());
+	frames.resize(30, bright());
+	EXPECT_EQ((std::vector<int>{0, 10, 20}), detect(frames));
+}
+
+TEST(keyframe_detector, cut_at_min_scene_length) {
+	std::vector<VideoFrame> frames(10, dark());
+	frames.resize(15, bright());
+	frames.resize(25, dark());
+	EXPECT_EQ((std::vector<int>{0, 10, 15}), detect(frames));
+}
+
+TEST(keyframe_detector, frames_smaller_than_grid) {
+	// Fewer pixels than grid cells in one or both directions, with and
+	// without padding at the end of each row
+	for (auto size : {std::make_pair(1, 1), std::make_pair(7, 3), std::make_pair(63, 35), std::make_pair(200, 2), std::make_pair(2, 200)}) {
+		for (size_t padding : {0, 12}) {
+			SCOPED_TRACE(testing::Message() << size.first << "x" << size.second << " padding " << padding);
+			auto w = size.first, h = size.second;
+			std::vector<VideoFrame> frames(6, make_frame(w, h, [=](size_t, size_t) { return 20; }, padding));
+			frames.resize(12, make_frame(w, h, [=](size_t, size_t) { return 230; }, padding));
+			EXPECT_EQ((std::vector<int>{0, 6}), detect(frames));
+		}
+	}
+}
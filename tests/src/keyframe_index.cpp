@@ -0,0 +1,103 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file keyframe_index.cpp
+/// @brief KeyframeIndex tests
+/// @ingroup video_input
+
+#include <keyframe_index.h>
+
+#include <libaegisub/vfr.h>
+
+#include <main.h>
+
+TEST(keyframe_index, empty) {
+	KeyframeIndex kf;
+	EXPECT_TRUE(kf.empty());
+	EXPECT_FALSE(kf.HasTimes());
+	EXPECT_EQ(kf.size(), kf.FirstAtOrAfter(10));
+	EXPECT_EQ(kf.size(), kf.LastAtOrBefore(10));
+	EXPECT_EQ(kf.size(), kf.Closest(10));
+}
+
+TEST(keyframe_index, sorts_and_removes_duplicates) {
+	KeyframeIndex kf({30, 10, 20, 10}, agi::vfr::Framerate());
+	ASSERT_EQ(3u, kf.size());
+	EXPECT_EQ(10, kf.Frame(0));
+	EXPECT_EQ(20, kf.Frame(1));
+	EXPECT_EQ(30, kf.Frame(2));
+}
+
+TEST(keyframe_index, first_at_or_after) {
+	KeyframeIndex kf({10, 20, 30}, agi::vfr::Framerate());
+	EXPECT_EQ(0u, kf.FirstAtOrAfter(0));
+	EXPECT_EQ(0u, kf.FirstAtOrAfter(9));
+	EXPECT_EQ(0u, kf.FirstAtOrAfter(10));
+	EXPECT_EQ(1u, kf.FirstAtOrAfter(11));
+	EXPECT_EQ(1u, kf.FirstAtOrAfter(20));
+	EXPECT_EQ(2u, kf.FirstAtOrAfter(30));
+	EXPECT_EQ(3u, kf.FirstAtOrAfter(31));
+}
+
+TEST(keyframe_index, last_at_or_before) {
+	KeyframeIndex kf({10, 20, 30}, agi::vfr::Framerate());
+	EXPECT_EQ(3u, kf.LastAtOrBefore(0));
+	EXPECT_EQ(3u, kf.LastAtOrBefore(9));
+	EXPECT_EQ(0u, kf.LastAtOrBefore(10));
+	EXPECT_EQ(0u, kf.LastAtOrBefore(19));
+	EXPECT_EQ(1u, kf.LastAtOrBefore(20));
+	EXPECT_EQ(2u, kf.LastAtOrBefore(30));
+	EXPECT_EQ(2u, kf.LastAtOrBefore(1000));
+}
+
+TEST(keyframe_index, closest) {
+	KeyframeIndex kf({10, 20, 30}, agi::vfr::Framerate());
+	EXPECT_EQ(0u, kf.Closest(0));
+	EXPECT_EQ(0u, kf.Closest(10));
+	EXPECT_EQ(0u, kf.Closest(14));
+	// Ties go to the earlier keyframe
+	EXPECT_EQ(0u, kf.Closest(15));
+	EXPECT_EQ(1u, kf.Closest(16));
+	EXPECT_EQ(1u, kf.Closest(20));
+	EXPECT_EQ(2u, kf.Closest(30));
+	EXPECT_EQ(2u, kf.Closest(1000));
+}
+
+TEST(keyframe_index, single_keyframe) {
+	KeyframeIndex kf({10}, agi::vfr::Framerate());
+	EXPECT_EQ(0u, kf.FirstAtOrAfter(5));
+	EXPECT_EQ(1u, kf.FirstAtOrAfter(11));
+	EXPECT_EQ(1u, kf.LastAtOrBefore(5));
+	EXPECT_EQ(0u, kf.LastAtOrBefore(11));
+	EXPECT_EQ(0u, kf.Closest(0));
+	EXPECT_EQ(0u, kf.Closest(100));
+}
+
+TEST(keyframe_index, times) {
+	agi::vfr::Framerate fps(24000, 1001);
+	KeyframeIndex kf({0, 10, 20}, fps);
+	ASSERT_TRUE(kf.HasTimes());
+	for (size_t i = 0; i < kf.size(); ++i) {
+		EXPECT_EQ(fps.TimeAtFrame(kf.Frame(i), agi::vfr::START), kf.StartTime(i));
+		EXPECT_EQ(fps.TimeAtFrame(kf.Frame(i) - 1, agi::vfr::END), kf.EndTime(i));
+	}
+	EXPECT_EQ(kf.size(), kf.StartTimes().size());
+}
+
+TEST(keyframe_index, no_times_without_timecodes) {
+	KeyframeIndex kf({0, 10, 20}, agi::vfr::Framerate());
+	EXPECT_FALSE(kf.empty());
+	EXPECT_FALSE(kf.HasTimes());
+	EXPECT_TRUE(kf.StartTimes().empty());
+}
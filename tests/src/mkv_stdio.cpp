@@ -0,0 +1,133 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file mkv_stdio.cpp
+/// @brief MkvStdIO and Matroska subtitle block tests
+/// @ingroup video_input
+
+#include <mkv_stdio.h>
+
+#include <libaegisub/fs.h>
+
+#include <fstream>
+#include <string>
+
+#include <main.h>
+
+namespace {
+/// Cluster element ID, which is what the parser scans for
+const unsigned cluster_id = 0x1F43B675;
+const char cluster_sig[] = "\x1F\x43\xB6\x75";
+
+/// Write a file of filler bytes with the cluster ID at each of the offsets
+void write_file(const char *path, size_t size, std::initializer_list<size_t> offsets) {
+	std::string data(size, '\x01');
+	for (auto offset : offsets)
+		data.replace(offset, 4, cluster_sig, 4);
+	std::ofstream of(path, std::ios::binary);
+	of.write(data.data(), data.size());
+}
+
+int64_t scan(const char *path, uint64_t start) {
+	MkvStdIO io(path);
+	return io.scan(&io, start, cluster_id);
+}
+}
+
+TEST(mkv_stdio, scan_returns_start_of_signature) {
+	write_file("data/mkv_scan.bin", 1000, {100});
+	EXPECT_EQ(100, scan("data/mkv_scan.bin", 0));
+	EXPECT_EQ(100, scan("data/mkv_scan.bin", 100));
+	EXPECT_EQ(-1, scan("data/mkv_scan.bin", 101));
+}
+
+TEST(mkv_stdio, scan_at_start_of_file) {
+	// The old scanner returned one byte before the signature, which here
+	// would have been -1
+	write_file("data/mkv_scan.bin", 1000, {0});
+	EXPECT_EQ(0, scan("data/mkv_scan.bin", 0));
+}
+
+TEST(mkv_stdio, scan_at_end_of_file) {
+	write_file("data/mkv_scan.bin", 1000, {996});
+	EXPECT_EQ(996, scan("data/mkv_scan.bin", 0));
+	EXPECT_EQ(996, scan("data/mkv_scan.bin", 996));
+	EXPECT_EQ(-1, scan("data/mkv_scan.bin", 997));
+}
+
+TEST(mkv_stdio, scan_finds_next_after_start) {
+	write_file("data/mkv_scan.bin", 1000, {10, 500});
+	EXPECT_EQ(10, scan("data/mkv_scan.bin", 0));
+	EXPECT_EQ(500, scan("data/mkv_scan.bin", 11));
+}
+
+TEST(mkv_stdio, scan_skips_partial_matches) {
+	write_file("data/mkv_scan.bin", 1000, {});
+	{
+		std::fstream f("data/mkv_scan.bin", std::ios::binary | std::ios::in | std::ios::out);
+		f.seekp(200);
+		// Starts of the ID which aren't followed by the rest of it, then the
+		// ID itself right after a repeat of its first byte
+		f.write("\x1F\x43\xB6\x00\x1F\x43\x00\x1F\x1F\x43\xB6\x75", 12);
+	}
+	EXPECT_EQ(208, scan("data/mkv_scan.bin", 0));
+}
+
+TEST(mkv_stdio, scan_across_windows) {
+	// The file is searched 1 MB at a time, so put signatures straddling
+	// the boundaries between windows
+	const size_t mb = 1 << 20;
+	write_file("data/mkv_scan.bin", 3 * mb, {mb - 2, 2 * mb - 2});
+	EXPECT_EQ(int64_t(mb - 2), scan("data/mkv_scan.bin", 0));
+	EXPECT_EQ(int64_t(2 * mb - 2), scan("data/mkv_scan.bin", mb - 1));
+	EXPECT_EQ(int64_t(2 * mb - 2), scan("data/mkv_scan.bin", mb));
+	EXPECT_EQ(-1, scan("data/mkv_scan.bin", 2 * mb));
+}
+
+TEST(mkv_stdio, scan_small_files) {
+	write_file("data/mkv_scan.bin", 3, {});
+	EXPECT_EQ(-1, scan("data/mkv_scan.bin", 0));
+	write_file("data/mkv_scan.bin", 4, {0});
+	EXPECT_EQ(0, scan("data/mkv_scan.bin", 0));
+	EXPECT_EQ(-1, scan("data/mkv_scan.bin", 10));
+}
+
+TEST(mkv_stdio, ssa_block) {
+	std::string block = "12,3,Default,Actor,0,0,0,,Some text";
+	std::string line = "left over from the last block";
+	int order = -1;
+	ASSERT_TRUE(MkvSsaBlockToLine(&block[0], &block[0] + block.size(), 1500, 63000, line, order));
+	EXPECT_EQ(12, order);
+	EXPECT_EQ("Dialogue: 3,0:00:01.50,0:01:03.00,Default,Actor,0,0,0,,Some text", line);
+}
+
+TEST(mkv_stdio, ssa_block_malformed) {
+	std::string block = "12";
+	std::string line;
+	int order;
+	EXPECT_FALSE(MkvSsaBlockToLine(&block[0], &block[0] + block.size(), 0, 0, line, order));
+	block = "12,3";
+	EXPECT_FALSE(MkvSsaBlockToLine(&block[0], &block[0] + block.size(), 0, 0, line, order));
+}
+
+TEST(mkv_stdio, srt_block) {
+	std::string block = "one\r\ntwo\rthree\nfour";
+	std::string line;
+	MkvSrtBlockToLine(&block[0], &block[0] + block.size(), 0, 2000, line);
+	EXPECT_EQ("Dialogue: 0,0:00:00.00,0:00:02.00,Default,,0,0,0,,one\\Ntwo\\Nthree\\Nfour", line);
+
+	block = "trailing\r";
+	MkvSrtBlockToLine(&block[0], &block[0] + block.size(), 0, 2000, line);
+	EXPECT_EQ("Dialogue: 0,0:00:00.00,0:00:02.00,Default,,0,0,0,,trailing\\N", line);
+}
@@ -0,0 +1,267 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file shift_history.cpp
+/// @brief ShiftHistory tests
+/// @ingroup secondary_ui
+
+#include <shift_history.h>
+
+#include <libaegisub/exception.h>
+#include <libaegisub/fs.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <main.h>
+
+namespace {
+const char *history_file = "data/shift_history.dat";
+const char *legacy_file = "data/shift_history.json";
+
+class shift_history : public ::testing::Test {
+protected:
+	void SetUp() override {
+		std::remove(history_file);
+		std::remove(legacy_file);
+	}
+};
+
+void write_file(const char *path, std::string const& data) {
+	std::ofstream of(path, std::ios::binary);
+	of.write(data.data(), data.size());
+}
+
+void put_u32(std::string &out, uint32_t value) {
+	for (int i = 0; i < 4; ++i)
+		out += static_cast<char>((value >> (i * 8)) & 0xFF);
+}
+
+/// A version 1 file header with a table for a single entry
+std::string header(uint32_t offset, uint32_t size) {
+	std::string out = "AGSH";
+	put_u32(out, 1);
+	put_u32(out, 1);
+	put_u32(out, offset);
+	put_u32(out, size);
+	return out;
+}
+
+void expect_entry_eq(ShiftHistoryEntry const& expected, ShiftHistoryEntry const& actual) {
+	EXPECT_EQ(expected.filename, actual.filename);
+	EXPECT_EQ(expected.by_time, actual.by_time);
+	EXPECT_EQ(expected.backward, actual.backward);
+	EXPECT_EQ(expected.amount, actual.amount);
+	EXPECT_EQ(expected.fields, actual.fields);
+	EXPECT_EQ(expected.mode, actual.mode);
+	EXPECT_EQ(expected.blocks, actual.blocks);
+}
+}
+
+TEST_F(shift_history, empty) {
+	ShiftHistory history(history_file, legacy_file);
+	EXPECT_EQ(0u, history.size());
+	EXPECT_FALSE(agi::fs::FileExists(history_file));
+}
+
+TEST_F(shift_history, round_trip) {
+	std::vector<ShiftHistoryEntry> added;
+	{
+		ShiftHistory history(history_file, legacy_file);
+		for (int by_time = 0; by_time < 2; ++by_time) {
+			for (int backward = 0; backward < 2; ++backward) {
+				for (int fields = 0; fields < 3; ++fields) {
+					for (int mode = 0; mode < 3; ++mode) {
+						ShiftHistoryEntry entry;
+						entry.filename = added.size() % 2 ? "" : "script \xE3\x81\x82 " + std::to_string(added.size()) + ".ass";
+						entry.by_time = !!by_time;
+						entry.backward = !!backward;
+						entry.amount = by_time ? 1500 + int(added.size()) : 24;
+						entry.fields = fields;
+						entry.mode = mode;
+						if (mode == 1)
+							entry.blocks = {{1, 3}, {7, 7}, {10, 200000}};
+						else if (mode == 2)
+							entry.blocks = {{5, 5}};
+						history.Add(entry);
+						added.push_back(entry);
+					}
+				}
+			}
+		}
+		ASSERT_EQ(added.size(), history.size());
+		for (size_t i = 0; i < added.size(); ++i)
+			expect_entry_eq(added[added.size() - 1 - i], history.Get(i));
+	}
+
+	ShiftHistory history(history_file, legacy_file);
+	ASSERT_EQ(added.size(), history.size());
+	for (size_t i = 0; i < added.size(); ++i)
+		expect_entry_eq(added[added.size() - 1 - i], history.Get(i));
+}
+
+TEST_F(shift_history, shift) {
+	ShiftHistoryEntry entry;
+	entry.amount = 100;
+	EXPECT_EQ(100, entry.Shift());
+	entry.backward = true;
+	EXPECT_EQ(-100, entry.Shift());
+}
+
+TEST_F(shift_history, max_entries) {
+	{
+		ShiftHistory history(history_file, legacy_file);
+		for (int i = 0; i < 60; ++i) {
+			ShiftHistoryEntry entry;
+			entry.amount = i;
+			history.Add(entry);
+			EXPECT_EQ(std::min<size_t>(i + 1, ShiftHistory::max_entries), history.size());
+		}
+		EXPECT_EQ(59, history.Get(0).amount);
+		EXPECT_EQ(10, history.Get(ShiftHistory::max_entries - 1).amount);
+		EXPECT_THROW(history.Get(ShiftHistory::max_entries), std::out_of_range);
+	}
+
+	ShiftHistory history(history_file, legacy_file);
+	ASSERT_EQ(ShiftHistory::max_entries, history.size());
+	EXPECT_EQ(59, history.Get(0).amount);
+	EXPECT_EQ(10, history.Get(ShiftHistory::max_entries - 1).amount);
+}
+
+TEST_F(shift_history, clear) {
+	ShiftHistory history(history_file, legacy_file);
+	history.Add(ShiftHistoryEntry());
+	EXPECT_TRUE(agi::fs::FileExists(history_file));
+	history.Clear();
+	EXPECT_EQ(0u, history.size());
+	EXPECT_FALSE(agi::fs::FileExists(history_file));
+}
+
+TEST_F(shift_history, bad_header) {
+	std::string bad_version = "AGSH";
+	put_u32(bad_version, 2);
+	put_u32(bad_version, 0);
+
+	std::string too_many_entries = "AGSH";
+	put_u32(too_many_entries, 1);
+	put_u32(too_many_entries, 0xFFFFFFFF);
+
+	for (std::string data : {std::string(), std::string("AGS"), std::string("XGSH\1\0\0\0\0\0\0\0", 12),
+		std::string("AGSH\1\0\0", 7), bad_version, too_many_entries})
+	{
+		SCOPED_TRACE(testing::PrintToString(data));
+		write_file(history_file, data);
+		ShiftHistory history(history_file, legacy_file);
+		EXPECT_EQ(0u, history.size());
+	}
+}
+
+TEST_F(shift_history, entry_out_of_range) {
+	write_file(history_file, header(20, 100) + std::string(10, '\0'));
+	ShiftHistory history(history_file, legacy_file);
+	EXPECT_EQ(0u, history.size());
+
+	write_file(history_file, header(0xFFFFFFF0, 0x20));
+	ShiftHistory history2(history_file, legacy_file);
+	EXPECT_EQ(0u, history2.size());
+}
+
+TEST_F(shift_history, truncated_entry) {
+	// Stops partway through the amount
+	write_file(history_file, header(20, 5) + std::string("\1\0\0\xE8\3", 5));
+	ShiftHistory history(history_file, legacy_file);
+	ASSERT_EQ(1u, history.size());
+	EXPECT_THROW(history.Get(0), agi::InvalidInputException);
+}
+
+TEST_F(shift_history, corrupt_lengths) {
+	std::string entry("\1\0\0", 3);
+	put_u32(entry, 1000);
+	std::string bad_filename = entry;
+	put_u32(bad_filename, 0xFFFFFFFF);
+
+	std::string bad_blocks = entry;
+	put_u32(bad_blocks, 0);
+	put_u32(bad_blocks, 0xFFFFFFFF);
+
+	std::string short_blocks = entry;
+	put_u32(short_blocks, 0);
+	put_u32(short_blocks, 2);
+	put_u32(short_blocks, 1);
+	put_u32(short_blocks, 2);
+	put_u32(short_blocks, 3);
+
+	for (auto const& data : {bad_filename, bad_blocks, short_blocks}) {
+		write_file(history_file, header(20, data.size()) + data);
+		ShiftHistory history(history_file, legacy_file);
+		ASSERT_EQ(1u, history.size());
+		EXPECT_THROW(history.Get(0), agi::InvalidInputException);
+	}
+}
+
+TEST_F(shift_history, add_after_corrupt_file) {
+	write_file(history_file, "not a history file");
+	ShiftHistory history(history_file, legacy_file);
+	ShiftHistoryEntry entry;
+	entry.amount = 42;
+	history.Add(entry);
+
+	ShiftHistory reloaded(history_file, legacy_file);
+	ASSERT_EQ(1u, reloaded.size());
+	EXPECT_EQ(42, reloaded.Get(0).amount);
+}
+
+TEST_F(shift_history, import_json) {
+	write_file(legacy_file, R"([
+		{"filename": "first.ass", "is by time": true, "is backward": false, "amount": "0:00:01.50",
+		 "fields": 1, "mode": 1, "selection": [{"start": 1, "end": 3}, {"start": 7, "end": 7}]},
+		{"filename": "bad amount.ass", "is by time": false, "is backward": false, "amount": "abc",
+		 "fields": 0, "mode": 0, "selection": []},
+		{"filename": "", "is by time": false, "is backward": true, "amount": "24",
+		 "fields": 2, "mode": 2, "selection": [{"start": 5, "end": 5}]}
+	])");
+
+	ShiftHistory history(history_file, legacy_file);
+	ASSERT_EQ(2u, history.size());
+	EXPECT_TRUE(agi::fs::FileExists(history_file));
+
+	ShiftHistoryEntry first;
+	first.filename = "first.ass";
+	first.amount = 1500;
+	first.fields = 1;
+	first.mode = 1;
+	first.blocks = {{1, 3}, {7, 7}};
+	expect_entry_eq(first, history.Get(0));
+
+	ShiftHistoryEntry second;
+	second.by_time = false;
+	second.backward = true;
+	second.amount = 24;
+	second.fields = 2;
+	second.mode = 2;
+	second.blocks = {{5, 5}};
+	expect_entry_eq(second, history.Get(1));
+
+	// Once the binary file exists the JSON file is ignored
+	write_file(legacy_file, "[]");
+	ShiftHistory reloaded(history_file, legacy_file);
+	EXPECT_EQ(2u, reloaded.size());
+}
+
+TEST_F(shift_history, import_bad_json) {
+	write_file(legacy_file, "{not json");
+	ShiftHistory history(history_file, legacy_file);
+	EXPECT_EQ(0u, history.size());
+}
@@ -0,0 +1,290 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+/// @file timing_processor.cpp
+/// @brief TimingProcessor tests
+/// @ingroup tools_ui
+
+#include <ass_dialogue.h>
+#include <keyframe_index.h>
+#include <timing_processor.h>
+
+#include <libaegisub/vfr.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <main.h>
+
+namespace {
+struct SnapPoint {
+	int frame;
+	int start_time;
+	int end_time;
+};
+
+SnapPoint get_closest_kf(KeyframeIndex const& kf, SnapPoint const& video_end, int frame) {
+	size_t i = kf.Closest(frame);
+	SnapPoint closest{kf.Frame(i), kf.StartTime(i), kf.EndTime(i)};
+	if (video_end.frame >= 0 && std::abs(video_end.frame - frame) < std::abs(closest.frame - frame))
+		return video_end;
+	return closest;
+}
+
+/// The passes as the dialog ran them before they were split out, modifying
+/// each line in turn
+///
+/// The lines were sorted with an unstable sort then, so the order of lines
+/// with the same start time was unspecified; this uses a stable sort to make
+/// it match what TimingProcessor now does.
+void process_reference(std::vector<AssDialogue *> sorted, TimingProcessor::Settings const& s,
+	KeyframeIndex const& kf, agi::vfr::Framerate const& fps, int video_end_frame)
+{
+	std::stable_sort(begin(sorted), end(sorted), [](const AssDialogue *a, const AssDialogue *b) {
+		return a->Start < b->Start;
+	});
+
+	if (s.lead_in) {
+		std::multiset<int> ends;
+		for (auto line : sorted) {
+			int start = line->Start - s.lead_in;
+			auto it = ends.upper_bound(line->Start);
+			if (it != ends.begin())
+				start = std::max(start, *std::prev(it));
+			ends.insert(line->End);
+			line->Start = start;
+		}
+	}
+
+	if (s.lead_out) {
+		std::multiset<int> starts;
+		std::map<int, int> min_start_by_end;
+		for (size_t i = sorted.size(); i > 0; --i) {
+			AssDialogue *line = sorted[i - 1];
+			int end = line->End + s.lead_out;
+			auto it = starts.lower_bound(std::max<int>(line->End, line->Start + 1));
+			if (it != starts.end())
+				end = std::min(end, *it);
+			auto zero_length = min_start_by_end.find(line->Start);
+			if (zero_length != min_start_by_end.end())
+				end = std::min(end, zero_length->second);
+
+			starts.insert(line->Start);
+			auto inserted = min_start_by_end.emplace(line->End, line->Start);
+			if (!inserted.second)
+				inserted.first->second = std::min<int>(inserted.first->second, line->Start);
+			line->End = end;
+		}
+	}
+
+	if (s.adjacent) {
+		for (size_t i = 1; i < sorted.size(); ++i) {
+			AssDialogue *prev = sorted[i - 1];
+			AssDialogue *cur = sorted[i];
+
+			int dist = cur->Start - prev->End;
+			if ((dist < 0 && -dist <= s.adjacent_overlap) || (dist > 0 && dist <= s.adjacent_gap)) {
+				int setPos = prev->End + int(dist * s.adjacent_bias);
+				cur->Start = setPos;
+				prev->End = setPos;
+			}
+		}
+	}
+
+	if (s.keyframes && kf.HasTimes()) {
+		SnapPoint video_end{-1, 0, 0};
+		if (video_end_frame >= 0)
+			video_end = {video_end_frame, fps.TimeAtFrame(video_end_frame, agi::vfr::START), fps.TimeAtFrame(video_end_frame - 1, agi::vfr::END)};
+
+		for (auto cur : sorted) {
+			int startF = fps.FrameAtTime(cur->Start, agi::vfr::START);
+			int endF = fps.FrameAtTime(cur->End, agi::vfr::END);
+
+			auto snap = get_closest_kf(kf, video_end, startF);
+			int closest = snap.frame;
+			int time = snap.start_time;
+			if ((closest > startF && time - cur->Start <= s.before_start) || (closest < startF && cur->Start - time <= s.after_start))
+				cur->Start = time;
+
+			snap = get_closest_kf(kf, video_end, endF);
+			closest = snap.frame - 1;
+			time = snap.end_time;
+			if ((closest > endF && time - cur->End <= s.before_end) || (closest < endF && cur->End - time <= s.after_end))
+				cur->End = time;
+		}
+	}
+}
+
+std::vector<AssDialogue *> pointers(std::list<AssDialogue> &lines) {
+	std::vector<AssDialogue *> ret;
+	for (auto& line : lines)
+		ret.push_back(&line);
+	return ret;
+}
+}
+
+TEST(timing_processor, no_changes_without_settings) {
+	std::list<AssDialogue> lines(3);
+	int start = 0;
+	for (auto& line : lines) {
+		line.Style = "Default";
+		line.Start = start;
+		line.End = start += 1000;
+	}
+
+	TimingProcessor tp(pointers(lines), {"Default"});
+	EXPECT_TRUE(tp.Run(TimingProcessor::Settings(), {true}, KeyframeIndex(), agi::vfr::Framerate(), -1).empty());
+}
+
+TEST(timing_processor, only_enabled_styles) {
+	std::list<AssDialogue> lines(2);
+	lines.front().Style = "A";
+	lines.back().Style = "B";
+	for (auto& line : lines) {
+		line.Start = 1000;
+		line.End = 2000;
+	}
+
+	TimingProcessor tp(pointers(lines), {"A", "B"});
+	TimingProcessor::Settings settings;
+	settings.lead_in = 200;
+	auto changes = tp.Run(settings, {false, true}, KeyframeIndex(), agi::vfr::Framerate(), -1);
+	ASSERT_EQ(1u, changes.size());
+	EXPECT_EQ(&lines.back(), changes[0].line);
+	EXPECT_EQ(800, changes[0].start);
+	EXPECT_EQ(2000, changes[0].end);
+	// Nothing was written to the line
+	EXPECT_EQ(1000, (int)lines.back().Start);
+}
+
+TEST(timing_processor, find_invalid_line) {
+	std::list<AssDialogue> lines(2);
+	lines.front().Style = "A";
+	lines.back().Style = "B";
+	for (auto& line : lines) {
+		line.Start = 1000;
+		line.End = 500;
+	}
+
+	TimingProcessor tp(pointers(lines), {"A", "B"});
+	EXPECT_EQ(&lines.front(), tp.FindInvalidLine({true, false}));
+	EXPECT_EQ(nullptr, tp.FindInvalidLine({false, false}));
+}
+
+TEST(timing_processor, snaps_to_video_end_without_keyframes) {
+	std::list<AssDialogue> lines(2);
+	for (auto& line : lines)
+		line.Style = "Default";
+	lines.front().Start = 1000;
+	lines.front().End = 9900;
+	lines.back().Start = 1000;
+	lines.back().End = 5000;
+
+	TimingProcessor tp(pointers(lines), {"Default"});
+	TimingProcessor::Settings settings;
+	settings.keyframes = true;
+	settings.before_end = 500;
+	agi::vfr::Framerate fps(24000, 1001);
+
+	for (auto const& kf : {KeyframeIndex(), KeyframeIndex({0}, agi::vfr::Framerate())}) {
+		ASSERT_FALSE(kf.HasTimes());
+		auto changes = tp.Run(settings, {true}, kf, fps, 240);
+		ASSERT_EQ(1u, changes.size());
+		EXPECT_EQ(&lines.front(), changes[0].line);
+		EXPECT_EQ(1000, changes[0].start);
+		// The end of frame 239, rounded to centiseconds
+		EXPECT_EQ(9990, changes[0].end);
+
+		EXPECT_TRUE(tp.Run(settings, {true}, kf, fps, -1).empty());
+	}
+}
+
+TEST(timing_processor, matches_reference_on_random_scripts) {
+	std::mt19937 rng(39);
+	auto random = [&](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng); };
+	const std::vector<std::string> style_names{"A", "B", "C"};
+	size_t changed = 0;
+
+	for (int script = 0; script < 3000; ++script) {
+		std::list<AssDialogue> lines(random(0, 40));
+		for (auto& line : lines) {
+			line.Style = style_names[random(0, 2)];
+			// Small steps so that plenty of lines touch, overlap or share
+			// start times, with some zero-length lines
+			line.Start = random(0, 200) * 100;
+			line.End = line.Start + random(0, 30) * 100 * random(0, 1);
+		}
+
+		std::vector<bool> enabled{random(0, 3) > 0, random(0, 3) > 0, true};
+
+		TimingProcessor::Settings s;
+		s.lead_in = random(0, 1) * random(1, 1000);
+		s.lead_out = random(0, 1) * random(1, 1000);
+		s.adjacent = random(0, 1);
+		s.adjacent_gap = random(0, 1000);
+		s.adjacent_overlap = random(0, 1000);
+		s.adjacent_bias = random(0, 100) / 100.0;
+		s.keyframes = random(0, 1);
+		s.before_start = random(0, 500);
+		s.after_start = random(0, 500);
+		s.before_end = random(0, 500);
+		s.after_end = random(0, 500);
+
+		agi::vfr::Framerate fps(24000, 1001);
+		if (random(0, 3) == 0) {
+			// Variable frame rate
+			std::vector<int> timecodes{0};
+			for (int i = 0; i < 700; ++i)
+				timecodes.push_back(timecodes.back() + random(20, 60));
+			fps = agi::vfr::Framerate(timecodes);
+		}
+
+		std::vector<int> keyframes{0};
+		for (int frame = random(1, 50); frame < 650; frame += random(1, 50))
+			keyframes.push_back(frame);
+		KeyframeIndex kf(keyframes, fps);
+		int video_end_frame = random(0, 1) ? random(600, 650) : -1;
+
+		TimingProcessor tp(pointers(lines), style_names);
+		auto changes = tp.Run(s, enabled, kf, fps, video_end_frame);
+		changed += changes.size();
+
+		std::list<AssDialogue> expected(lines);
+		std::vector<AssDialogue *> to_process;
+		for (auto& line : expected) {
+			if (enabled[std::find(begin(style_names), end(style_names), line.Style.get()) - begin(style_names)])
+				to_process.push_back(&line);
+		}
+		process_reference(to_process, s, kf, fps, video_end_frame);
+
+		for (auto const& change : changes) {
+			change.line->Start = change.start;
+			change.line->End = change.end;
+		}
+
+		auto actual_it = begin(lines);
+		for (auto const& line : expected) {
+			ASSERT_EQ((int)line.Start, (int)actual_it->Start) << "script " << script;
+			ASSERT_EQ((int)line.End, (int)actual_it->End) << "script " << script;
+			++actual_it;
+		}
+	}
+	EXPECT_LT(10000u, changed);
+}
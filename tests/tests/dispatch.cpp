@@ -0,0 +1,106 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+
+#include <main.h>
+
+#include <libaegisub/dispatch.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+TEST(lagi_dispatch, parallel_for_covers_range_once) {
+	std::vector<int> seen(10000);
+	agi::dispatch::ParallelFor(seen.size(), 100, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			++seen[i];
+	});
+	for (int count : seen)
+		ASSERT_EQ(1, count);
+}
+
+TEST(lagi_dispatch, parallel_for_small_count_runs_inline) {
+	std::vector<std::pair<size_t, size_t>> calls;
+	agi::dispatch::ParallelFor(10, 100, [&](size_t begin, size_t end) {
+		calls.emplace_back(begin, end);
+	});
+	ASSERT_EQ(1u, calls.size());
+	EXPECT_EQ(0u, calls[0].first);
+	EXPECT_EQ(10u, calls[0].second);
+}
+
+TEST(lagi_dispatch, parallel_for_empty_range) {
+	bool called = false;
+	agi::dispatch::ParallelFor(0, 1, [&](size_t, size_t) { called = true; });
+	EXPECT_FALSE(called);
+}
+
+TEST(lagi_dispatch, parallel_for_rethrows) {
+	std::atomic<int> chunks(0);
+	EXPECT_THROW(agi::dispatch::ParallelFor(1000, 1, [&](size_t begin, size_t) {
+		++chunks;
+		if (begin == 0) throw std::runtime_error("failed");
+	}), std::runtime_error);
+	EXPECT_LT(0, chunks.load());
+}
+
+TEST(lagi_dispatch, parallel_for_runs_while_workers_are_busy) {
+	// Tie up every worker until the ParallelFor has finished, which it can
+	// only do if the calling thread processes all of the chunks itself
+	std::mutex m;
+	std::condition_variable cv;
+	bool release = false;
+	std::atomic<int> blocked(0);
+	const int blockers = 64;
+	for (int i = 0; i < blockers; ++i) {
+		agi::dispatch::Background().Async([&] {
+			std::unique_lock<std::mutex> l(m);
+			cv.wait(l, [&] { return release; });
+			++blocked;
+		});
+	}
+
+	std::vector<int> seen(10000);
+	agi::dispatch::ParallelFor(seen.size(), 100, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			++seen[i];
+	});
+	for (int count : seen)
+		ASSERT_EQ(1, count);
+
+	{
+		std::lock_guard<std::mutex> l(m);
+		release = true;
+	}
+	cv.notify_all();
+	while (blocked != blockers)
+		std::this_thread::yield();
+}
+
+TEST(lagi_dispatch, parallel_for_from_background_queue) {
+	std::vector<int> seen(10000);
+	agi::dispatch::Background().Sync([&] {
+		agi::dispatch::ParallelFor(seen.size(), 100, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				++seen[i];
+		});
+	});
+	for (int count : seen)
+		ASSERT_EQ(1, count);
+}
@@ -140,3 +140,70 @@ TEST(lagi_keyframe, aegi) {
 
 	EXPECT_TRUE(expected == res);
 }
+
+TEST(lagi_keyframe, crlf_and_no_trailing_newline) {
+	{
+		std::ofstream of("data/keyframe/crlf.log", std::ios::binary);
+		of << "#options: 720x480\r\n";
+		of << "in:0 out:0 type:I dur:0\r\n";
+		of << "in:1 out:1 type:P dur:0\r\n";
+		of << "\r\n";
+		of << "in:2 out:2 type:B dur:0\r\n";
+		of << "in:3 out:3 type:i";
+	}
+
+	std::vector<int> res;
+	ASSERT_NO_THROW(res = Load("data/keyframe/crlf.log"));
+	EXPECT_EQ((std::vector<int>{0, 3}), res);
+}
+
+TEST(lagi_keyframe, wwxd) {
+	{
+		std::ofstream of("data/keyframe/wwxd.txt");
+		of << "# WWXD log file, using qpfile format\n";
+		of << "# frame type\n";
+		of << "0 I -1\n";
+		of << "24 P\n";
+		of << "\n";
+		of << "  48 I\n";
+		of << "96\tI";
+	}
+
+	std::vector<int> res;
+	ASSERT_NO_THROW(res = Load("data/keyframe/wwxd.txt"));
+	EXPECT_EQ((std::vector<int>{0, 48, 96}), res);
+
+	{
+		std::ofstream of("data/keyframe/wwxd_bad.txt");
+		of << "# WWXD log file, using qpfile format\n";
+		of << "I 0\n";
+	}
+	EXPECT_THROW(Load("data/keyframe/wwxd_bad.txt"), KeyframeFormatParseError);
+}
+
+TEST(lagi_keyframe, x264_round_trip) {
+	// Full x264 stats lines, with the keyframes ending up in a file in the
+	// Aegisub format. tests/benchmarks/keyframe.cpp times the same thing on a
+	// file of a more realistic size.
+	const int frames = 2000;
+	std::vector<int> expected;
+	{
+		std::ofstream of("data/keyframe/x264_round_trip.log");
+		of << "#options: 1920x1080 fps=24000/1001 timebase=1/1000000000 cabac=1\n";
+		for (int i = 0; i < frames; ++i) {
+			char type = i % 250 == 0 ? 'I' : i % 3 ? 'P' : 'B';
+			if (type == 'I') expected.push_back(i);
+			of << "in:" << i << " out:" << i << " type:" << type
+			   << " dur:41708333 cpbdur:41708333 q:20.09 tex:3977 mv:5546"
+			   << " misc:4901 imb:1350 pmb:0 smb:0 d:- ref:0 ;\n";
+		}
+	}
+
+	std::vector<int> res;
+	ASSERT_NO_THROW(res = Load("data/keyframe/x264_round_trip.log"));
+	EXPECT_TRUE(expected == res);
+
+	ASSERT_NO_THROW(Save("data/keyframe/x264_round_trip_out.txt", res));
+	ASSERT_NO_THROW(res = Load("data/keyframe/x264_round_trip_out.txt"));
+	EXPECT_TRUE(expected == res);
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2026, Aegisub contributors
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include <main.h>
+
+#include <libaegisub/fs.h>
+#include <libaegisub/lua/script_cache.h>
+
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+
+using namespace agi::lua;
+
+namespace {
+const agi::fs::path cache_dir = "data/script_cache";
+
+agi::fs::path write_script(std::string const& name, std::string const& source) {
+	auto path = boost::filesystem::absolute("data/" + name);
+	std::ofstream(path.string(), std::ios::binary) << source;
+	return path;
+}
+
+std::string key_for(agi::fs::path const& script, std::string const& source) {
+	return CacheKey(script, source.data(), source.size());
+}
+
+void write_cache_file(agi::fs::path const& file, std::string const& key) {
+	agi::fs::CreateDirectory(file.parent_path());
+	std::ofstream(file.string(), std::ios::binary) << key << "0\n\n" << "bytecode";
+}
+}
+
+TEST(lagi_script_cache, path_is_per_script) {
+	EXPECT_EQ(CachePath(cache_dir, "/a/script.lua"), CachePath(cache_dir, "/a/script.lua"));
+	EXPECT_NE(CachePath(cache_dir, "/a/script.lua"), CachePath(cache_dir, "/b/script.lua"));
+	EXPECT_EQ(cache_dir, CachePath(cache_dir, "/a/script.lua").parent_path());
+}
+
+TEST(lagi_script_cache, key_is_stable) {
+	auto script = write_script("cache_stable.lua", "return 1");
+	EXPECT_EQ(key_for(script, "return 1"), key_for(script, "return 1"));
+}
+
+TEST(lagi_script_cache, key_changes_with_content) {
+	auto script = write_script("cache_content.lua", "return 1");
+	auto mod_time = boost::filesystem::last_write_time(script);
+	auto before = key_for(script, "return 1");
+
+	// Same size and modification time, so only the contents differ
+	write_script("cache_content.lua", "return 2");
+	boost::filesystem::last_write_time(script, mod_time);
+	EXPECT_NE(before, key_for(script, "return 2"));
+}
+
+TEST(lagi_script_cache, key_changes_with_size) {
+	auto script = write_script("cache_size.lua", "return 1");
+	auto mod_time = boost::filesystem::last_write_time(script);
+	auto before = key_for(script, "return 1");
+
+	write_script("cache_size.lua", "return 10");
+	boost::filesystem::last_write_time(script, mod_time);
+	EXPECT_NE(before, key_for(script, "return 10"));
+}
+
+TEST(lagi_script_cache, key_changes_with_modification_time) {
+	auto script = write_script("cache_time.lua", "return 1");
+	auto before = key_for(script, "return 1");
+
+	boost::filesystem::last_write_time(script, boost::filesystem::last_write_time(script) - 10);
+	EXPECT_NE(before, key_for(script, "return 1"));
+}
+
+TEST(lagi_script_cache, key_changes_with_path) {
+	auto a = write_script("cache_path_a.lua", "return 1");
+	auto b = write_script("cache_path_b.lua", "return 1");
+	boost::filesystem::last_write_time(b, boost::filesystem::last_write_time(a));
+	EXPECT_NE(key_for(a, "return 1"), key_for(b, "return 1"));
+}
+
+TEST(lagi_script_cache, prune) {
+	auto kept = write_script("cache_kept.lua", "return 1");
+	write_cache_file(CachePath(cache_dir, kept), key_for(kept, "return 1"));
+
+	auto deleted = write_script("cache_deleted.lua", "return 1");
+	write_cache_file(CachePath(cache_dir, deleted), key_for(deleted, "return 1"));
+	agi::fs::Remove(deleted);
+
+	// Written by some other version of LuaJIT
+	auto old_version = write_script("cache_old_version.lua", "return 1");
+	auto key = key_for(old_version, "return 1");
+	write_cache_file(CachePath(cache_dir, old_version), "LuaJIT 0.0" + key.substr(key.find('\n')));
+
+	// Not the cache file which would be used for the script it names
+	auto misnamed = cache_dir/"misnamed.luac";
+	write_cache_file(misnamed, key_for(kept, "return 1"));
+
+	auto unrelated = cache_dir/"unrelated.txt";
+	std::ofstream(unrelated.string()) << "not a cache file";
+
+	ASSERT_NO_THROW(PruneCache(cache_dir));
+	EXPECT_TRUE(agi::fs::FileExists(CachePath(cache_dir, kept)));
+	EXPECT_FALSE(agi::fs::FileExists(CachePath(cache_dir, deleted)));
+	EXPECT_FALSE(agi::fs::FileExists(CachePath(cache_dir, old_version)));
+	EXPECT_FALSE(agi::fs::FileExists(misnamed));
+	EXPECT_TRUE(agi::fs::FileExists(unrelated));
+}
+
+TEST(lagi_script_cache, prune_missing_directory) {
+	EXPECT_NO_THROW(PruneCache("data/nonexistent_cache"));
+}
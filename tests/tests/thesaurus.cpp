@@ -146,3 +146,46 @@ TEST_F(lagi_thes, unindexed_word) {
 	ASSERT_NO_THROW(entries = thes.Lookup("Unindexed Word"));
 	EXPECT_EQ(0, entries.size());
 }
+
+TEST_F(lagi_thes, cached_index) {
+	const char *cache_path = "data/thes.idx.cache";
+	agi::fs::Remove(cache_path);
+
+	{
+		agi::Thesaurus thes(dat_path, idx_path, cache_path);
+		EXPECT_EQ(1, thes.Lookup("Word 1").size());
+	}
+	ASSERT_TRUE(agi::fs::FileExists(cache_path));
+
+	// Loading from the cache should give the same results
+	agi::Thesaurus thes(dat_path, idx_path, cache_path);
+	EXPECT_EQ(1, thes.Lookup("Word 1").size());
+	EXPECT_EQ(2, thes.Lookup("Word 2").size());
+	EXPECT_EQ(1, thes.Lookup("Word 3").size());
+	EXPECT_EQ(0, thes.Lookup("Word").size());
+	EXPECT_EQ(0, thes.Lookup("Word 4").size());
+	EXPECT_EQ(0, thes.Lookup("Unindexed Word").size());
+	EXPECT_EQ(0, thes.Lookup("Out of range").size());
+}
+
+TEST_F(lagi_thes, stale_cached_index) {
+	const char *cache_path = "data/thes.idx.cache";
+	agi::fs::Remove(cache_path);
+
+	ASSERT_NO_THROW(agi::Thesaurus(dat_path, idx_path, cache_path));
+
+	{
+		std::ofstream idx(idx_path.c_str(), std::ios_base::binary | std::ios_base::app);
+		// Same data as Word 1, which starts right after the encoding line
+		idx << "Word 4|6\n";
+	}
+
+	// The index file is now a different size, so the cache is rebuilt with
+	// the new word
+	agi::Thesaurus thes(dat_path, idx_path, cache_path);
+	EXPECT_EQ(1, thes.Lookup("Word 1").size());
+	std::vector<agi::Thesaurus::Entry> entries;
+	ASSERT_NO_THROW(entries = thes.Lookup("Word 4"));
+	ASSERT_EQ(1, entries.size());
+	EXPECT_STREQ("(noun) Word 1", entries[0].first.c_str());
+}
@@ -55,3 +55,42 @@ TEST(lagi_uuencode, random_blobs_roundtrip) {
 		data.push_back(rand());
 	}
 }
+
+TEST(lagi_uuencode, line_breaks) {
+	for (size_t len : {59, 60, 61, 120, 121, 1000}) {
+		std::vector<char> data(len, 'x');
+		auto encoded = UUEncode(data.data(), data.data() + data.size());
+
+		EXPECT_NE('\n', encoded.back());
+		size_t line_start = 0;
+		for (size_t pos = encoded.find("\r\n"); pos != std::string::npos; pos = encoded.find("\r\n", line_start)) {
+			EXPECT_EQ(80u, pos - line_start);
+			line_start = pos + 2;
+		}
+		EXPECT_GE(80u, encoded.size() - line_start);
+
+		auto unbroken = UUEncode(data.data(), data.data() + data.size(), false);
+		boost::replace_all(encoded, "\r\n", "");
+		EXPECT_EQ(unbroken, encoded);
+	}
+}
+
+TEST(lagi_uuencode, decode_skips_line_breaks_anywhere) {
+	std::vector<char> data;
+	for (int i = 0; i < 100; ++i)
+		data.push_back(rand());
+
+	auto encoded = UUEncode(data.data(), data.data() + data.size(), false);
+	for (size_t i = 1; i < encoded.size(); i += 7)
+		encoded.insert(i, i % 2 ? "\n" : "\r\n");
+	EXPECT_EQ(data, UUDecode(encoded.data(), encoded.data() + encoded.size()));
+}
+
+TEST(lagi_uuencode, large_blob_roundtrip) {
+	std::vector<char> data(16 * 1024 * 1024 + 1);
+	for (auto& c : data)
+		c = rand();
+
+	auto encoded = UUEncode(data.data(), data.data() + data.size());
+	EXPECT_EQ(data, UUDecode(encoded.data(), encoded.data() + encoded.size()));
+}
@@ -785,3 +785,66 @@ TEST(lagi_vfr, from_smpte_ntsc_nodrop) {
 		++f;
 	}
 }
+
+TEST(lagi_vfr, batch_frames_at_times_matches_single) {
+	Framerate fps;
+	ASSERT_NO_THROW(fps = Framerate({0, 10, 20, 20, 35, 50, 51, 52, 100, 1000}));
+
+	std::vector<int> times;
+	for (int ms = -50; ms < 1200; ms += 3)
+		times.push_back(ms);
+	// Out of order and repeated times must give the same results too
+	times.push_back(500);
+	times.push_back(20);
+	times.push_back(20);
+	times.push_back(-5);
+	times.push_back(1000);
+	times.push_back(0);
+
+	for (auto type : {EXACT, START, END}) {
+		std::vector<int> frames(times.size());
+		fps.FramesAtTimes(times.data(), frames.data(), times.size(), type);
+		for (size_t i = 0; i < times.size(); ++i)
+			EXPECT_EQ(fps.FrameAtTime(times[i], type), frames[i]) << times[i];
+	}
+}
+
+TEST(lagi_vfr, batch_frames_at_times_cfr) {
+	Framerate fps(30000, 1001);
+
+	std::vector<int> times;
+	for (int ms = -100; ms < 10000; ms += 7)
+		times.push_back(ms);
+
+	std::vector<int> frames(times.size());
+	fps.FramesAtTimes(times.data(), frames.data(), times.size(), START);
+	for (size_t i = 0; i < times.size(); ++i)
+		EXPECT_EQ(fps.FrameAtTime(times[i], START), frames[i]) << times[i];
+}
+
+TEST(lagi_vfr, batch_times_at_frames_matches_single) {
+	Framerate fps;
+	ASSERT_NO_THROW(fps = Framerate({0, 10, 20, 35, 50, 100}));
+
+	std::vector<int> frames;
+	for (int frame = -3; frame < 10; ++frame)
+		frames.push_back(frame);
+
+	for (auto type : {EXACT, START, END}) {
+		std::vector<int> times(frames.size());
+		fps.TimesAtFrames(frames.data(), times.data(), frames.size(), type);
+		for (size_t i = 0; i < frames.size(); ++i)
+			EXPECT_EQ(fps.TimeAtFrame(frames[i], type), times[i]) << frames[i];
+	}
+}
+
+TEST(lagi_vfr, copies_share_timecodes) {
+	Framerate fps;
+	ASSERT_NO_THROW(fps = Framerate({0, 10, 20, 35, 50, 100}));
+
+	Framerate copy = fps;
+	fps = Framerate(25.0);
+	EXPECT_TRUE(copy.IsVFR());
+	EXPECT_EQ(35, copy.TimeAtFrame(3));
+	EXPECT_FALSE(fps.IsVFR());
+}